@@ -0,0 +1,273 @@
+#include "allocation_tracker.h"
+#include "logger.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+
+// Zero initialized without a constructor, so operator new can use them before main and on any thread
+struct ThreadAllocations {
+    AllocationCounts phases[AllocationTracker::phaseCount];
+    int phase;
+};
+
+thread_local ThreadAllocations threadAllocations;
+std::atomic<bool> stepCheck(false);
+
+const char* const phaseNames[] = { "other", "input", "physics", "interface", "render", "network" };
+
+} // namespace
+
+
+/* === AllocationCounts Definition STARTS HERE === */
+
+AllocationCounts& AllocationCounts::operator+=(const AllocationCounts& other) {
+    allocations += other.allocations;
+    bytes += other.bytes;
+    frees += other.frees;
+    return *this;
+}
+
+AllocationCounts operator-(const AllocationCounts& after, const AllocationCounts& before) {
+    AllocationCounts difference;
+    difference.allocations = after.allocations - before.allocations;
+    difference.bytes = after.bytes - before.bytes;
+    difference.frees = after.frees - before.frees;
+    return difference;
+}
+
+
+/* === AllocationTracker Class Definition STARTS HERE === */
+
+bool AllocationTracker::isActive() {
+#ifdef BILLIARD_ENV_BUILD
+    return false;
+#else
+    return true;
+#endif
+}
+
+AllocationCounts AllocationTracker::getThreadTotals() {
+    AllocationCounts total;
+    for (const AllocationCounts& counts : threadAllocations.phases) {
+        total += counts;
+    }
+    return total;
+}
+
+AllocationCounts AllocationTracker::getThreadTotals(AllocationPhase phase) {
+    return threadAllocations.phases[static_cast<int>(phase)];
+}
+
+AllocationPhase AllocationTracker::setPhase(AllocationPhase phase) {
+    AllocationPhase previous = static_cast<AllocationPhase>(threadAllocations.phase);
+    threadAllocations.phase = static_cast<int>(phase);
+    return previous;
+}
+
+AllocationPhase AllocationTracker::getPhase() {
+    return static_cast<AllocationPhase>(threadAllocations.phase);
+}
+
+const char* AllocationTracker::getPhaseName(AllocationPhase phase) {
+    int index = static_cast<int>(phase);
+    return index >= 0 && index < phaseCount ? phaseNames[index] : "unknown";
+}
+
+void AllocationTracker::setStepCheck(bool enabled) {
+    stepCheck.store(enabled, std::memory_order_relaxed);
+}
+
+bool AllocationTracker::isStepCheckEnabled() {
+    return stepCheck.load(std::memory_order_relaxed);
+}
+
+
+/* === AllocationScope Class Definition STARTS HERE === */
+
+AllocationScope::AllocationScope(AllocationPhase phase) : previous(AllocationTracker::setPhase(phase)) {
+}
+
+AllocationScope::~AllocationScope() {
+    AllocationTracker::setPhase(previous);
+}
+
+
+/* === AllocationCheck Class Definition STARTS HERE === */
+
+AllocationCheck::AllocationCheck(const char* what) : what(what), enabled(AllocationTracker::isStepCheckEnabled()) {
+    if (enabled) start = AllocationTracker::getThreadTotals();
+}
+
+AllocationCheck::~AllocationCheck() {
+    if (!enabled) return;
+
+    AllocationCounts during = AllocationTracker::getThreadTotals() - start;
+    if (during.allocations > 0) {
+        BILLIARD_LOG(Warning, Timing) << during.allocations << " heap allocations (" << during.bytes << " bytes) during the " << what;
+    }
+}
+
+
+/* === AllocationSampler Class Definition STARTS HERE === */
+
+void AllocationSampler::begin() {
+    for (int phase = 0; phase < AllocationTracker::phaseCount; ++phase) {
+        start[phase] = threadAllocations.phases[phase];
+    }
+}
+
+void AllocationSampler::end() {
+    for (int phase = 0; phase < AllocationTracker::phaseCount; ++phase) {
+        last[phase] = threadAllocations.phases[phase] - start[phase];
+    }
+}
+
+// Getter Functions
+
+const AllocationCounts& AllocationSampler::getLast(AllocationPhase phase) const {
+    return last[static_cast<int>(phase)];
+}
+
+AllocationCounts AllocationSampler::getLastTotal() const {
+    AllocationCounts total;
+    for (const AllocationCounts& counts : last) {
+        total += counts;
+    }
+    return total;
+}
+
+
+/* === Global operator new and delete === */
+
+#ifndef BILLIARD_ENV_BUILD
+
+namespace {
+
+void countAllocation(std::size_t size) {
+    AllocationCounts& counts = threadAllocations.phases[threadAllocations.phase];
+    ++counts.allocations;
+    counts.bytes += size;
+}
+
+void countFree(void* pointer) {
+    if (pointer) ++threadAllocations.phases[threadAllocations.phase].frees;
+}
+
+void* allocate(std::size_t size) {
+    countAllocation(size);
+    for (;;) {
+        if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+
+        // Same contract as the default operator new: retry through the new handler or throw
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    countAllocation(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t rounded = (size + align - 1) / align * align; // aligned_alloc wants a multiple of the alignment
+#ifdef _WIN32
+    void* pointer = _aligned_malloc(rounded ? rounded : align, align);
+#else
+    void* pointer = std::aligned_alloc(align, rounded ? rounded : align);
+#endif
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void freeAligned(void* pointer) {
+    countFree(pointer);
+#ifdef _WIN32
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+    countFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    countFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    countFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    countFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    countFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    countFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+#endif
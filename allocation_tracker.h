@@ -0,0 +1,96 @@
+#pragma once
+
+#include <SFML\System.hpp>
+
+
+/*
+    Heap Allocation Tracking
+
+    The global operator new and delete are replaced so every thread counts its own
+    allocations, split by the phase of the frame it is in. Counting is a few thread local
+    adds on top of malloc, there are no locks or atomics.
+
+    Game marks its phases with AllocationScope and samples every frame with an
+    AllocationSampler, so steady play can be held to zero allocations per frame. With the
+    step check on, an AllocationCheck around the physics step logs every step that touched
+    the heap.
+
+    The shared library build (BILLIARD_ENV_BUILD) leaves operator new alone, a library must
+    not replace its host's allocator. isActive() is false there and every count stays zero.
+*/
+
+enum class AllocationPhase : int {
+    Other,
+    Input,
+    Physics,
+    Interface, // Score and turn text
+    Render,
+    Network,   // Spectator broadcast and match recording
+    Count
+};
+
+struct AllocationCounts {
+    sf::Uint64 allocations = 0;
+    sf::Uint64 bytes = 0;
+    sf::Uint64 frees = 0;
+
+    AllocationCounts& operator+=(const AllocationCounts& other);
+};
+
+AllocationCounts operator-(const AllocationCounts& after, const AllocationCounts& before);
+
+class AllocationTracker {
+public:
+    static const int phaseCount = static_cast<int>(AllocationPhase::Count);
+
+    static bool isActive();
+    static AllocationCounts getThreadTotals(); // Every phase, calling thread only
+    static AllocationCounts getThreadTotals(AllocationPhase phase);
+    static AllocationPhase setPhase(AllocationPhase phase); // Returns the phase it replaces
+    static AllocationPhase getPhase();
+    static const char* getPhaseName(AllocationPhase phase);
+
+    static void setStepCheck(bool enabled); // Any thread, takes effect at the next check
+    static bool isStepCheckEnabled();
+};
+
+// The calling thread counts into phase until the scope ends
+class AllocationScope {
+private:
+    AllocationPhase previous;
+
+public:
+    explicit AllocationScope(AllocationPhase phase);
+    ~AllocationScope();
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+};
+
+// Logs a warning when the calling thread allocated while it was alive, only with the step check on
+class AllocationCheck {
+private:
+    const char* what;
+    bool enabled;
+    AllocationCounts start;
+
+public:
+    explicit AllocationCheck(const char* what);
+    ~AllocationCheck();
+    AllocationCheck(const AllocationCheck&) = delete;
+    AllocationCheck& operator=(const AllocationCheck&) = delete;
+};
+
+// The calling thread's allocations between begin() and end(), per phase
+class AllocationSampler {
+private:
+    AllocationCounts start[AllocationTracker::phaseCount];
+    AllocationCounts last[AllocationTracker::phaseCount];
+
+public:
+    void begin();
+    void end();
+
+    // Getter Functions, of the last begin() / end() pair
+    const AllocationCounts& getLast(AllocationPhase phase) const;
+    AllocationCounts getLastTotal() const;
+};
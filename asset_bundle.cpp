@@ -0,0 +1,333 @@
+#include "asset_bundle.h"
+#include "logger.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+const char bundleMagic[8] = { 'B', 'I', 'L', 'L', 'P', 'A', 'C', 'K' };
+const sf::Uint32 bundleVersion = 1;
+const std::size_t bundleAlignment = 16;
+
+sf::Uint64 readLittle(const sf::Uint8* data, int bytes) {
+    sf::Uint64 value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+void writeLittle(std::vector<char>& out, sf::Uint64 value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+} // namespace
+
+
+/* === MappedFile Class Definition STARTS HERE === */
+
+MappedFile::MappedFile() : data(nullptr), size(0) {
+#ifdef _WIN32
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    HANDLE view = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        view = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (!view) {
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = view;
+    data = static_cast<const sf::Uint8*>(MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0));
+    size = data ? static_cast<std::size_t>(fileSize.QuadPart) : 0;
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) return false;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size <= 0) {
+        ::close(file);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file); // The mapping keeps the file alive
+    if (view != MAP_FAILED) {
+        data = static_cast<const sf::Uint8*>(view);
+        size = static_cast<std::size_t>(status.st_size);
+    }
+#endif
+
+    if (!data) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    if (data) munmap(const_cast<sf::Uint8*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+// Getter Functions
+
+const sf::Uint8* MappedFile::getData() const {
+    return data;
+}
+
+std::size_t MappedFile::getSize() const {
+    return size;
+}
+
+bool MappedFile::isOpen() const {
+    return data != nullptr;
+}
+
+
+/* === AssetBundle Class Definition STARTS HERE === */
+
+AssetBundle::AssetBundle() {
+}
+
+AssetBundle::~AssetBundle() {
+    close();
+}
+
+bool AssetBundle::open(const std::string& path) {
+    close();
+
+    if (!mappedFile.open(path) || !parse()) {
+        BILLIARD_LOG(Warning, Assets) << "Asset bundle " << path << " is not valid, using the loose files";
+        close();
+        return false;
+    }
+    BILLIARD_LOG(Info, Assets) << "Mapped asset bundle " << path << " with " << entries.size() << " files.";
+    return true;
+}
+
+bool AssetBundle::parse() {
+    const sf::Uint8* mapping = mappedFile.getData();
+    const std::size_t mappingSize = mappedFile.getSize();
+    const std::size_t headerSize = sizeof(bundleMagic) + 4 + 4;
+    if (mappingSize < headerSize || std::memcmp(mapping, bundleMagic, sizeof(bundleMagic)) != 0) return false;
+    if (readLittle(mapping + 8, 4) != bundleVersion) return false;
+
+    std::size_t count = static_cast<std::size_t>(readLittle(mapping + 12, 4));
+    std::size_t offset = headerSize;
+    entries.clear();
+    entries.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (offset + 2 > mappingSize) return false;
+        std::size_t nameLength = static_cast<std::size_t>(readLittle(mapping + offset, 2));
+        offset += 2;
+        if (offset + nameLength + 16 > mappingSize) return false;
+
+        Entry entry;
+        entry.name.assign(reinterpret_cast<const char*>(mapping + offset), nameLength);
+        offset += nameLength;
+        sf::Uint64 dataOffset = readLittle(mapping + offset, 8);
+        sf::Uint64 dataSize = readLittle(mapping + offset + 8, 8);
+        offset += 16;
+        if (dataOffset > mappingSize || dataSize > mappingSize - dataOffset) return false;
+
+        entry.data.data = mapping + dataOffset;
+        entry.data.size = static_cast<std::size_t>(dataSize);
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+void AssetBundle::close() {
+    mappedFile.close();
+    entries.clear();
+}
+
+AssetData AssetBundle::find(const std::string& name) {
+    for (const Entry& entry : entries) {
+        if (entry.name == name) return entry.data;
+    }
+
+    std::ifstream file(name, std::ios::binary);
+    if (!file) return AssetData();
+    looseFiles.emplace_back((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    AssetData data;
+    data.data = looseFiles.back().data();
+    data.size = looseFiles.back().size();
+    return data;
+}
+
+bool AssetBundle::pack(const std::string& root, const std::vector<std::string>& names, const std::string& output) {
+    std::vector<std::vector<char>> files;
+    for (const std::string& name : names) {
+        std::ifstream file(root + "/" + name, std::ios::binary);
+        if (!file) {
+            std::cerr << "Failed to read " << root << "/" << name << std::endl;
+            return false;
+        }
+        files.emplace_back((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    // The data starts after the table, aligned, so its offsets are known before writing it
+    std::size_t offset = sizeof(bundleMagic) + 4 + 4;
+    for (const std::string& name : names) {
+        offset += 2 + name.size() + 16;
+    }
+
+    std::vector<char> header(bundleMagic, bundleMagic + sizeof(bundleMagic));
+    writeLittle(header, bundleVersion, 4);
+    writeLittle(header, names.size(), 4);
+    std::vector<std::size_t> offsets;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        offset = (offset + bundleAlignment - 1) / bundleAlignment * bundleAlignment;
+        offsets.push_back(offset);
+        writeLittle(header, names[i].size(), 2);
+        header.insert(header.end(), names[i].begin(), names[i].end());
+        writeLittle(header, offset, 8);
+        writeLittle(header, files[i].size(), 8);
+        offset += files[i].size();
+    }
+
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to write " << output << std::endl;
+        return false;
+    }
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    std::size_t written = header.size();
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        std::vector<char> padding(offsets[i] - written, 0);
+        out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        out.write(files[i].data(), static_cast<std::streamsize>(files[i].size()));
+        written = offsets[i] + files[i].size();
+    }
+    return static_cast<bool>(out);
+}
+
+// Getter Functions
+
+bool AssetBundle::isOpen() const {
+    return mappedFile.isOpen();
+}
+
+
+/* === GameAssets Class Definition STARTS HERE === */
+
+const char* const GameAssets::bundlePath = "assets.pack";
+
+const std::vector<std::string>& GameAssets::getAssetNames() {
+    static const std::vector<std::string> names = {
+        "img/cue_stick.png",
+        "Arial.ttf",
+        "sound/ball_collide.wav",
+        "sound/pool_ball_hit.wav"
+    };
+    return names;
+}
+
+GameAssets::GameAssets() : audioPending(2) {
+    bundle.open(bundlePath);
+
+    // Everything is looked up before any thread starts, the bundle is not touched again after
+    AssetData stickImage = bundle.find("img/cue_stick.png");
+    AssetData fontFile = bundle.find("Arial.ttf");
+    AssetData collisionFile = bundle.find("sound/ball_collide.wav");
+    AssetData cueHitFile = bundle.find("sound/pool_ball_hit.wav");
+
+    // Sounds decode in the background, a Game attaches them once they are done
+    auto loadSound = [this](sf::SoundBuffer* buffer, AssetData file, const char* error) {
+        if (!file.data || !buffer->loadFromMemory(file.data, file.size)) {
+            BILLIARD_LOG(Error, Assets) << error;
+        }
+        --audioPending;
+    };
+    std::thread(loadSound, &collisionSound, collisionFile, "Failed to load collision sound!").detach();
+    std::thread(loadSound, &cueHitSound, cueHitFile, "Failed to load cue stick hit sound!").detach();
+
+    // The image decodes on a helper while the font is opened here, the upload needs this thread
+    sf::Image stick;
+    bool stickDecoded = false;
+    std::thread imageLoader([&]() {
+        stickDecoded = stickImage.data && stick.loadFromMemory(stickImage.data, stickImage.size);
+    });
+
+    // The font reads its glyphs from this memory for as long as it lives, the bundle outlives it
+    if (!fontFile.data || !font.loadFromMemory(fontFile.data, fontFile.size)) {
+        BILLIARD_LOG(Error, Assets) << "Failed to load font!";
+    }
+
+    imageLoader.join();
+    if (!stickDecoded || !cueStickTexture.loadFromImage(stick)) {
+        BILLIARD_LOG(Error, Assets) << "Failed to load cue stick texture!";
+    }
+}
+
+GameAssets& GameAssets::shared() {
+    // Never destroyed: SFML resources must outlive every Game, and the sound loaders may still run at exit
+    static GameAssets* assets = new GameAssets();
+    return *assets;
+}
+
+// Getter Functions
+
+const sf::Texture& GameAssets::getCueStickTexture() const {
+    return cueStickTexture;
+}
+
+const sf::Font& GameAssets::getFont() const {
+    return font;
+}
+
+bool GameAssets::isAudioReady() const {
+    return audioPending == 0;
+}
+
+const sf::SoundBuffer& GameAssets::getCollisionSound() const {
+    return collisionSound;
+}
+
+const sf::SoundBuffer& GameAssets::getCueHitSound() const {
+    return cueHitSound;
+}
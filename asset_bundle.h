@@ -0,0 +1,117 @@
+#pragma once
+
+#include <SFML\Graphics.hpp>
+#include <SFML\Audio.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/*
+    Packed Assets
+
+    Every file the game loads at startup packed into one bundle (assets.pack, written by
+    the pack_assets tool). The bundle is memory-mapped, so opening it costs no reads and
+    every process running the game shares the same pages:
+
+        [8 bytes "BILLPACK"][u32 version][u32 entryCount]
+        entryCount * [u16 nameLength][name][u64 offset][u64 size]
+        file data, every file starting on a 16 byte boundary
+
+    All integers are little endian. Without a bundle the loose files are read instead, so
+    a fresh checkout still runs.
+*/
+
+// A whole file mapped read-only, every process mapping the same file shares its pages
+class MappedFile {
+private:
+    const sf::Uint8* data;
+    std::size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path); // False for a missing or empty file
+    void close();
+
+    // Getter Functions
+    const sf::Uint8* getData() const;
+    std::size_t getSize() const;
+    bool isOpen() const;
+};
+
+struct AssetData {
+    const void* data = nullptr;
+    std::size_t size = 0;
+};
+
+class AssetBundle {
+private:
+    struct Entry {
+        std::string name;
+        AssetData data;
+    };
+
+    MappedFile mappedFile;
+    std::vector<Entry> entries;
+    std::vector<std::vector<char>> looseFiles; // Owned copies when a name is read from disk instead
+
+    bool parse();
+
+public:
+    AssetBundle();
+    ~AssetBundle();
+    AssetBundle(const AssetBundle&) = delete;
+    AssetBundle& operator=(const AssetBundle&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // The bundled copy, or the loose file read from disk, empty when neither exists
+    AssetData find(const std::string& name);
+
+    // Writes a bundle of the files under root, named by their path relative to it
+    static bool pack(const std::string& root, const std::vector<std::string>& names, const std::string& output);
+
+    // Getter Functions
+    bool isOpen() const;
+};
+
+/*
+    The textures, font and sounds of the game, loaded once per process and shared by every
+    Game. The image and the two sounds are decoded on their own threads while the font is
+    opened on the caller's; the texture upload waits for its image, the sounds do not hold
+    up the first frame and are attached once isAudioReady() turns true.
+*/
+class GameAssets {
+private:
+    AssetBundle bundle;
+    sf::Texture cueStickTexture;
+    sf::Font font;
+    sf::SoundBuffer collisionSound;
+    sf::SoundBuffer cueHitSound;
+    std::atomic<int> audioPending; // Sounds still decoding
+
+    GameAssets();
+
+public:
+    static const char* const bundlePath;
+    static const std::vector<std::string>& getAssetNames(); // Everything pack_assets puts in the bundle
+
+    static GameAssets& shared(); // Loaded on first use
+
+    // Getter Functions
+    const sf::Texture& getCueStickTexture() const;
+    const sf::Font& getFont() const;
+    bool isAudioReady() const;
+    const sf::SoundBuffer& getCollisionSound() const; // Only once isAudioReady()
+    const sf::SoundBuffer& getCueHitSound() const;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+/*
+    Billiard Environment C Interface
+
+    Plain C entry points over VectorEnvironment so training code in any language can load
+    the simulation as a shared library (ctypes, cffi, P/Invoke, ...). Every buffer belongs
+    to the caller and is written in place, no call allocates once the environment exists.
+
+      observations   envCount * billiard_env_observation_size() floats
+      actions        envCount * 2 floats: aim angle in radians, power 0 - 100
+      rewards        envCount floats
+      dones          envCount bytes
+
+    Build the library with BILLIARD_ENV_BUILD defined so the functions are exported.
+*/
+
+#if defined(_WIN32) && defined(BILLIARD_ENV_BUILD)
+#define BILLIARD_ENV_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define BILLIARD_ENV_API __declspec(dllimport)
+#else
+#define BILLIARD_ENV_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct BilliardEnv BilliardEnv;
+
+typedef struct BilliardEnvConfig {
+    const char* table;       /* pool9ft, snooker or sandbox */
+    int envCount;
+    int threads;             /* Including the calling thread */
+    int ballCount;           /* Including the cue ball */
+    const char* rackPattern; /* triangle, diamond, hex or random */
+    unsigned int seed;       /* Random racks use seed + env index */
+    int framesPerStep;       /* 0: one step plays a shot until rest, n: one step advances n frames */
+    int maxShotFrames;       /* A shot still moving after this many frames is stopped */
+    int maxShots;            /* Shots per episode */
+    float foulPenalty;       /* Taken off the reward when the cue ball is pocketed */
+    int autoReset;           /* Non zero: a finished env is racked again inside the same step */
+} BilliardEnvConfig;
+
+BILLIARD_ENV_API void billiard_env_default_config(BilliardEnvConfig* config);
+BILLIARD_ENV_API BilliardEnv* billiard_env_create(const BilliardEnvConfig* config); /* NULL for an invalid config or when memory or threads run out */
+BILLIARD_ENV_API void billiard_env_destroy(BilliardEnv* env);
+
+BILLIARD_ENV_API int billiard_env_count(const BilliardEnv* env);
+BILLIARD_ENV_API int billiard_env_ball_count(const BilliardEnv* env);
+BILLIARD_ENV_API int billiard_env_observation_size(const BilliardEnv* env); /* Floats per env */
+
+BILLIARD_ENV_API void billiard_env_reset(BilliardEnv* env, float* observations);
+BILLIARD_ENV_API void billiard_env_step(BilliardEnv* env, const float* actions, float* observations,
+                                        float* rewards, unsigned char* dones);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,351 @@
+#include "break_database.h"
+#include "simulation.h"
+#include "worker_pool.h"
+#include "logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+
+namespace {
+
+const char breakMagic[8] = { 'B', 'I', 'L', 'L', 'B', 'R', 'K', 'S' };
+const sf::Uint32 breakVersion = 1;
+const std::size_t headerSize = 96; // Padded so the records start 8 byte aligned
+const std::size_t recordSize = 8;
+const std::size_t tableNameSize = 16;
+const int maxBreakFrames = 5000;   // Like VectorEnvironment, a break that never settles is cut off there
+const float pi = 3.14159265f;
+
+sf::Uint64 readLittle(const sf::Uint8* data, int bytes) {
+    sf::Uint64 value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+float readFloat(const sf::Uint8* data) {
+    sf::Uint32 bits = static_cast<sf::Uint32>(readLittle(data, 4));
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void writeLittle(std::vector<char>& out, sf::Uint64 value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void writeFloat(std::vector<char>& out, float value) {
+    sf::Uint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeLittle(out, bits, 4);
+}
+
+// Sample k of count spread evenly over [low, high], the middle for a single sample
+float gridValue(int k, int count, float low, float high) {
+    return count > 1 ? low + (high - low) * k / (count - 1) : (low + high) / 2;
+}
+
+// Lower grid index and blend fraction of a value, clamped to the grid
+void gridCell(float value, int count, float low, float high, int& index, float& fraction) {
+    float position = high > low && count > 1 ? (value - low) / (high - low) * (count - 1) : 0.0f;
+    position = std::max(0.0f, std::min(static_cast<float>(count - 1), position));
+    index = std::min(static_cast<int>(position), std::max(0, count - 2));
+    fraction = count > 1 ? position - index : 0.0f;
+}
+
+float angleTo(sf::Vector2f from, sf::Vector2f to) {
+    return std::atan2(to.y - from.y, to.x - from.x);
+}
+
+} // namespace
+
+
+/* === BreakDatabase Class Definition STARTS HERE === */
+
+BreakDatabase::BreakDatabase() : records(nullptr), objectBalls(0) {
+}
+
+bool BreakDatabase::generate(const TableSpec& spec, const BreakGrid& settings, int threadCount, const std::string& path) {
+    BreakGrid grid = settings;
+    grid.columns = std::max(1, grid.columns);
+    grid.rows = std::max(1, grid.rows);
+    grid.angles = std::max(1, grid.angles);
+    grid.powers = std::max(1, grid.powers);
+
+    // The standard triangle, the apex ball comes first and the cue ball last
+    const std::vector<sf::Vector2f> rack = generateRack(spec, RackOptions());
+    const int objectCount = static_cast<int>(rack.size()) - 1;
+    if (objectCount < 1) return false;
+    const sf::Vector2f apex = rack.front();
+    const sf::Vector2f cueSpot = rack.back();
+
+    // Behind the head string, one diameter off the rails
+    const sf::Vector2f offset = spec.table_offset();
+    const float margin = spec.ball_radius * 2;
+    const sf::FloatRect area(offset.x + margin, offset.y + margin, cueSpot.x - offset.x - margin, spec.table_height - 2 * margin);
+
+    const int sampleCount = grid.columns * grid.rows * grid.angles * grid.powers;
+    std::vector<char> body(static_cast<std::size_t>(sampleCount) * recordSize);
+    std::atomic<int> nextSample(0);
+    std::atomic<int> scratches(0);
+
+    sf::Clock clock;
+    WorkerPool workers(std::max(1, threadCount));
+    workers.run([&](int) {
+        Simulation simulation(spec);
+        std::vector<sf::Vector2f> positions = rack;
+
+        for (int sample = nextSample++; sample < sampleCount; sample = nextSample++) {
+            int power = sample % grid.powers;
+            int angle = sample / grid.powers % grid.angles;
+            int row = sample / (grid.powers * grid.angles) % grid.rows;
+            int column = sample / (grid.powers * grid.angles * grid.rows);
+
+            sf::Vector2f placement(gridValue(column, grid.columns, area.left, area.left + area.width),
+                                   gridValue(row, grid.rows, area.top, area.top + area.height));
+            float direction = angleTo(placement, apex) + gridValue(angle, grid.angles, -grid.angleSpread, grid.angleSpread);
+            float strength = gridValue(power, grid.powers, grid.minPower, grid.maxPower);
+
+            positions.back() = placement;
+            simulation.rack(positions);
+            simulation.strike(sf::Vector2f(std::cos(direction), std::sin(direction)) * strength);
+
+            bool scratch = false;
+            for (int frame = 0; frame < maxBreakFrames && simulation.isMoving(); ++frame) {
+                simulation.step();
+                for (const PocketEvent& event : simulation.getPocketEvents()) {
+                    if (event.ballId == simulation.getCueBallId()) scratch = true;
+                }
+            }
+
+            const BallPool& ballPool = simulation.getBallPool();
+            sf::Uint32 mask = 0;
+            int count = 0;
+            for (int id = 0; id < objectCount; ++id) {
+                if (!ballPool.get(id).pocketed) continue;
+                ++count;
+                if (id < 16) mask |= sf::Uint32(1) << id;
+            }
+            if (scratch) ++scratches;
+
+            // Every thread writes its own records, no two samples share bytes
+            sf::Vector2f leave = ballPool.get(simulation.getCueBallId()).getPosition();
+            std::vector<char> record;
+            writeLittle(record, mask, 2);
+            writeLittle(record, static_cast<sf::Uint64>(std::min(count, 255)), 1);
+            writeLittle(record, scratch ? 1 : 0, 1);
+            writeLittle(record, static_cast<sf::Uint64>(std::max(0.0f, std::min(65535.0f, std::round(leave.x * 8)))), 2);
+            writeLittle(record, static_cast<sf::Uint64>(std::max(0.0f, std::min(65535.0f, std::round(leave.y * 8)))), 2);
+            std::memcpy(&body[static_cast<std::size_t>(sample) * recordSize], record.data(), recordSize);
+        }
+    });
+
+    std::vector<char> header(breakMagic, breakMagic + sizeof(breakMagic));
+    writeLittle(header, breakVersion, 4);
+    writeLittle(header, static_cast<sf::Uint64>(objectCount), 4);
+    std::string name(spec.name);
+    name.resize(tableNameSize, '\0');
+    header.insert(header.end(), name.begin(), name.end());
+    for (int count : { grid.columns, grid.rows, grid.angles, grid.powers }) {
+        writeLittle(header, static_cast<sf::Uint64>(count), 4);
+    }
+    for (float value : { area.left, area.top, area.left + area.width, area.top + area.height, apex.x, apex.y, cueSpot.x, cueSpot.y,
+                         grid.angleSpread, grid.minPower, grid.maxPower }) {
+        writeFloat(header, value);
+    }
+    header.resize(headerSize, '\0');
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        BILLIARD_LOG(Error, Physics) << "Failed to write " << path;
+        return false;
+    }
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out.write(body.data(), static_cast<std::streamsize>(body.size()));
+    if (!out) return false;
+
+    BILLIARD_LOG(Info, Physics) << "Played " << sampleCount << " breaks in " << clock.getElapsedTime().asSeconds() << " s, "
+                                << scratches << " scratched, written to " << path;
+    return true;
+}
+
+bool BreakDatabase::open(const std::string& path) {
+    close();
+
+    if (!mappedFile.open(path) || !parse()) {
+        BILLIARD_LOG(Warning, Physics) << "Break database " << path << " is not valid";
+        close();
+        return false;
+    }
+    this->findBestBreak();
+    BILLIARD_LOG(Info, Physics) << "Mapped break database " << path << " with " << getSampleCount() << " breaks on the "
+                                << tableName << " table.";
+    return true;
+}
+
+bool BreakDatabase::parse() {
+    const sf::Uint8* data = mappedFile.getData();
+    if (mappedFile.getSize() < headerSize || std::memcmp(data, breakMagic, sizeof(breakMagic)) != 0) return false;
+    if (readLittle(data + 8, 4) != breakVersion) return false;
+
+    objectBalls = static_cast<int>(readLittle(data + 12, 4));
+    const char* name = reinterpret_cast<const char*>(data + 16);
+    tableName.assign(name, strnlen(name, tableNameSize));
+
+    // The grid is only taken once the file is known to hold every record of it
+    BreakGrid fileGrid;
+    const sf::Uint8* field = data + 16 + tableNameSize;
+    int* counts[4] = { &fileGrid.columns, &fileGrid.rows, &fileGrid.angles, &fileGrid.powers };
+    sf::Uint64 sampleCount = 1;
+    for (int* count : counts) {
+        sf::Uint64 value = readLittle(field, 4);
+        if (value < 1 || value > 4096) return false;
+        *count = static_cast<int>(value);
+        sampleCount *= value; // At most 2^48, no overflow
+        field += 4;
+    }
+    const sf::Uint64 fileRecords = (mappedFile.getSize() - headerSize) / recordSize;
+    if (sampleCount > fileRecords || sampleCount > static_cast<sf::Uint64>(std::numeric_limits<int>::max())) return false;
+
+    float values[11];
+    for (float& value : values) {
+        value = readFloat(field);
+        field += 4;
+    }
+    placementArea = sf::FloatRect(values[0], values[1], values[2] - values[0], values[3] - values[1]);
+    apex = sf::Vector2f(values[4], values[5]);
+    cueSpot = sf::Vector2f(values[6], values[7]);
+    fileGrid.angleSpread = values[8];
+    fileGrid.minPower = values[9];
+    fileGrid.maxPower = values[10];
+
+    grid = fileGrid;
+    records = data + headerSize;
+    return true;
+}
+
+void BreakDatabase::close() {
+    mappedFile.close();
+    records = nullptr;
+    objectBalls = 0;
+    tableName.clear();
+    bestBreak = BreakShot();
+}
+
+std::size_t BreakDatabase::getIndex(int column, int row, int angle, int power) const {
+    return ((static_cast<std::size_t>(column) * grid.rows + row) * grid.angles + angle) * grid.powers + power;
+}
+
+BreakPrediction BreakDatabase::query(sf::Vector2f placement, float angle, float power) const {
+    BreakPrediction prediction;
+    if (!records) return prediction;
+
+    // The grid measures angles from the line to the apex ball
+    float offset = angle - angleTo(placement, apex);
+    offset = std::remainder(offset, 2 * pi);
+
+    int index[4];
+    float fraction[4];
+    gridCell(placement.x, grid.columns, placementArea.left, placementArea.left + placementArea.width, index[0], fraction[0]);
+    gridCell(placement.y, grid.rows, placementArea.top, placementArea.top + placementArea.height, index[1], fraction[1]);
+    gridCell(offset, grid.angles, -grid.angleSpread, grid.angleSpread, index[2], fraction[2]);
+    gridCell(power, grid.powers, grid.minPower, grid.maxPower, index[3], fraction[3]);
+    const int sizes[4] = { grid.columns, grid.rows, grid.angles, grid.powers };
+
+    // The 16 corners of the cell around the shot, weighted by their distance along each axis
+    sf::Vector2f leave;
+    float leaveWeight = 0.0f;
+    for (int corner = 0; corner < 16; ++corner) {
+        int at[4];
+        float weight = 1.0f;
+        for (int axis = 0; axis < 4; ++axis) {
+            bool upper = (corner >> axis & 1) != 0;
+            at[axis] = std::min(index[axis] + (upper ? 1 : 0), sizes[axis] - 1);
+            weight *= upper ? fraction[axis] : 1.0f - fraction[axis];
+        }
+        if (weight <= 0.0f) continue;
+
+        const sf::Uint8* record = records + getIndex(at[0], at[1], at[2], at[3]) * recordSize;
+        sf::Uint32 mask = static_cast<sf::Uint32>(readLittle(record, 2));
+        prediction.expectedPocketed += weight * record[2];
+        for (int ball = 0; mask != 0; ++ball, mask >>= 1) {
+            if (mask & 1) prediction.pocketChance[ball] += weight;
+        }
+        if (record[3] & 1) {
+            prediction.scratchChance += weight;
+        } else {
+            leave += weight * sf::Vector2f(readLittle(record + 4, 2) / 8.0f, readLittle(record + 6, 2) / 8.0f);
+            leaveWeight += weight;
+        }
+    }
+    prediction.cueLeave = leaveWeight > 0.0f ? leave / leaveWeight : cueSpot;
+    return prediction;
+}
+
+void BreakDatabase::findBestBreak() {
+    // A lone lucky sample is no plan, every shot is scored with its neighbouring angles and powers
+    float bestScore = -1e9f;
+    for (int column = 0; column < grid.columns; ++column) {
+        for (int row = 0; row < grid.rows; ++row) {
+            for (int angle = 0; angle < grid.angles; ++angle) {
+                for (int power = 0; power < grid.powers; ++power) {
+                    float score = 0.0f;
+                    int samples = 0;
+                    for (int a = std::max(0, angle - 1); a <= std::min(grid.angles - 1, angle + 1); ++a) {
+                        for (int p = std::max(0, power - 1); p <= std::min(grid.powers - 1, power + 1); ++p) {
+                            const sf::Uint8* record = records + getIndex(column, row, a, p) * recordSize;
+                            score += record[2] - ((record[3] & 1) ? 1.0f : 0.0f);
+                            ++samples;
+                        }
+                    }
+                    score /= samples;
+                    if (score <= bestScore) continue;
+
+                    bestScore = score;
+                    bestBreak.placement = sf::Vector2f(gridValue(column, grid.columns, placementArea.left, placementArea.left + placementArea.width),
+                                                       gridValue(row, grid.rows, placementArea.top, placementArea.top + placementArea.height));
+                    bestBreak.angle = angleTo(bestBreak.placement, apex) + gridValue(angle, grid.angles, -grid.angleSpread, grid.angleSpread);
+                    bestBreak.power = gridValue(power, grid.powers, grid.minPower, grid.maxPower);
+                }
+            }
+        }
+    }
+    bestBreak.prediction = query(bestBreak.placement, bestBreak.angle, bestBreak.power);
+}
+
+// Getter Functions
+
+bool BreakDatabase::isOpen() const {
+    return records != nullptr;
+}
+
+const std::string& BreakDatabase::getTableName() const {
+    return tableName;
+}
+
+const BreakGrid& BreakDatabase::getGrid() const {
+    return grid;
+}
+
+sf::FloatRect BreakDatabase::getPlacementArea() const {
+    return placementArea;
+}
+
+int BreakDatabase::getSampleCount() const {
+    return grid.columns * grid.rows * grid.angles * grid.powers;
+}
+
+int BreakDatabase::getObjectBallCount() const {
+    return objectBalls;
+}
+
+const BreakShot& BreakDatabase::getBestBreak() const {
+    return bestBreak;
+}
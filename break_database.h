@@ -0,0 +1,97 @@
+#pragma once
+
+#include <SFML\System.hpp>
+#include <string>
+#include <vector>
+
+#include "table_spec.h"
+#include "asset_bundle.h"
+
+
+/*
+    Break Shot Database
+
+    The opening rack is always the same triangle, so what a break does depends only on where
+    the cue ball is placed behind the head string and how it is struck. generate() sweeps
+    a grid of placement x placement x angle x power offline, on several threads, running
+    every break to rest with the fixed-step Simulation, and writes the outcomes to a file:
+
+        [8 bytes "BILLBRKS"][u32 version][u32 objectBalls][16 bytes table name]
+        [u32 columns][u32 rows][u32 angles][u32 powers]
+        [f32 left, top, right, bottom]      placement area, columns run along x
+        [f32 apex x, y][f32 cue spot x, y]
+        [f32 angleSpread][f32 minPower][f32 maxPower]
+        columns * rows * angles * powers records of 8 bytes, power varying fastest:
+            [u16 pocketed object balls, bit i is rack ball i][u8 count][u8 flags, 1 = scratch]
+            [u16 cue x][u16 cue y]          where the cue ball came to rest, in 1/8 px
+
+    All integers and floats are little endian. The angle of a sample is measured from the
+    line between its placement and the apex ball, so every placement sweeps the same spread
+    around a full hit. The file is memory-mapped, a query reads the 16 samples around the
+    asked shot and blends them, so it takes the same time whatever the grid size.
+*/
+
+struct BreakGrid {
+    int columns = 4;           // Placements along the table, from the head rail to the head string
+    int rows = 9;              // Placements across the table
+    int angles = 21;
+    int powers = 8;
+    float angleSpread = 0.05f; // Radians either side of the line to the apex ball
+    float minPower = 40.0f;    // 0 - 100, like the cue stick
+    float maxPower = 100.0f;
+};
+
+// Blended from the samples around the shot, the chances are fractions of them
+struct BreakPrediction {
+    float expectedPocketed = 0.0f;
+    float scratchChance = 0.0f;
+    float pocketChance[16] = {};      // Per rack ball, the first 16 object balls
+    sf::Vector2f cueLeave;            // Average rest position over the samples without a scratch
+};
+
+struct BreakShot {
+    sf::Vector2f placement;
+    float angle = 0.0f;               // Absolute, radians
+    float power = 0.0f;
+    BreakPrediction prediction;
+};
+
+class BreakDatabase {
+private:
+    MappedFile mappedFile;
+    const sf::Uint8* records;
+    int objectBalls;
+    BreakGrid grid;
+    sf::FloatRect placementArea;
+    sf::Vector2f apex;
+    sf::Vector2f cueSpot;
+    std::string tableName;
+    BreakShot bestBreak;
+
+    std::size_t getIndex(int column, int row, int angle, int power) const;
+    bool parse();
+    void findBestBreak();
+
+public:
+    BreakDatabase();
+    BreakDatabase(const BreakDatabase&) = delete;
+    BreakDatabase& operator=(const BreakDatabase&) = delete;
+
+    // Plays every break of the grid on threadCount threads and writes the file
+    static bool generate(const TableSpec& spec, const BreakGrid& grid, int threadCount, const std::string& path);
+
+    bool open(const std::string& path);
+    void close();
+
+    // Constant time, placements, angles and powers outside the grid are clamped to its edge
+    BreakPrediction query(sf::Vector2f placement, float angle, float power) const;
+
+    // Getter Functions
+    bool isOpen() const;
+    const std::string& getTableName() const;
+    const BreakGrid& getGrid() const;
+    sf::FloatRect getPlacementArea() const;
+    int getSampleCount() const;
+    int getObjectBallCount() const;
+    const BreakShot& getBestBreak() const; // Found once on open, the most balls for the fewest scratches
+};
@@ -0,0 +1,412 @@
+#include "calibration.h"
+#include "simulation.h"
+#include "worker_pool.h"
+#include "logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+
+namespace {
+
+const int parameterCount = 4;
+
+// Search range of every parameter, the simplex works on [0, 1] inside it
+const double lowerBound[parameterCount] = { 0.95, 0.3, 0.3, 0.001 };
+const double upperBound[parameterCount] = { 0.999, 1.0, 1.0, 0.3 };
+
+const char* const parameterNames[parameterCount] = { "friction", "restitution", "cushion_restitution", "min_velocity" };
+
+float* parameterField(PhysicsParameters& physics, int index) {
+    switch (index) {
+        case 0: return &physics.friction;
+        case 1: return &physics.restitution;
+        case 2: return &physics.cushionRestitution;
+        default: return &physics.minVelocityThreshold;
+    }
+}
+
+PhysicsParameters toParameters(const std::vector<double>& point) {
+    PhysicsParameters physics;
+    for (int i = 0; i < parameterCount; ++i) {
+        double t = std::max(0.0, std::min(1.0, point[i]));
+        *parameterField(physics, i) = static_cast<float>(lowerBound[i] + t * (upperBound[i] - lowerBound[i]));
+    }
+    return physics;
+}
+
+std::vector<double> toPoint(PhysicsParameters physics) {
+    std::vector<double> point(parameterCount);
+    for (int i = 0; i < parameterCount; ++i) {
+        double t = (*parameterField(physics, i) - lowerBound[i]) / (upperBound[i] - lowerBound[i]);
+        point[i] = std::max(0.0, std::min(1.0, t));
+    }
+    return point;
+}
+
+void atomicAdd(std::atomic<double>& total, double value) {
+    double expected = total.load(std::memory_order_relaxed);
+    while (!total.compare_exchange_weak(expected, expected + value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+
+/* === PhysicsCalibration Class Definition STARTS HERE === */
+
+PhysicsCalibration::PhysicsCalibration(const TableSpec& spec, const CalibrationSettings& settings)
+    : spec(spec), settings(settings), sampleCount(0), workers(nullptr), frames(0), abandoned(0) {
+    this->settings.threads = std::max(1, settings.threads);
+    if (this->settings.threads > 1) {
+        workers = new WorkerPool(this->settings.threads);
+    }
+    for (int i = 0; i < this->settings.threads; ++i) {
+        simulations.push_back(new Simulation(spec));
+    }
+}
+
+PhysicsCalibration::~PhysicsCalibration() {
+    for (Simulation* simulation : simulations) {
+        delete simulation;
+    }
+    delete workers;
+}
+
+bool PhysicsCalibration::loadTracks(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        BILLIARD_LOG(Error, Physics) << "Cannot open the track file " << path;
+        return false;
+    }
+
+    std::map<int, std::vector<TrackSample>> samplesByShot;
+    std::string line;
+    int lineNumber = 0;
+    int rejectedLines = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#' || (lineNumber == 1 && line.find("shot") != std::string::npos)) continue;
+
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        int shot;
+        TrackSample sample;
+        if (!(fields >> shot >> sample.time >> sample.ball >> sample.position.x >> sample.position.y) || sample.ball < 0) {
+            ++rejectedLines;
+            continue;
+        }
+        samplesByShot[shot].push_back(sample);
+    }
+
+    const float frameRate = static_cast<float>(spec.frLimit);
+    const int shotsBefore = this->getShotCount();
+    int rejectedShots = 0;
+    for (auto& entry : samplesByShot) {
+        std::vector<TrackSample>& samples = entry.second;
+        std::stable_sort(samples.begin(), samples.end(), [](const TrackSample& a, const TrackSample& b) { return a.time < b.time; });
+        const float startTime = samples.front().time;
+
+        int ballCount = 0;
+        for (TrackSample& sample : samples) {
+            sample.time -= startTime;
+            ballCount = std::max(ballCount, sample.ball + 1);
+        }
+
+        TrackedShot shot;
+        shot.start.resize(ballCount);
+        shot.samples = samples;
+        bool complete = true;
+        for (int ball = 0; ball < ballCount && complete; ++ball) {
+            auto first = std::find_if(samples.begin(), samples.end(), [ball](const TrackSample& sample) { return sample.ball == ball; });
+            complete = first != samples.end() && first->time * frameRate <= 0.5f; // Not missing or first seen after the shot began
+            if (complete) shot.start[ball] = first->position;
+        }
+
+        if (complete) {
+            this->addShot(shot);
+        } else {
+            ++rejectedShots;
+        }
+    }
+
+    if (rejectedLines > 0 || rejectedShots > 0) {
+        BILLIARD_LOG(Warning, Physics) << path << ": skipped " << rejectedLines << " malformed lines and " << rejectedShots
+                                       << " shots without a starting sample for every ball";
+    }
+    BILLIARD_LOG(Info, Physics) << "Loaded " << (this->getShotCount() - shotsBefore) << " shots from " << path;
+    return this->getShotCount() > shotsBefore;
+}
+
+void PhysicsCalibration::addShot(const TrackedShot& shot) {
+    sampleCount += shot.samples.size();
+    shots.push_back(shot);
+}
+
+double PhysicsCalibration::replay(Simulation& simulation, const TrackedShot& shot, double budget, long long& steps) const {
+    // The simulation racks its cue ball last, the tracks number it 0
+    const int ballCount = static_cast<int>(shot.start.size());
+    auto simulationId = [ballCount](int ball) { return ball == 0 ? ballCount - 1 : ball - 1; };
+
+    std::vector<sf::Vector2f> positions(ballCount);
+    for (int ball = 0; ball < ballCount; ++ball) {
+        positions[simulationId(ball)] = shot.start[ball];
+    }
+    simulation.rack(positions);
+
+    // A ball moves by v, then v * friction, ... so after k frames it is v * (1 - friction^k) / (1 - friction) away
+    // from its start. The least squares v of the start window samples under the candidate's friction:
+    const float frameRate = static_cast<float>(spec.frLimit);
+    const double friction = simulation.getPhysics().friction;
+    std::vector<sf::Vector2<double>> weightedOffsets(ballCount, sf::Vector2<double>(0.0, 0.0));
+    std::vector<double> weights(ballCount, 0.0);
+    for (const TrackSample& sample : shot.samples) {
+        if (sample.time > settings.startWindow) break;
+        const int frame = static_cast<int>(sample.time * frameRate + 0.5f);
+        const double travel = friction < 1.0 ? (1.0 - std::pow(friction, frame)) / (1.0 - friction) : frame;
+        const sf::Vector2f offset = sample.position - shot.start[sample.ball];
+        weightedOffsets[sample.ball] += sf::Vector2<double>(offset.x * travel, offset.y * travel);
+        weights[sample.ball] += travel * travel;
+    }
+
+    BallPool& ballPool = simulation.getBallPool();
+    for (int ball = 0; ball < ballCount; ++ball) {
+        if (weights[ball] <= 0.0) continue;
+        sf::Vector2f velocity(static_cast<float>(weightedOffsets[ball].x / weights[ball]), static_cast<float>(weightedOffsets[ball].y / weights[ball]));
+        const float minVelocity = simulation.getPhysics().minVelocityThreshold;
+        if (std::abs(velocity.x) < minVelocity && std::abs(velocity.y) < minVelocity) continue;
+        ballPool.get(simulationId(ball)).setVelocity(velocity);
+        ballPool.wake(simulationId(ball));
+    }
+
+    // Every sample is compared with the state of the nearest frame
+    const double outlierError = static_cast<double>(settings.outlierDistance) * settings.outlierDistance;
+    double error = 0.0;
+    int frame = 0;
+    for (const TrackSample& sample : shot.samples) {
+        const int sampleFrame = static_cast<int>(sample.time * frameRate + 0.5f);
+        while (frame < sampleFrame && frame < settings.maxShotFrames && simulation.isMoving()) {
+            simulation.step();
+            ++frame;
+            ++steps;
+        }
+
+        sf::Vector2f offset = ballPool.get(simulationId(sample.ball)).getPosition() - sample.position;
+        error += std::min(outlierError, static_cast<double>(offset.x * offset.x + offset.y * offset.y));
+        if (error > budget) break;
+    }
+    return error;
+}
+
+double PhysicsCalibration::evaluate(const PhysicsParameters& physics, double bound) {
+    std::atomic<double> total(0.0);
+    std::atomic<int> nextShot(0);
+    std::atomic<bool> exceeded(false);
+    std::atomic<long long> steps(0);
+    const int shotCount = this->getShotCount();
+
+    auto job = [&](int thread) {
+        Simulation& simulation = *simulations[thread];
+        simulation.setPhysics(physics);
+        long long threadSteps = 0;
+        for (int index = nextShot.fetch_add(1); index < shotCount && !exceeded.load(std::memory_order_relaxed); index = nextShot.fetch_add(1)) {
+            // The total only grows, so once this shot alone takes it past the bound the candidate has lost
+            double budget = bound - total.load(std::memory_order_relaxed);
+            double error = this->replay(simulation, shots[index], budget, threadSteps);
+            atomicAdd(total, error);
+            if (total.load(std::memory_order_relaxed) > bound) exceeded.store(true, std::memory_order_relaxed);
+        }
+        steps.fetch_add(threadSteps, std::memory_order_relaxed);
+    };
+
+    if (workers) {
+        workers->run(job);
+    } else {
+        job(0);
+    }
+
+    frames += steps.load();
+    if (exceeded.load()) ++abandoned;
+    return total.load();
+}
+
+CalibrationResult PhysicsCalibration::fit(const PhysicsParameters& initial) {
+    const auto started = std::chrono::steady_clock::now();
+    const double infinity = std::numeric_limits<double>::infinity();
+    frames = 0;
+    abandoned = 0;
+
+    CalibrationResult result;
+    result.physics = initial;
+    if (shots.empty() || sampleCount == 0) {
+        BILLIARD_LOG(Error, Physics) << "No tracked shots to calibrate against";
+        return result;
+    }
+
+    // Nelder-Mead on the normalized parameters. Every simplex steps away from its first point along each axis
+    std::vector<std::vector<double>> simplex(parameterCount + 1);
+    std::vector<double> errors(parameterCount + 1);
+    int evaluations = 0;
+    auto buildSimplex = [&](const std::vector<double>& from, double fromError, double size) {
+        for (std::size_t i = 0; i < simplex.size(); ++i) {
+            simplex[i] = from;
+            if (i > 0) simplex[i][i - 1] += from[i - 1] > 1.0 - size ? -size : size;
+            errors[i] = i > 0 ? this->evaluate(toParameters(simplex[i]), infinity) : fromError;
+            evaluations += i > 0 ? 1 : 0;
+        }
+    };
+    const std::vector<double> start = toPoint(initial);
+    const double startError = this->evaluate(toParameters(start), infinity);
+    ++evaluations;
+    buildSimplex(start, startError, 0.1);
+    result.initialError = std::sqrt(startError / sampleCount);
+
+    // The error surface is rough where shots tip over at close collisions, so a collapsed simplex starts over
+    // around its best point, until a restart no longer finds anything better
+    double restartError = startError;
+
+    std::vector<int> order(simplex.size());
+    auto combine = [](const std::vector<double>& from, const std::vector<double>& to, double t) {
+        std::vector<double> point(parameterCount);
+        for (int i = 0; i < parameterCount; ++i) {
+            point[i] = std::max(0.0, std::min(1.0, from[i] + t * (to[i] - from[i])));
+        }
+        return point;
+    };
+
+    while (evaluations < settings.maxEvaluations) {
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return errors[a] < errors[b]; });
+        const int best = order.front();
+        const int worst = order.back();
+        const int secondWorst = order[order.size() - 2];
+
+        if (errors[worst] - errors[best] <= settings.tolerance * errors[best]) {
+            if (errors[best] >= restartError * (1.0 - settings.tolerance)) break;
+            restartError = errors[best];
+            buildSimplex(simplex[best], errors[best], 0.05);
+            continue;
+        }
+
+        std::vector<double> centroid(parameterCount, 0.0);
+        for (std::size_t i = 0; i < simplex.size(); ++i) {
+            if (static_cast<int>(i) == worst) continue;
+            for (int p = 0; p < parameterCount; ++p) centroid[p] += simplex[i][p] / parameterCount;
+        }
+
+        // Each trial point only matters if it beats a known error, that error is its abort bound
+        std::vector<double> reflected = combine(centroid, simplex[worst], -1.0);
+        double reflectedError = this->evaluate(toParameters(reflected), errors[worst]);
+        ++evaluations;
+
+        if (reflectedError < errors[best]) {
+            std::vector<double> expanded = combine(centroid, simplex[worst], -2.0);
+            double expandedError = this->evaluate(toParameters(expanded), reflectedError);
+            ++evaluations;
+            if (expandedError < reflectedError) {
+                simplex[worst] = expanded;
+                errors[worst] = expandedError;
+            } else {
+                simplex[worst] = reflected;
+                errors[worst] = reflectedError;
+            }
+        } else if (reflectedError < errors[secondWorst]) {
+            simplex[worst] = reflected;
+            errors[worst] = reflectedError;
+        } else {
+            const bool outside = reflectedError < errors[worst];
+            std::vector<double> contracted = combine(centroid, outside ? reflected : simplex[worst], 0.5);
+            double bound = outside ? reflectedError : errors[worst];
+            double contractedError = this->evaluate(toParameters(contracted), bound);
+            ++evaluations;
+            if (contractedError < bound) {
+                simplex[worst] = contracted;
+                errors[worst] = contractedError;
+            } else {
+                for (std::size_t i = 0; i < simplex.size(); ++i) {
+                    if (static_cast<int>(i) == best) continue;
+                    simplex[i] = combine(simplex[best], simplex[i], 0.5);
+                    errors[i] = this->evaluate(toParameters(simplex[i]), infinity);
+                    ++evaluations;
+                }
+            }
+        }
+
+        if (evaluations % 20 < 2) {
+            double bestError = *std::min_element(errors.begin(), errors.end());
+            BILLIARD_LOG(Debug, Physics) << "Calibration: " << evaluations << " evaluations, RMS error " << std::sqrt(bestError / sampleCount) << " px";
+        }
+    }
+
+    const int best = static_cast<int>(std::min_element(errors.begin(), errors.end()) - errors.begin());
+    result.physics = toParameters(simplex[best]);
+    result.error = std::sqrt(errors[best] / sampleCount);
+    result.evaluations = evaluations;
+    result.abandoned = abandoned;
+    result.frames = frames;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+double PhysicsCalibration::getError(const PhysicsParameters& physics) {
+    if (sampleCount == 0) return 0.0;
+    return std::sqrt(this->evaluate(physics, std::numeric_limits<double>::infinity()) / sampleCount);
+}
+
+bool PhysicsCalibration::saveParameters(const std::string& path, const PhysicsParameters& physics) {
+    std::ofstream out(path);
+    PhysicsParameters values = physics;
+    out.precision(9);
+    for (int i = 0; i < parameterCount; ++i) {
+        out << parameterNames[i] << " " << *parameterField(values, i) << "\n";
+    }
+    if (!out) {
+        BILLIARD_LOG(Error, Physics) << "Failed to write the physics parameters to " << path;
+        return false;
+    }
+    return true;
+}
+
+bool PhysicsCalibration::loadParameters(const std::string& path, PhysicsParameters& physics) {
+    std::ifstream in(path);
+    if (!in) {
+        BILLIARD_LOG(Error, Physics) << "Cannot open the physics parameters " << path;
+        return false;
+    }
+
+    // Names that are missing keep their current value
+    PhysicsParameters values = physics;
+    std::string name;
+    float value;
+    while (in >> name >> value) {
+        int index = static_cast<int>(std::find_if(parameterNames, parameterNames + parameterCount,
+                                                  [&](const char* known) { return name == known; }) - parameterNames);
+        if (index == parameterCount) {
+            BILLIARD_LOG(Warning, Physics) << path << ": unknown parameter " << name;
+            continue;
+        }
+        *parameterField(values, index) = value;
+    }
+    if (!in.eof()) {
+        BILLIARD_LOG(Error, Physics) << path << ": expected \"name value\" lines";
+        return false;
+    }
+
+    physics = values;
+    return true;
+}
+
+// Getter Functions
+
+int PhysicsCalibration::getShotCount() const {
+    return static_cast<int>(shots.size());
+}
+
+std::size_t PhysicsCalibration::getSampleCount() const {
+    return sampleCount;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <SFML\System.hpp>
+#include <string>
+#include <vector>
+
+#include "table_spec.h"
+
+class Simulation;
+class WorkerPool;
+
+
+/*
+    Physics Calibration
+
+    Fits the fixed-step PhysicsParameters (friction, ball and cushion restitution, the stop
+    threshold) to ball tracks measured on a real table. A track file is CSV, one sample per
+    line, positions in table pixels and times in seconds:
+
+        shot,time,ball,x,y
+        0,0.000,0,750.0,750.0
+        0,0.016,0,761.8,750.4
+
+    Ball 0 is the cue ball and every ball of a shot needs a sample at its start. A shot
+    starts from the first sample of every ball. Its starting velocities are fitted to the
+    samples of the first startWindow seconds, under the friction of the candidate being
+    scored, so the tracker's frames right after the hit must be kept.
+
+    A candidate is scored by replaying every shot in a Simulation and summing the squared
+    distance between each sample and the simulated ball at that time. Distances are capped at
+    outlierDistance: a shot that tips the other way at a close collision drifts hundreds of
+    pixels off with any parameters, and it must not outweigh the shots that agree. Nelder-Mead searches
+    the parameters without derivatives. The shots of a candidate are spread over a worker
+    pool, and the candidate is abandoned as soon as its running error shows it cannot beat
+    the simplex point it would replace.
+*/
+
+struct TrackSample {
+    float time;            // Seconds since the shot started
+    int ball;
+    sf::Vector2f position;
+};
+
+struct TrackedShot {
+    std::vector<sf::Vector2f> start;  // Per ball, ball 0 is the cue ball
+    std::vector<TrackSample> samples; // By time
+};
+
+struct CalibrationSettings {
+    int threads = 1;
+    int maxEvaluations = 300;
+    double tolerance = 1e-4;       // Relative error spread over the simplex that ends the search
+    float startWindow = 0.05f;     // Seconds of samples the starting velocities are fitted to
+    float outlierDistance = 25.0f; // Pixels, further samples count as this far
+    int maxShotFrames = 5000;
+};
+
+struct CalibrationResult {
+    PhysicsParameters physics;
+    double error = 0.0;         // Root mean square of the capped distances over every sample, px
+    double initialError = 0.0;
+    int evaluations = 0;
+    int abandoned = 0;          // Candidates cut short by the early abort
+    long long frames = 0;       // Physics steps simulated in total
+    double seconds = 0.0;
+};
+
+class PhysicsCalibration {
+private:
+    const TableSpec& spec;
+    CalibrationSettings settings;
+    std::vector<TrackedShot> shots;
+    std::size_t sampleCount;
+    WorkerPool* workers;
+    std::vector<Simulation*> simulations; // One per thread
+    long long frames;
+    int abandoned;
+
+    double replay(Simulation& simulation, const TrackedShot& shot, double budget, long long& steps) const;
+    double evaluate(const PhysicsParameters& physics, double bound); // Squared error sum, anything above bound is only a lower bound
+
+public:
+    explicit PhysicsCalibration(const TableSpec& spec, const CalibrationSettings& settings = CalibrationSettings());
+    ~PhysicsCalibration();
+    PhysicsCalibration(const PhysicsCalibration&) = delete;
+    PhysicsCalibration& operator=(const PhysicsCalibration&) = delete;
+
+    bool loadTracks(const std::string& path); // Adds the shots of a CSV file
+    void addShot(const TrackedShot& shot);
+
+    CalibrationResult fit(const PhysicsParameters& initial);
+    double getError(const PhysicsParameters& physics); // Root mean square of the capped distances, px
+
+    // Getter Functions
+    int getShotCount() const;
+    std::size_t getSampleCount() const;
+
+    // "name value" lines, the format --physics reads
+    static bool saveParameters(const std::string& path, const PhysicsParameters& physics);
+    static bool loadParameters(const std::string& path, PhysicsParameters& physics);
+};
@@ -0,0 +1,290 @@
+#include "contact_solver.h"
+#include "game.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* === ContactSolver Class Definition STARTS HERE === */
+
+ContactSolver::ContactSolver(const ContactSolverSettings& settings) : workers(nullptr) {
+    setSettings(settings);
+}
+
+ContactSolver::~ContactSolver() {
+    delete workers;
+}
+
+void ContactSolver::clear() {
+    contacts.clear();
+    previous.clear();
+    stats = ContactSolverStats();
+}
+
+void ContactSolver::reserve(std::size_t ballCount) {
+    // Equal discs touch in at most 3n pairs, the rest is slack for overlapping balls
+    const std::size_t contactCount = 4 * ballCount;
+    contacts.reserve(contactCount);
+    previous.reserve(contactCount);
+    coloringScratch.reserve(contactCount);
+    if (corrections.size() < ballCount) {
+        corrections.resize(ballCount);
+    }
+    if (ballColors.size() < ballCount) {
+        ballColors.resize(ballCount, 0);
+    }
+    batchStart.reserve(maxColors + 2);
+    batchCursor.reserve(maxColors + 1);
+}
+
+void ContactSolver::addContact(int a, int b) {
+    if (a > b) std::swap(a, b);
+
+    Contact contact;
+    contact.key = (static_cast<sf::Uint64>(a) << 32) | static_cast<sf::Uint64>(b);
+    contact.a = a;
+    contact.b = b;
+    contact.penetration = 0.0f;
+    contact.targetVelocity = 0.0f;
+    contact.impulse = 0.0f;
+    contact.color = 0;
+    contacts.push_back(contact);
+}
+
+void ContactSolver::restoreContact(int a, int b, float impulse) {
+    this->addContact(a, b);
+    contacts.back().impulse = impulse;
+    previous.push_back(contacts.back());
+    contacts.pop_back();
+}
+
+void ContactSolver::buildBatches(std::size_t ballCount) {
+    if (ballColors.size() < ballCount) {
+        ballColors.resize(ballCount, 0);
+    }
+
+    // Greedy coloring in key order, each contact takes the lowest color free at both balls
+    int colorCount = 0;
+    for (Contact& contact : contacts) {
+        sf::Uint64 used = ballColors[contact.a] | ballColors[contact.b];
+        int color = 0;
+        while (color < maxColors && (used >> color & 1)) ++color;
+        if (color < maxColors) {
+            ballColors[contact.a] |= sf::Uint64(1) << color;
+            ballColors[contact.b] |= sf::Uint64(1) << color;
+        }
+        contact.color = color;
+        colorCount = std::max(colorCount, color + 1);
+    }
+
+    // Counting sort by color, stable so every batch stays in key order
+    batchStart.assign(colorCount + 1, 0);
+    for (const Contact& contact : contacts) {
+        ++batchStart[contact.color + 1];
+    }
+    for (int color = 1; color <= colorCount; ++color) {
+        batchStart[color] += batchStart[color - 1];
+    }
+    coloringScratch.resize(contacts.size());
+    batchCursor.assign(batchStart.begin(), batchStart.end() - 1);
+    for (const Contact& contact : contacts) {
+        coloringScratch[batchCursor[contact.color]++] = contact;
+    }
+    contacts.swap(coloringScratch);
+
+    for (const Contact& contact : contacts) {
+        ballColors[contact.a] = 0;
+        ballColors[contact.b] = 0;
+    }
+    stats.colors = colorCount;
+}
+
+template <const TableSpec& Spec>
+void ContactSolver::solve(BallPool& ballPool, const PhysicsParameters& physics) {
+    const float restitution = physics.restitution;
+    const float restingSpeed = physics.minVelocityThreshold; // Slower closing speeds do not bounce
+    constexpr float effectiveMass = 0.5f;                      // Two balls of unit mass
+    constexpr std::size_t parallelContacts = 1024;             // Fewer contacts are not worth waking the workers
+
+    stats = ContactSolverStats();
+    stats.contacts = static_cast<int>(contacts.size());
+
+    // Canonical order, the gather order must not change the outcome
+    std::sort(contacts.begin(), contacts.end(), [](const Contact& x, const Contact& y) { return x.key < y.key; });
+    contacts.erase(std::unique(contacts.begin(), contacts.end(), [](const Contact& x, const Contact& y) { return x.key == y.key; }), contacts.end());
+
+    if (corrections.size() < ballPool.size()) {
+        corrections.resize(ballPool.size());
+    }
+
+    // The plain solve is a single batch in key order in which a ball can appear many times
+    const bool colored = settings.graphColoring;
+    std::size_t sharedBatch = 0;
+    if (colored) {
+        buildBatches(ballPool.size());
+        sharedBatch = stats.colors > maxColors ? static_cast<std::size_t>(maxColors) : batchStart.size();
+    } else {
+        batchStart.assign({ 0, contacts.size() });
+    }
+    const std::size_t batchCount = batchStart.size() - 1;
+
+    auto body = [&](int thread, int threadCount) {
+        // Contacts of this thread inside a batch, a shared batch stays on thread 0
+        auto forBatch = [&](std::size_t batch, auto&& visit) {
+            std::size_t begin = batchStart[batch];
+            std::size_t end = batchStart[batch + 1];
+            if (batch != sharedBatch) {
+                std::size_t length = end - begin;
+                end = begin + length * (thread + 1) / threadCount;
+                begin = begin + length * thread / threadCount;
+            } else if (thread != 0) {
+                return;
+            }
+            for (std::size_t i = begin; i < end; ++i) {
+                visit(contacts[i]);
+            }
+        };
+        auto sync = [&]() {
+            if (threadCount > 1) workers->sync();
+        };
+
+        // Targets see the warm start impulses of the contacts before them
+        for (std::size_t batch = 0; batch < batchCount; ++batch) {
+            forBatch(batch, [&](Contact& contact) {
+                Ball& a = ballPool.get(contact.a);
+                Ball& b = ballPool.get(contact.b);
+
+                sf::Vector2f delta = b.getPosition() - a.getPosition();
+                float distance = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+                contact.normal = distance > 1e-6f ? delta / distance : sf::Vector2f(1.f, 0.f);
+                contact.penetration = 2 * Spec.ball_radius - distance;
+
+                float closing = (b.velocity.x - a.velocity.x) * contact.normal.x + (b.velocity.y - a.velocity.y) * contact.normal.y;
+                contact.targetVelocity = closing < -restingSpeed ? -restitution * closing : 0.0f;
+
+                if (settings.warmStart) {
+                    auto cached = std::lower_bound(previous.begin(), previous.end(), contact.key,
+                                                   [](const Contact& x, sf::Uint64 key) { return x.key < key; });
+                    if (cached != previous.end() && cached->key == contact.key) {
+                        contact.impulse = cached->impulse;
+                        a.velocity -= contact.normal * contact.impulse;
+                        b.velocity += contact.normal * contact.impulse;
+                    }
+                }
+            });
+            sync();
+        }
+
+        for (int iteration = 0; iteration < settings.maxIterations && !contacts.empty(); ++iteration) {
+            float largestChange = 0.0f;
+
+            for (std::size_t batch = 0; batch < batchCount; ++batch) {
+                forBatch(batch, [&](Contact& contact) {
+                    Ball& a = ballPool.get(contact.a);
+                    Ball& b = ballPool.get(contact.b);
+
+                    float relative = (b.velocity.x - a.velocity.x) * contact.normal.x + (b.velocity.y - a.velocity.y) * contact.normal.y;
+                    float accumulated = std::max(0.0f, contact.impulse + (contact.targetVelocity - relative) * effectiveMass);
+                    float change = accumulated - contact.impulse;
+                    contact.impulse = accumulated;
+
+                    a.velocity -= contact.normal * change;
+                    b.velocity += contact.normal * change;
+                    largestChange = std::max(largestChange, std::abs(change));
+                });
+                if (batch + 1 == batchCount) iterationChange[iteration % 2][thread] = largestChange;
+                sync();
+            }
+
+            // Every thread reaches the same decision, a maximum does not depend on the split
+            float residual = 0.0f;
+            for (int t = 0; t < threadCount; ++t) {
+                residual = std::max(residual, iterationChange[iteration % 2][t]);
+            }
+            if (thread == 0) {
+                stats.iterations = iteration + 1;
+                stats.residual = residual;
+            }
+            if (residual <= settings.tolerance) break;
+        }
+
+        // Overlap removal from the positions at the start of the pass, accumulated per ball
+        for (std::size_t batch = 0; batch < batchCount; ++batch) {
+            forBatch(batch, [&](const Contact& contact) {
+                float push = std::max(0.0f, contact.penetration - settings.slop) * settings.positionCorrection * 0.5f;
+                corrections[contact.a] -= contact.normal * push;
+                corrections[contact.b] += contact.normal * push;
+            });
+            sync();
+        }
+        for (std::size_t batch = 0; batch < batchCount; ++batch) {
+            forBatch(batch, [&](const Contact& contact) {
+                for (int id : { contact.a, contact.b }) {
+                    if (corrections[id] != sf::Vector2f(0.f, 0.f)) {
+                        ballPool.get(id).shape.move(corrections[id]);
+                        corrections[id] = sf::Vector2f(0.f, 0.f);
+                    }
+                }
+            });
+            sync();
+        }
+    };
+
+    if (colored && workers && contacts.size() >= parallelContacts) {
+        const int threadCount = workers->getThreadCount();
+        workers->run([&](int thread) { body(thread, threadCount); });
+    } else {
+        body(0, 1);
+    }
+    stats.converged = stats.residual <= settings.tolerance;
+
+    // Keep this step's impulses for the next one, sorted by key again
+    if (colored) {
+        for (std::size_t batch = 1; batch + 1 < batchStart.size(); ++batch) {
+            std::inplace_merge(contacts.begin(), contacts.begin() + batchStart[batch], contacts.begin() + batchStart[batch + 1],
+                               [](const Contact& x, const Contact& y) { return x.key < y.key; });
+        }
+    }
+    previous.swap(contacts);
+    contacts.clear();
+}
+
+// One solver per table, like the Ball kernels
+template void ContactSolver::solve<pool9ftTable>(BallPool&, const PhysicsParameters&);
+template void ContactSolver::solve<snookerTable>(BallPool&, const PhysicsParameters&);
+template void ContactSolver::solve<sandboxTable>(BallPool&, const PhysicsParameters&);
+
+// Getter Functions
+
+const ContactSolverSettings& ContactSolver::getSettings() const {
+    return settings;
+}
+
+const ContactSolverStats& ContactSolver::getStats() const {
+    return stats;
+}
+
+std::size_t ContactSolver::getContactCount() const {
+    return previous.size();
+}
+
+int ContactSolver::getContactBall(std::size_t contact, bool second) const {
+    return second ? previous[contact].b : previous[contact].a;
+}
+
+float ContactSolver::getContactImpulse(std::size_t contact) const {
+    return previous[contact].impulse;
+}
+
+// Setter Functions
+
+void ContactSolver::setSettings(const ContactSolverSettings& settings) {
+    this->settings = settings;
+    this->settings.threads = std::max(1, std::min(settings.threads, maxThreads));
+
+    // Workers only exist for colored solves on more than one thread
+    int threadCount = this->settings.graphColoring ? this->settings.threads : 1;
+    if ((workers ? workers->getThreadCount() : 1) != threadCount) {
+        delete workers;
+        workers = threadCount > 1 ? new WorkerPool(threadCount) : nullptr;
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <SFML\System.hpp>
+#include <vector>
+
+#include "table_spec.h"
+#include "worker_pool.h"
+
+class BallPool;
+
+
+/*
+    Simultaneous Contact Solver
+
+    Replaces resolving contacts one pair at a time. All contacts of a step are gathered
+    first, sorted by their ball ids, and solved together with projected sequential
+    impulses:
+
+      1. every contact gets a target separating speed (the restitution times the closing
+         speed, 0 for resting contacts)
+      2. the impulse of each contact from the previous step is applied up front (warm start)
+      3. iterations add impulse until every contact meets its target or maxIterations runs
+         out; an accumulated impulse can never pull two balls together
+      4. the remaining overlap is pushed apart in one pass, computed from the positions at
+         the start of the pass so the result does not depend on the contact order
+
+    The largest impulse change of the last iteration is kept as the convergence residual.
+    Because the contacts are sorted, the result is the same whatever order the balls were
+    found in.
+
+    With graphColoring the sorted contacts are greedily colored so no ball appears twice
+    in a color. The colors are solved one after the other, always in the same order, and
+    the contacts of one color are split across the worker threads: they touch different
+    balls, so every ball sees its impulses in the same order whatever the thread count and
+    the result is bit for bit the same for 1 or n threads. It differs from the plain key
+    order solve, which stays the serial reference.
+*/
+
+struct ContactSolverSettings {
+    int maxIterations = 10;
+    float tolerance = 0.001f;        // Stop once no impulse changes by more than this (px/frame)
+    bool warmStart = true;
+    float positionCorrection = 0.8f; // Fraction of the overlap removed per step
+    float slop = 0.05f;              // Overlap left alone so resting contacts do not jitter (px)
+    bool graphColoring = false;      // Solve in color batches instead of plain key order
+    int threads = 1;                 // Threads sharing each color batch, including the caller
+};
+
+struct ContactSolverStats {
+    int contacts = 0;
+    int iterations = 0;
+    float residual = 0.0f;
+    bool converged = true;
+    int colors = 0; // Color batches of the last solve, 0 without graphColoring
+};
+
+class ContactSolver {
+private:
+    struct Contact {
+        sf::Uint64 key; // (a << 32) | b with a < b, the sort and warm start key
+        int a;
+        int b;
+        sf::Vector2f normal; // From a to b
+        float penetration;
+        float targetVelocity;
+        float impulse;       // Accumulated along the normal, never negative
+        int color;
+    };
+
+    static const int maxColors = 64;  // Colors tracked per ball, contacts beyond share one serial batch
+    static constexpr int maxThreads = 64;
+
+    ContactSolverSettings settings;
+    ContactSolverStats stats;
+    std::vector<Contact> contacts;
+    std::vector<Contact> previous; // Last step's contacts, sorted by key, for warm starting
+    std::vector<sf::Vector2f> corrections; // Position pass scratch, indexed by ball id
+
+    std::vector<sf::Uint64> ballColors;   // Colors used by each ball id while coloring
+    std::vector<Contact> coloringScratch; // Contacts reordered by color
+    std::vector<std::size_t> batchStart;  // Contacts of batch i are [batchStart[i], batchStart[i + 1])
+    std::vector<std::size_t> batchCursor; // Counting sort scratch, one per color
+    float iterationChange[2][maxThreads]; // Largest change per thread, alternating between iterations
+    WorkerPool* workers;
+
+    void buildBatches(std::size_t ballCount);
+
+public:
+    explicit ContactSolver(const ContactSolverSettings& settings = ContactSolverSettings());
+    ~ContactSolver();
+    ContactSolver(const ContactSolver&) = delete;
+    ContactSolver& operator=(const ContactSolver&) = delete;
+
+    void clear(); // Forgets the warm start cache, call when the ball ids are reused
+    void reserve(std::size_t ballCount); // Room for every contact a rack of that size can have, solve() then never allocates
+    void addContact(int a, int b);
+    void restoreContact(int a, int b, float impulse); // Refills the warm start cache after clear(), in the order the getters give
+    template <const TableSpec& Spec> void solve(BallPool& ballPool, const PhysicsParameters& physics);
+
+    // Getter Functions
+    const ContactSolverSettings& getSettings() const;
+    const ContactSolverStats& getStats() const;
+    // Contacts of the last solve, in key order
+    std::size_t getContactCount() const;
+    int getContactBall(std::size_t contact, bool second) const;
+    float getContactImpulse(std::size_t contact) const;
+
+    // Setter Functions
+    void setSettings(const ContactSolverSettings& settings);
+};
@@ -0,0 +1,84 @@
+#include "dynamic_resolution.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* === DynamicResolution Class Definition STARTS HERE === */
+
+DynamicResolution::DynamicResolution(sf::Vector2u windowSize, const DynamicResolutionSettings& settings)
+    : settings(settings), windowSize(windowSize), scale(1.0f), averageMilliseconds(0.0), framesSinceChange(0) {
+    this->settings.minScale = std::max(this->settings.scaleStep, std::min(this->settings.minScale, 1.0f));
+    this->settings.maxScale = std::max(this->settings.minScale, std::min(this->settings.maxScale, 1.0f));
+
+    unsigned int width = static_cast<unsigned int>(std::ceil(windowSize.x * this->settings.maxScale));
+    unsigned int height = static_cast<unsigned int>(std::ceil(windowSize.y * this->settings.maxScale));
+    scene.create(std::max(1u, width), std::max(1u, height));
+    scene.setSmooth(true);
+    upscaled.setTexture(scene.getTexture());
+
+    setScale(this->settings.maxScale);
+}
+
+sf::RenderTarget& DynamicResolution::begin(const sf::Color& clearColor) {
+    scene.clear(clearColor);
+
+    // Window coordinates in, the top-left scale x scale of the target out
+    sf::View view(sf::FloatRect(0.f, 0.f, static_cast<float>(windowSize.x), static_cast<float>(windowSize.y)));
+    float viewportWidth = scale * windowSize.x / scene.getSize().x;
+    float viewportHeight = scale * windowSize.y / scene.getSize().y;
+    view.setViewport(sf::FloatRect(0.f, 0.f, viewportWidth, viewportHeight));
+    scene.setView(view);
+    return scene;
+}
+
+void DynamicResolution::present(sf::RenderTarget& window) {
+    scene.display();
+
+    int width = static_cast<int>(std::lround(scale * windowSize.x));
+    int height = static_cast<int>(std::lround(scale * windowSize.y));
+    upscaled.setTextureRect(sf::IntRect(0, 0, width, height));
+    upscaled.setScale(static_cast<float>(windowSize.x) / width, static_cast<float>(windowSize.y) / height);
+
+    sf::View view = window.getView();
+    window.setView(window.getDefaultView());
+    window.draw(upscaled);
+    window.setView(view);
+}
+
+void DynamicResolution::reportFrame(double frameMilliseconds, double budgetMilliseconds) {
+    averageMilliseconds = averageMilliseconds == 0.0 ? frameMilliseconds : averageMilliseconds + 0.1 * (frameMilliseconds - averageMilliseconds);
+    if (++framesSinceChange < settings.settleFrames || budgetMilliseconds <= 0.0) return;
+
+    double load = averageMilliseconds / budgetMilliseconds;
+    float target = scale;
+    if (load > settings.highLoad) {
+        // The cost follows the pixel count, the square of the scale
+        target = static_cast<float>(scale * std::sqrt(settings.highLoad / load)) - settings.scaleStep * 0.5f;
+    } else if (load < settings.lowLoad) {
+        target = scale + settings.scaleStep;
+    }
+
+    float previous = scale;
+    setScale(target);
+    if (scale != previous) {
+        framesSinceChange = 0;
+        averageMilliseconds = 0.0; // The old times belong to the old scale
+    }
+}
+
+// Getter Functions
+
+float DynamicResolution::getScale() const {
+    return scale;
+}
+
+const DynamicResolutionSettings& DynamicResolution::getSettings() const {
+    return settings;
+}
+
+// Setter Functions
+
+void DynamicResolution::setScale(float scale) {
+    float snapped = std::round(scale / settings.scaleStep) * settings.scaleStep;
+    this->scale = std::max(settings.minScale, std::min(settings.maxScale, snapped));
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SFML\Graphics.hpp>
+
+
+/*
+    Dynamic Resolution
+
+    The table is drawn into an offscreen target at a fraction of the window size and then
+    stretched over the window with bilinear filtering; the HUD text is drawn afterwards at
+    full resolution. The target is allocated once at the largest scale, a smaller scale
+    only renders into its top-left corner, so changing the scale never reallocates.
+
+    Each frame reports how long it took. The scale follows a smoothed average of those
+    times: above the upper bound of the budget it drops at once by the ratio the pixel
+    count has to shrink, below the lower bound it creeps back up one step at a time, and
+    every change is followed by a few frames of settling before the next one.
+*/
+
+struct DynamicResolutionSettings {
+    float minScale = 0.5f;       // Of the window width and height
+    float maxScale = 1.0f;
+    float scaleStep = 0.05f;     // Scales are multiples of this so the texture rect does not shimmer
+    float highLoad = 0.90f;      // Fraction of the frame budget that lowers the scale
+    float lowLoad = 0.70f;       // Fraction under which the scale goes up again
+    int settleFrames = 15;       // Frames after a change before the next one
+};
+
+class DynamicResolution {
+private:
+    DynamicResolutionSettings settings;
+    sf::Vector2u windowSize;
+    sf::RenderTexture scene;
+    sf::Sprite upscaled;
+    float scale;
+    double averageMilliseconds;  // Exponential average of the reported frame times
+    int framesSinceChange;
+
+public:
+    DynamicResolution(sf::Vector2u windowSize, const DynamicResolutionSettings& settings = DynamicResolutionSettings());
+
+    // Target for the table, cleared and viewed in window coordinates at the current scale
+    sf::RenderTarget& begin(const sf::Color& clearColor);
+    void present(sf::RenderTarget& window); // Stretches the scene over the whole window
+    void reportFrame(double frameMilliseconds, double budgetMilliseconds);
+
+    // Getter Functions
+    float getScale() const;
+    const DynamicResolutionSettings& getSettings() const;
+
+    // Setter Functions
+    void setScale(float scale); // Clamped and snapped to a step
+};
@@ -0,0 +1,658 @@
+#include "event_engine.h"
+#include "game.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* === Closed-form Solvers STARTS HERE === */
+
+namespace {
+
+const double infiniteTime = std::numeric_limits<double>::infinity();
+const double linearEpsilon = 1e-6;  // px/s, slower than this counts as no motion
+const double angularEpsilon = 1e-6; // rad/s
+const double restingContactSpeed = 1.0; // px/s, minimum speed at which two balls part after a contact
+
+double dot(const Vector2d& a, const Vector2d& b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+double length(const Vector2d& v) {
+    return std::sqrt(dot(v, v));
+}
+
+Vector2d toDouble(sf::Vector2f v) {
+    return Vector2d(v.x, v.y);
+}
+
+sf::Vector2f toFloat(const Vector2d& v) {
+    return sf::Vector2f(static_cast<float>(v.x), static_cast<float>(v.y));
+}
+
+// Real roots of a*t^2 + b*t + c, degrades to the linear case when a vanishes
+int solveQuadratic(double a, double b, double c, double roots[2]) {
+    double scale = std::max(std::abs(a), std::max(std::abs(b), std::abs(c)));
+    if (scale == 0.0) return 0;
+
+    if (std::abs(a) <= 1e-12 * scale) {
+        if (std::abs(b) <= 1e-12 * scale) return 0;
+        roots[0] = -c / b;
+        return 1;
+    }
+
+    double discriminant = b * b - 4 * a * c;
+    if (discriminant < 0.0) return 0;
+
+    // Avoids the cancellation of -b + sqrt(discriminant)
+    double q = -0.5 * (b + (b >= 0.0 ? 1.0 : -1.0) * std::sqrt(discriminant));
+    roots[0] = q / a;
+    roots[1] = q != 0.0 ? c / q : roots[0];
+    return 2;
+}
+
+// Real roots of a*t^3 + b*t^2 + c*t + d (Cardano, trigonometric form for three roots)
+int solveCubic(double a, double b, double c, double d, double roots[3]) {
+    double scale = std::max(std::max(std::abs(a), std::abs(b)), std::max(std::abs(c), std::abs(d)));
+    if (scale == 0.0) return 0;
+    if (std::abs(a) <= 1e-12 * scale) return solveQuadratic(b, c, d, roots);
+
+    b /= a;
+    c /= a;
+    d /= a;
+    double q = (3 * c - b * b) / 9;
+    double r = (9 * b * c - 27 * d - 2 * b * b * b) / 54;
+    double discriminant = q * q * q + r * r;
+    double shift = -b / 3;
+
+    if (discriminant > 0.0) {
+        double root = std::sqrt(discriminant);
+        roots[0] = shift + std::cbrt(r + root) + std::cbrt(r - root);
+        return 1;
+    }
+    if (q == 0.0) {
+        roots[0] = shift;
+        return 1;
+    }
+
+    double theta = std::acos(std::max(-1.0, std::min(1.0, r / std::sqrt(-q * q * q))));
+    double m = 2 * std::sqrt(-q);
+    roots[0] = shift + m * std::cos(theta / 3);
+    roots[1] = shift + m * std::cos((theta + 2 * 3.14159265358979323846) / 3);
+    roots[2] = shift + m * std::cos((theta + 4 * 3.14159265358979323846) / 3);
+    return 3;
+}
+
+// Axis-aligned bounds of p + v t + halfA t^2 for t in [0, limit], a coordinate peaks where its velocity is 0
+void pathBounds(const Vector2d& p, const Vector2d& v, const Vector2d& halfA, double limit, Vector2d& low, Vector2d& high) {
+    Vector2d end = p + v * limit + halfA * (limit * limit);
+    low = Vector2d(std::min(p.x, end.x), std::min(p.y, end.y));
+    high = Vector2d(std::max(p.x, end.x), std::max(p.y, end.y));
+
+    double peaks[2] = { halfA.x != 0.0 ? -v.x / (2.0 * halfA.x) : -1.0, halfA.y != 0.0 ? -v.y / (2.0 * halfA.y) : -1.0 };
+    for (double t : peaks) {
+        if (t > 0.0 && t < limit) {
+            Vector2d peak = p + v * t + halfA * (t * t);
+            low = Vector2d(std::min(low.x, peak.x), std::min(low.y, peak.y));
+            high = Vector2d(std::max(high.x, peak.x), std::max(high.y, peak.y));
+        }
+    }
+}
+
+/*
+    First time in [0, limit] where |D + E*t + F*t^2|^2 - radius^2 drops to zero from above,
+    -1 when it never does. The quartic is split at the roots of its derivative so every
+    piece is monotonic, then the first piece that crosses zero is bisected.
+*/
+double firstContact(const Vector2d& D, const Vector2d& E, const Vector2d& F, double radius, double limit, bool startInsideCounts) {
+    const double c4 = dot(F, F);
+    const double c3 = 2 * dot(E, F);
+    const double c2 = dot(E, E) + 2 * dot(D, F);
+    const double c1 = 2 * dot(D, E);
+    const double c0 = dot(D, D) - radius * radius;
+    auto f = [&](double t) { return (((c4 * t + c3) * t + c2) * t + c1) * t + c0; };
+    auto df = [&](double t) { return ((4 * c4 * t + 3 * c3) * t + 2 * c2) * t + c1; };
+
+    // Touching counts only while closing faster than linearEpsilon, rounding must not retrigger a contact
+    if (c0 <= 0.0 && (startInsideCounts || c1 < -2.0 * radius * linearEpsilon)) return 0.0;
+    if (!(limit > 0.0)) return -1.0;
+
+    double critical[3];
+    int criticalCount = solveCubic(4 * c4, 3 * c3, 2 * c2, c1, critical);
+
+    double bounds[5];
+    int boundCount = 0;
+    bounds[boundCount++] = 0.0;
+    for (int i = 0; i < criticalCount; ++i) {
+        double t = critical[i];
+        // Polish the root, the bracket must not cut a dip in half
+        for (int k = 0; k < 2; ++k) {
+            double slope = 12 * c4 * t * t + 6 * c3 * t + 2 * c2;
+            if (slope != 0.0) t -= df(t) / slope;
+        }
+        if (!(t > 0.0 && t < limit)) continue;
+
+        // Insertion keeps the bounds sorted, there are at most three of them
+        int slot = boundCount++;
+        for (; slot > 1 && bounds[slot - 1] > t; --slot) bounds[slot] = bounds[slot - 1];
+        bounds[slot] = t;
+    }
+    bounds[boundCount++] = limit;
+
+    for (int i = 0; i + 1 < boundCount; ++i) {
+        double low = bounds[i];
+        double high = bounds[i + 1];
+        if (f(low) <= 0.0 || f(high) > 0.0) continue;
+
+        for (int k = 0; k < 100 && high - low > 1e-12; ++k) {
+            double mid = 0.5 * (low + high);
+            if (f(mid) > 0.0) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        return high;
+    }
+    return -1.0;
+}
+
+} // namespace
+
+
+/* === MotionSegment Definition STARTS HERE === */
+
+Vector2d MotionSegment::positionAt(double time) const {
+    double dt = std::max(0.0, std::min(time, endTime()) - startTime);
+    return position + velocity * dt + acceleration * (0.5 * dt * dt);
+}
+
+Vector2d MotionSegment::velocityAt(double time) const {
+    double dt = std::max(0.0, std::min(time, endTime()) - startTime);
+    return velocity + acceleration * dt;
+}
+
+Vector2d MotionSegment::spinAt(double time) const {
+    double dt = std::max(0.0, std::min(time, endTime()) - startTime);
+    return spin + spinRate * dt;
+}
+
+double MotionSegment::sideSpinAt(double time) const {
+    double dt = std::max(0.0, std::min(time, endTime()) - startTime);
+    return sideSpin + sideSpinRate * dt;
+}
+
+double MotionSegment::endTime() const {
+    return startTime + duration;
+}
+
+
+/* === EventEngine Class Definition STARTS HERE === */
+
+EventEngine::EventEngine(const TableSpec& spec, const Table& table, const std::vector<sf::Vector2f>& pocketPositions)
+    : spec(spec), captureRadius((spec.hole_radius + spec.ball_radius) * spec.hole_capture_factor), now(0.0), visitStamp(0) {
+    restingGrid.configure(spec.table_offset(), spec.table_dimension(), 2 * spec.ball_radius);
+
+    // The cushions are the edges of the six trapeziums the fixed-step engine collides with
+    for (const sf::ConvexShape* trapezium : { &table.topLeftSecWall, &table.topRightSecWall, &table.bottomLeftSecWall,
+                                              &table.bottomRightSecWall, &table.leftSecWall, &table.rightSecWall }) {
+        std::size_t count = trapezium->getPointCount();
+        std::vector<Vector2d> points;
+        Vector2d centroid;
+        for (std::size_t i = 0; i < count; ++i) {
+            points.push_back(toDouble(trapezium->getTransform().transformPoint(trapezium->getPoint(i))));
+            centroid += points.back() / static_cast<double>(count);
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            Cushion cushion;
+            cushion.start = points[i];
+            cushion.end = points[(i + 1) % count];
+            Vector2d edge = cushion.end - cushion.start;
+            double edgeLength = length(edge);
+            if (edgeLength <= 0.0) continue;
+
+            cushion.normal = Vector2d(-edge.y, edge.x) / edgeLength;
+            if (dot(cushion.normal, (cushion.start + cushion.end) * 0.5 - centroid) < 0.0) {
+                cushion.normal = -cushion.normal;
+            }
+            cushions.push_back(cushion);
+        }
+    }
+
+    for (const sf::Vector2f& pocket : pocketPositions) {
+        pockets.push_back(toDouble(pocket));
+    }
+}
+
+void EventEngine::clear() {
+    balls.clear();
+    movingBalls.clear();
+    restingGrid.clear();
+    events.clear();
+    queue = decltype(queue)();
+    now = 0.0;
+}
+
+void EventEngine::restart() {
+    for (int ball = 0; ball < static_cast<int>(balls.size()); ++ball) {
+        EngineBall& engineBall = balls[ball];
+        if (engineBall.segments.size() == 1) continue;
+
+        Vector2d position = engineBall.segments.front().position;
+        engineBall.segments.resize(1);
+        engineBall.segments.front() = makeSegment(0.0, position, Vector2d(), Vector2d(), 0.0);
+        ++engineBall.version;
+        classify(ball);
+    }
+    events.clear();
+    queue = decltype(queue)();
+    now = 0.0;
+}
+
+int EventEngine::addBall(sf::Vector2f position) {
+    EngineBall ball;
+    ball.version = 0;
+    ball.movingSlot = -1;
+    ball.resting = false;
+    ball.segments.push_back(makeSegment(now, toDouble(position), Vector2d(), Vector2d(), 0.0));
+    balls.push_back(ball);
+
+    int id = static_cast<int>(balls.size()) - 1;
+    if (visited.size() < balls.size()) {
+        visited.resize(balls.size(), 0);
+        restingGrid.reserveIds(balls.size());
+    }
+    classify(id);
+    return id;
+}
+
+void EventEngine::strike(int ball, sf::Vector2f velocity, sf::Vector2f tipOffset) {
+    const MotionSegment& current = balls[ball].segments.back();
+    if (current.pocketed) return;
+
+    // Impulse through the tip contact point: top/back spin rolls around the horizontal axis
+    // across the shot, side spin around the vertical axis
+    const double radius = spec.ball_radius;
+    Vector2d shot = toDouble(velocity);
+    double speed = length(shot);
+    Vector2d direction = speed > 0.0 ? shot / speed : Vector2d();
+    double spinScale = 5.0 * speed / (2.0 * radius);
+
+    Vector2d spin = Vector2d(-direction.y, direction.x) * (spinScale * tipOffset.y);
+    double sideSpin = spinScale * tipOffset.x;
+
+    startSegment(ball, makeSegment(now, current.positionAt(now), shot, spin, sideSpin));
+    predict(ball);
+}
+
+MotionSegment EventEngine::makeSegment(double time, Vector2d position, Vector2d velocity, Vector2d spin, double sideSpin) const {
+    const double radius = spec.ball_radius;
+    const double gravity = spec.gravity;
+
+    MotionSegment segment;
+    segment.startTime = time;
+    segment.pocketed = false;
+    segment.position = position;
+    segment.velocity = velocity;
+    segment.spin = spin;
+    segment.sideSpin = sideSpin;
+    segment.sideSpinRate = 0.0;
+
+    double duration = infiniteTime;
+    Vector2d slip(velocity.x - radius * spin.y, velocity.y + radius * spin.x); // Velocity of the cloth contact point
+    double slipSpeed = length(slip);
+    double speed = length(velocity);
+
+    if (slipSpeed > linearEpsilon) {
+        // Friction opposes the slip until the ball rolls, 2|u| / (7 mu g) later
+        Vector2d direction = slip / slipSpeed;
+        segment.state = MotionState::Sliding;
+        segment.acceleration = -direction * (spec.slidingFriction * gravity);
+        segment.spinRate = Vector2d(-direction.y, direction.x) * (5.0 * spec.slidingFriction * gravity / (2.0 * radius));
+        duration = 2.0 * slipSpeed / (7.0 * spec.slidingFriction * gravity);
+    } else if (speed > linearEpsilon) {
+        Vector2d direction = velocity / speed;
+        segment.state = MotionState::Rolling;
+        segment.spin = Vector2d(-velocity.y, velocity.x) / radius; // Exact rolling, drops the residual slip
+        segment.acceleration = -direction * (spec.rollingFriction * gravity);
+        segment.spinRate = Vector2d(direction.y, -direction.x) * (spec.rollingFriction * gravity / radius);
+        duration = speed / (spec.rollingFriction * gravity);
+    } else {
+        segment.velocity = Vector2d();
+        segment.spin = Vector2d();
+        segment.acceleration = Vector2d();
+        segment.spinRate = Vector2d();
+        segment.state = std::abs(sideSpin) > angularEpsilon ? MotionState::Spinning : MotionState::Stationary;
+    }
+
+    if (std::abs(sideSpin) > angularEpsilon) {
+        double rate = 5.0 * spec.spinFriction * gravity / (2.0 * radius);
+        segment.sideSpinRate = sideSpin > 0.0 ? -rate : rate;
+        duration = std::min(duration, std::abs(sideSpin) / rate);
+    } else {
+        segment.sideSpin = 0.0;
+    }
+
+    segment.duration = duration;
+    return segment;
+}
+
+void EventEngine::startSegment(int ball, const MotionSegment& segment) {
+    EngineBall& engineBall = balls[ball];
+    MotionSegment& previous = engineBall.segments.back();
+    previous.duration = std::max(0.0, segment.startTime - previous.startTime); // Cut short by the event
+
+    engineBall.segments.push_back(segment);
+    ++engineBall.version; // Every prediction made with the old segment is now stale
+    classify(ball);
+}
+
+void EventEngine::classify(int ball) {
+    EngineBall& engineBall = balls[ball];
+    const MotionSegment& segment = engineBall.segments.back();
+    bool moving = !segment.pocketed && (segment.state == MotionState::Sliding || segment.state == MotionState::Rolling);
+    bool resting = !segment.pocketed && !moving;
+
+    if (moving && engineBall.movingSlot < 0) {
+        engineBall.movingSlot = static_cast<int>(movingBalls.size());
+        movingBalls.push_back(ball);
+    } else if (!moving && engineBall.movingSlot >= 0) {
+        int last = movingBalls.back();
+        movingBalls[engineBall.movingSlot] = last;
+        balls[last].movingSlot = engineBall.movingSlot;
+        movingBalls.pop_back();
+        engineBall.movingSlot = -1;
+    }
+
+    if (resting && !engineBall.resting) {
+        restingGrid.insert(ball, toFloat(segment.position));
+    } else if (resting) {
+        restingGrid.move(ball, toFloat(segment.position));
+    } else if (engineBall.resting) {
+        restingGrid.remove(ball);
+    }
+    engineBall.resting = resting;
+}
+
+void EventEngine::predict(int ball) {
+    const MotionSegment& segment = balls[ball].segments.back();
+    if (segment.pocketed) return;
+
+    const unsigned int version = balls[ball].version;
+    const double end = segment.endTime();
+    const bool moving = segment.state == MotionState::Sliding || segment.state == MotionState::Rolling;
+    const double radius = spec.ball_radius;
+
+    if (end < infiniteTime) {
+        queue.push({ end, EngineEventType::Transition, ball, -1, version, 0, 0 });
+    }
+    if (!moving) {
+        // A resting ball can only be hit, the moving ball finds that contact below
+        for (int other : movingBalls) {
+            const MotionSegment& otherSegment = balls[other].segments.back();
+            if (other == ball) continue;
+
+            Vector2d D = otherSegment.positionAt(now) - segment.positionAt(now);
+            Vector2d E = otherSegment.velocityAt(now);
+            Vector2d F = otherSegment.acceleration * 0.5;
+            double t = firstContact(D, E, F, 2 * radius, otherSegment.endTime() - now, false);
+            if (t >= 0.0) {
+                queue.push({ now + t, EngineEventType::BallBall, ball, other, version, balls[other].version, 0 });
+            }
+        }
+        return;
+    }
+
+    const Vector2d p = segment.positionAt(now);
+    const Vector2d v = segment.velocityAt(now);
+    const Vector2d halfA = segment.acceleration * 0.5;
+    const double limit = end - now;
+
+    // Cushion edges, only from the side the normal faces
+    for (int k = 0; k < static_cast<int>(cushions.size()); ++k) {
+        const Cushion& cushion = cushions[k];
+        double distance = dot(cushion.normal, p - cushion.start);
+        if (distance < 0.0) continue;
+
+        double roots[2];
+        int rootCount = solveQuadratic(dot(cushion.normal, halfA), dot(cushion.normal, v), distance - radius, roots);
+        if (distance <= radius && dot(cushion.normal, v) < -linearEpsilon) {
+            rootCount = 1;
+            roots[0] = 0.0;
+        }
+        if (rootCount == 2 && roots[1] < roots[0]) std::swap(roots[0], roots[1]);
+
+        Vector2d edge = cushion.end - cushion.start;
+        for (int r = 0; r < rootCount; ++r) {
+            double t = roots[r];
+            if (t < 0.0 || t > limit) continue;
+            if (dot(cushion.normal, v + segment.acceleration * t) >= 0.0) continue; // Leaving the cushion
+
+            Vector2d contact = p + v * t + halfA * (t * t);
+            double along = dot(contact - cushion.start, edge) / dot(edge, edge);
+            if (along >= 0.0 && along <= 1.0) {
+                queue.push({ now + t, EngineEventType::Cushion, ball, k, version, 0, 0 });
+                break;
+            }
+        }
+
+        // The edge start point, every corner of a trapezium starts exactly one edge
+        double t = firstContact(p - cushion.start, v, halfA, radius, limit, false);
+        if (t >= 0.0) {
+            queue.push({ now + t, EngineEventType::Cushion, ball, k, version, 0, 1 });
+        }
+    }
+
+    for (int k = 0; k < static_cast<int>(pockets.size()); ++k) {
+        double t = firstContact(p - pockets[k], v, halfA, captureRadius, limit, true);
+        if (t >= 0.0) {
+            queue.push({ now + t, EngineEventType::Pocket, ball, k, version, 0, 0 });
+        }
+    }
+
+    auto predictContact = [&](int other) {
+        const MotionSegment& otherSegment = balls[other].segments.back();
+        Vector2d D = p - otherSegment.positionAt(now);
+        Vector2d E = v - otherSegment.velocityAt(now);
+        Vector2d F = halfA - otherSegment.acceleration * 0.5;
+        double t = firstContact(D, E, F, 2 * radius, std::min(end, otherSegment.endTime()) - now, false);
+        if (t >= 0.0) {
+            queue.push({ now + t, EngineEventType::BallBall, ball, other, version, balls[other].version, 0 });
+        }
+        return t;
+    };
+
+    for (int other : movingBalls) {
+        if (other != ball) predictContact(other);
+    }
+
+    if (balls.size() <= broadphaseBalls) {
+        // Resting balls away from the path's bounds cannot be hit
+        Vector2d low, high;
+        pathBounds(p, v, halfA, limit, low, high);
+        low -= Vector2d(2 * radius, 2 * radius);
+        high += Vector2d(2 * radius, 2 * radius);
+
+        for (int other = 0; other < static_cast<int>(balls.size()); ++other) {
+            if (other == ball || !balls[other].resting) continue;
+
+            const Vector2d& q = balls[other].segments.back().position;
+            if (q.x < low.x || q.x > high.x || q.y < low.y || q.y > high.y) continue;
+            predictContact(other);
+        }
+        return;
+    }
+
+    // Crowded tables walk the path through restingGrid in steps of about one cell and stop
+    // once a step holds a contact, nothing further along can come first. Contacts beyond it
+    // are found again if the first one goes stale (see step()).
+    const double speedLimit = std::max(length(v), length(v + segment.acceleration * limit));
+    const double stepTime = speedLimit > 0.0 ? restingGrid.getCellSize() / speedLimit : limit;
+    double firstHit = infiniteTime;
+    ++visitStamp;
+
+    for (double from = 0.0; from < limit && firstHit > from; from += stepTime) {
+        double to = std::min(limit, from + stepTime);
+        Vector2d start = p + v * from + halfA * (from * from);
+        Vector2d low, high;
+        pathBounds(start, v + segment.acceleration * from, halfA, to - from, low, high);
+
+        Vector2d center = (low + high) * 0.5;
+        double reach = std::max(high.x - low.x, high.y - low.y) * 0.5 + 2 * radius;
+        restingGrid.forEachNear(toFloat(center), static_cast<float>(reach), [&](int other) {
+            if (other == ball || visited[other] == visitStamp) return;
+            visited[other] = visitStamp;
+
+            double t = predictContact(other);
+            if (t >= 0.0) firstHit = std::min(firstHit, t);
+        });
+    }
+}
+
+void EventEngine::apply(const Prediction& prediction) {
+    now = std::max(now, prediction.time);
+
+    const double radius = spec.ball_radius;
+    const double restitution = spec.restitution;
+    const MotionSegment& segment = balls[prediction.ball].segments.back();
+    Vector2d p = segment.positionAt(now);
+    Vector2d v = segment.velocityAt(now);
+    Vector2d spin = segment.spinAt(now);
+    double sideSpin = segment.sideSpinAt(now);
+
+    switch (prediction.type) {
+        case EngineEventType::Transition:
+            startSegment(prediction.ball, makeSegment(now, p, v, spin, sideSpin));
+            predict(prediction.ball);
+            break;
+
+        case EngineEventType::BallBall: {
+            const MotionSegment& otherSegment = balls[prediction.other].segments.back();
+            Vector2d otherP = otherSegment.positionAt(now);
+            Vector2d otherV = otherSegment.velocityAt(now);
+            Vector2d otherSpin = otherSegment.spinAt(now);
+            double otherSideSpin = otherSegment.sideSpinAt(now);
+
+            Vector2d normal = otherP - p;
+            double distance = length(normal);
+            if (distance <= 0.0) return;
+            normal /= distance;
+
+            double v1n = dot(v, normal);
+            double v2n = dot(otherV, normal);
+            if (v1n - v2n > 0.0) {
+                // Same exchange as Ball::resolveCollision, the spins are untouched
+                // Slow contacts still part at restingContactSpeed, a pushed cluster would otherwise collide endlessly
+                double average = (v1n + v2n) / 2.0;
+                double separation = std::max(restitution * (v1n - v2n), restingContactSpeed);
+                double newV1n = average - separation / 2.0;
+                double newV2n = average + separation / 2.0;
+                v += normal * (newV1n - v1n);
+                otherV += normal * (newV2n - v2n);
+            }
+
+            startSegment(prediction.ball, makeSegment(now, p, v, spin, sideSpin));
+            startSegment(prediction.other, makeSegment(now, otherP, otherV, otherSpin, otherSideSpin));
+            predict(prediction.ball);
+            predict(prediction.other);
+            break;
+        }
+
+        case EngineEventType::Cushion: {
+            const Cushion& cushion = cushions[prediction.other];
+            Vector2d normal = cushion.normal;
+            if (prediction.corner) {
+                normal = p - cushion.start;
+                double distance = length(normal);
+                if (distance <= 0.0) return;
+                normal /= distance;
+            }
+
+            double vn = dot(v, normal);
+            if (vn < 0.0) {
+                v -= normal * ((1 + restitution) * vn);
+
+                // The rail grips the ball until the contact point stops sliding along it
+                Vector2d tangent(-normal.y, normal.x);
+                double slip = dot(v, tangent) - radius * sideSpin;
+                v -= tangent * (2.0 / 7.0 * slip);
+                sideSpin += 5.0 / 7.0 * slip / radius;
+            }
+
+            startSegment(prediction.ball, makeSegment(now, p, v, spin, sideSpin));
+            predict(prediction.ball);
+            break;
+        }
+
+        case EngineEventType::Pocket: {
+            MotionSegment pocketed = makeSegment(now, p, Vector2d(), Vector2d(), 0.0);
+            pocketed.pocketed = true;
+            startSegment(prediction.ball, pocketed);
+            break;
+        }
+    }
+
+    const MotionSegment& result = balls[prediction.ball].segments.back();
+    events.push_back({ prediction.type, now, prediction.ball, prediction.other, result.state, toFloat(result.position) });
+}
+
+bool EventEngine::step() {
+    while (!queue.empty()) {
+        Prediction prediction = queue.top();
+        queue.pop();
+
+        if (prediction.ballVersion != balls[prediction.ball].version) continue;
+        if (prediction.type == EngineEventType::BallBall && prediction.otherVersion != balls[prediction.other].version) {
+            // The walk through restingGrid stopped at this contact, look further along the path
+            if (balls.size() > broadphaseBalls && balls[prediction.ball].movingSlot >= 0) {
+                predict(prediction.ball);
+            }
+            continue;
+        }
+
+        apply(prediction);
+        return true;
+    }
+    return false;
+}
+
+double EventEngine::simulate(double maxTime, std::size_t maxEvents) {
+    for (std::size_t applied = 0; applied < maxEvents && !queue.empty() && queue.top().time <= maxTime; ++applied) {
+        if (!step()) break;
+    }
+    return now;
+}
+
+// Getter Functions
+
+double EventEngine::getTime() const {
+    return now;
+}
+
+std::size_t EventEngine::getBallCount() const {
+    return balls.size();
+}
+
+const std::vector<EngineEvent>& EventEngine::getEvents() const {
+    return events;
+}
+
+const std::vector<MotionSegment>& EventEngine::getTrajectory(int ball) const {
+    return balls[ball].segments;
+}
+
+const MotionSegment& EventEngine::getSegmentAt(int ball, double time) const {
+    const std::vector<MotionSegment>& segments = balls[ball].segments;
+    auto next = std::upper_bound(segments.begin(), segments.end(), time, [](double t, const MotionSegment& segment) {
+        return t < segment.startTime;
+    });
+    return next == segments.begin() ? segments.front() : *(next - 1);
+}
+
+sf::Vector2f EventEngine::samplePosition(int ball, double time) const {
+    return toFloat(getSegmentAt(ball, time).positionAt(time));
+}
+
+bool EventEngine::isPocketedAt(int ball, double time) const {
+    return getSegmentAt(ball, time).pocketed;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <SFML\System.hpp>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+#include "table_spec.h"
+#include "spatial_grid.h"
+
+class Table;
+
+
+/*
+    Event-driven Analytic Motion Engine
+
+    Alternative to the fixed-step Ball::update loop. Between two events every ball moves on
+    a closed-form segment with constant acceleration, so the engine jumps from one event to
+    the next instead of stepping frames:
+
+      Sliding    the contact point slips, friction opposes the slip and bends the path
+      Rolling    no slip, rolling friction slows the ball along a straight line
+      Spinning   the ball stands still and only its side spin decays
+      Stationary nothing left to do
+
+    Events are ball-ball contacts, cushion contacts against the edges of the Table
+    trapeziums (and their corners), pocket entries and state transitions. Each ball keeps
+    its predictions in a priority queue tagged with a per-ball version, so an event only
+    re-predicts the balls it touched and a shot costs O(events * balls) instead of
+    O(frames * balls). Every segment is kept, so the renderer can sample a ball at any time.
+    simulate() also stops after maxEvents, inelastic contacts inside a frozen cluster can
+    otherwise produce endless events in a finite time.
+
+    Units are pixels and seconds. Collisions follow the fixed-step engine: frictionless
+    balls with spec.restitution along the normal. A cushion reflects the normal velocity
+    with spec.restitution and its grip removes the slip along the rail, which is how side
+    spin changes the rebound angle.
+*/
+
+using Vector2d = sf::Vector2<double>;
+
+enum class MotionState : sf::Uint8 {
+    Stationary,
+    Spinning,
+    Sliding,
+    Rolling
+};
+
+enum class EngineEventType : sf::Uint8 {
+    BallBall,
+    Cushion,
+    Pocket,
+    Transition // The ball changed MotionState or its side spin ran out
+};
+
+struct EngineEvent {
+    EngineEventType type;
+    double time;
+    int ball;
+    int other;         // Second ball, cushion edge or pocket index, -1 for transitions
+    MotionState state; // State of ball once the event is applied
+    sf::Vector2f position;
+};
+
+// One closed-form piece of a ball's motion, valid from startTime for duration seconds
+struct MotionSegment {
+    double startTime;
+    double duration;
+    MotionState state;
+    bool pocketed;
+    Vector2d position;
+    Vector2d velocity;
+    Vector2d acceleration;
+    Vector2d spin;      // Angular velocity around the table axes (rad/s)
+    Vector2d spinRate;
+    double sideSpin;    // Angular velocity around the vertical axis (rad/s)
+    double sideSpinRate;
+
+    Vector2d positionAt(double time) const;
+    Vector2d velocityAt(double time) const;
+    Vector2d spinAt(double time) const;
+    double sideSpinAt(double time) const;
+    double endTime() const;
+};
+
+class EventEngine {
+private:
+    struct Cushion {
+        Vector2d start;
+        Vector2d end;
+        Vector2d normal; // Points away from the trapezium, towards the balls
+    };
+
+    struct Prediction {
+        double time;
+        EngineEventType type;
+        int ball;
+        int other;
+        unsigned int ballVersion;
+        unsigned int otherVersion;
+        int corner; // 1 when a cushion event is against the edge's start point instead of the edge
+
+        bool operator>(const Prediction& other) const { return time > other.time; }
+    };
+
+    struct EngineBall {
+        std::vector<MotionSegment> segments; // Full history, the last one is current
+        unsigned int version;
+        int movingSlot; // Index inside movingBalls, -1 unless sliding or rolling
+        bool resting;   // Stored in restingGrid
+    };
+
+    static const std::size_t broadphaseBalls = 64; // Smaller tables test every resting ball directly
+
+    const TableSpec& spec;
+    std::vector<Cushion> cushions;
+    std::vector<Vector2d> pockets;
+    double captureRadius;
+
+    std::vector<EngineBall> balls;
+    std::vector<int> movingBalls;      // Ids of the sliding and rolling balls, unordered
+    SpatialGrid restingGrid;           // Balls standing still, walked along a moving ball's path
+    std::vector<unsigned int> visited; // Per ball stamp, a resting ball is tested once per predict
+    std::priority_queue<Prediction, std::vector<Prediction>, std::greater<Prediction>> queue;
+    std::vector<EngineEvent> events;
+    double now;
+    unsigned int visitStamp;
+
+    MotionSegment makeSegment(double time, Vector2d position, Vector2d velocity, Vector2d spin, double sideSpin) const;
+    void startSegment(int ball, const MotionSegment& segment);
+    void classify(int ball); // Keeps movingBalls and restingGrid in step with the current segment
+    void predict(int ball);
+    void apply(const Prediction& prediction);
+
+public:
+    EventEngine(const TableSpec& spec, const Table& table, const std::vector<sf::Vector2f>& pocketPositions);
+
+    void clear();
+    void restart(); // Every ball back at rest where it was added, keeps the storage for the next shot
+    int addBall(sf::Vector2f position);
+    // Cue hit at the current time, tipOffset is in ball radii: x is side spin, y is top (+) or back (-) spin
+    void strike(int ball, sf::Vector2f velocity, sf::Vector2f tipOffset);
+    bool step();                                         // Applies the next event, false once everything is at rest
+    double simulate(double maxTime = 120.0, std::size_t maxEvents = 100000); // Runs to rest or a limit, returns the engine time
+
+    // Getter Functions
+    double getTime() const;
+    std::size_t getBallCount() const;
+    const std::vector<EngineEvent>& getEvents() const;
+    const std::vector<MotionSegment>& getTrajectory(int ball) const;
+    const MotionSegment& getSegmentAt(int ball, double time) const;
+    sf::Vector2f samplePosition(int ball, double time) const;
+    bool isPocketedAt(int ball, double time) const;
+};
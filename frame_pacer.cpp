@@ -0,0 +1,148 @@
+#include "frame_pacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+
+/* === FrameTimeHistogram Class Definition STARTS HERE === */
+
+FrameTimeHistogram::FrameTimeHistogram() : buckets(200000 / bucketMicroseconds, 0) {
+    reset();
+}
+
+void FrameTimeHistogram::add(sf::Int64 microseconds, bool missedDeadline) {
+    std::size_t bucket = std::min(buckets.size() - 1, static_cast<std::size_t>(std::max<sf::Int64>(0, microseconds) / bucketMicroseconds));
+    ++buckets[bucket];
+    ++count;
+    if (missedDeadline) ++missed;
+    maxMicroseconds = std::max(maxMicroseconds, microseconds);
+}
+
+void FrameTimeHistogram::reset() {
+    std::fill(buckets.begin(), buckets.end(), 0);
+    count = 0;
+    missed = 0;
+    maxMicroseconds = 0;
+}
+
+double FrameTimeHistogram::percentile(double fraction) const {
+    if (count == 0) return 0.0;
+
+    int rank = std::max(1, static_cast<int>(std::ceil(fraction * count)));
+    int seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            sf::Int64 upperEdge = static_cast<sf::Int64>(i + 1) * bucketMicroseconds;
+            return std::min(upperEdge, maxMicroseconds) / 1000.0;
+        }
+    }
+    return maxMicroseconds / 1000.0;
+}
+
+// Getter Functions
+
+FrameTimeStats FrameTimeHistogram::getStats() const {
+    FrameTimeStats stats;
+    stats.frames = count;
+    stats.missed = missed;
+    stats.p50 = percentile(0.50);
+    stats.p99 = percentile(0.99);
+    stats.max = maxMicroseconds / 1000.0;
+    return stats;
+}
+
+
+/* === FramePacer Class Definition STARTS HERE === */
+
+FramePacer::FramePacer(const FramePacerSettings& settings)
+    : settings(settings), period(Clock::duration::zero()), started(false),
+      sleepMean(0.0), sleepM2(0.0), sleepCount(0), sleepEstimate(0.002) {
+    if (settings.mode != PacingMode::Uncapped && settings.frameRate > 0) {
+        period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / settings.frameRate));
+    }
+}
+
+void FramePacer::apply(sf::Window& window) {
+    window.setFramerateLimit(0);
+    window.setVerticalSyncEnabled(settings.mode == PacingMode::VSync);
+}
+
+void FramePacer::waitUntil(Clock::time_point target) {
+    // Sleep while even a bad overshoot would still land before the target
+    while (std::chrono::duration<double>(target - Clock::now()).count() > sleepEstimate) {
+        Clock::time_point start = Clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        double observed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        ++sleepCount;
+        double delta = observed - sleepMean;
+        sleepMean += delta / sleepCount;
+        sleepM2 += delta * (observed - sleepMean);
+        if (sleepCount > 1) {
+            sleepEstimate = sleepMean + std::sqrt(sleepM2 / (sleepCount - 1));
+        }
+    }
+
+    while (Clock::now() < target) {
+        std::this_thread::yield();
+    }
+}
+
+void FramePacer::endFrame() {
+    Clock::time_point now = Clock::now();
+
+    if (settings.mode == PacingMode::Cap && started) {
+        deadline += period;
+        if (now > deadline + period) {
+            deadline = now; // Too far behind to catch up, start a fresh schedule
+        }
+        waitUntil(deadline);
+        now = Clock::now();
+    } else {
+        deadline = now;
+    }
+
+    if (started) {
+        Clock::duration interval = now - lastFrame;
+        bool missedDeadline = period != Clock::duration::zero() && interval > period + period / 2;
+        histogram.add(std::chrono::duration_cast<std::chrono::microseconds>(interval).count(), missedDeadline);
+    }
+    lastFrame = now;
+    started = true;
+}
+
+void FramePacer::resetStats() {
+    histogram.reset();
+}
+
+bool FramePacer::parseMode(const std::string& name, PacingMode& mode) {
+    for (PacingMode candidate : { PacingMode::VSync, PacingMode::Cap, PacingMode::Uncapped }) {
+        if (name == getModeName(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* FramePacer::getModeName(PacingMode mode) {
+    switch (mode) {
+        case PacingMode::VSync: return "vsync";
+        case PacingMode::Cap: return "cap";
+        case PacingMode::Uncapped: return "uncapped";
+    }
+    return "cap";
+}
+
+// Getter Functions
+
+const FramePacerSettings& FramePacer::getSettings() const {
+    return settings;
+}
+
+FrameTimeStats FramePacer::getStats() const {
+    FrameTimeStats stats = histogram.getStats();
+    stats.target = period != Clock::duration::zero() ? std::chrono::duration<double, std::milli>(period).count() : 0.0;
+    return stats;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <SFML\Graphics.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+
+
+/*
+    Frame Pacing
+
+    VSync     the driver holds display() until the next refresh
+    Cap       a fixed frame rate, waited out by the pacer instead of SFML's coarse sleep:
+              it sleeps in short slices while the remaining time is safely longer than
+              the sleeps have been overshooting, then spins to the deadline
+    Uncapped  frames go out as fast as they are rendered, for benchmarking
+
+    Deadlines advance by whole frame periods so small overshoots do not accumulate into
+    drift; a frame that runs more than a period late starts a fresh schedule instead of
+    rushing the next ones. Every frame interval lands in a histogram, a frame counts as
+    missed when its interval is more than half a period over the target.
+*/
+
+enum class PacingMode {
+    VSync,
+    Cap,
+    Uncapped
+};
+
+struct FramePacerSettings {
+    PacingMode mode = PacingMode::Cap;
+    int frameRate = 60; // Target of Cap, and what VSync is expected to deliver
+};
+
+struct FrameTimeStats {
+    int frames = 0;
+    int missed = 0;       // Intervals more than half a period over the target
+    double p50 = 0.0;     // Milliseconds
+    double p99 = 0.0;
+    double max = 0.0;
+    double target = 0.0;  // 0 when uncapped
+};
+
+// Frame intervals in 50 microsecond buckets up to 200 ms, longer ones share the last bucket
+class FrameTimeHistogram {
+private:
+    static const int bucketMicroseconds = 50;
+    std::vector<int> buckets;
+    int count;
+    int missed;
+    sf::Int64 maxMicroseconds;
+
+    double percentile(double fraction) const; // Milliseconds, the upper edge of its bucket
+
+public:
+    FrameTimeHistogram();
+
+    void add(sf::Int64 microseconds, bool missedDeadline);
+    void reset();
+
+    // Getter Functions
+    FrameTimeStats getStats() const;
+};
+
+class FramePacer {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    FramePacerSettings settings;
+    Clock::duration period;          // Zero unless capped
+    Clock::time_point deadline;      // When the current frame may be shown
+    Clock::time_point lastFrame;
+    bool started;
+
+    // Running estimate of how far a 1 ms sleep overshoots, the spin covers the rest
+    double sleepMean;
+    double sleepM2;
+    int sleepCount;
+    double sleepEstimate;            // Seconds
+
+    FrameTimeHistogram histogram;
+
+    void waitUntil(Clock::time_point target);
+
+public:
+    explicit FramePacer(const FramePacerSettings& settings = FramePacerSettings());
+
+    void apply(sf::Window& window);  // Vertical sync on or off, SFML's own limiter always off
+    void endFrame();                 // Right after display(): waits for the deadline and records the interval
+    void resetStats();
+
+    static bool parseMode(const std::string& name, PacingMode& mode);
+    static const char* getModeName(PacingMode mode);
+
+    // Getter Functions
+    const FramePacerSettings& getSettings() const;
+    FrameTimeStats getStats() const;
+};
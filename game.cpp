@@ -1,157 +1,103 @@
 #include "game.h"
+#include "spectator.h"
+#include "event_engine.h"
+#include "shot_preview.h"
+#include "simulation.h"
+#include "state_history.h"
+#include "asset_bundle.h"
+#include "logger.h"
+#include "dynamic_resolution.h"
+#include <cstdio>
 
 
 /* === Ball Position Engine Definition STARTS HERE === */
 
-std::vector<float> References::generateBallsPositionX(int ballCount, float ballRadius, sf::Vector2f playGroundDimension) {
-    std::vector<float> array;
-
-    if (ballCount == 16) {
-        float baseX = playGroundDimension.x * 3 / 4;  // Base X position for the triangle
-        for (int i = 0; i < 5; ++i) {  // 5 rows
-            float rowOffset = 2 * ballRadius * i;  // Horizontal shift for each row
-            for (int j = 0; j <= i; ++j) {  // Number of balls in the row
-                array.emplace_back(baseX + rowOffset);
-            }
-        }
-        array.emplace_back(playGroundDimension.x / 4);  // Position for the cue ball
-    }
-
-    return array;
-}
-
-
-std::vector<float> References::generateBallsPositionY(int ballCount, float ballRadius, sf::Vector2f playGroundDimension) {
-    std::vector<float> array;
-
-    if (ballCount == 16) {
-        float middleY = playGroundDimension.y / 2;  // Vertical center of the table
-        for (int i = 0; i < 5; ++i) {  // 5 rows
-            for (int j = 0; j <= i; ++j) {
-                float verticalOffset = (j - i / 2.0f) * 2 * ballRadius;  // Center the balls in the row
-                array.emplace_back(middleY + verticalOffset);
-            }
-        }
-        array.emplace_back(middleY);  // Position for the cue ball
-    }
-
-    return array;
-}
-
-
-std::vector<sf::Vector2f> References::generateBallsPositions(int ballcount, float ballRadius, sf::Vector2f playGroundDimension, sf::Vector2f offset) {
-    std::vector<sf::Vector2f> array;
-    std::cout << "Generating positions for " << ballCount << " balls." << std::endl;
-
-    std::vector<float> arrayX = generateBallsPositionX(ballcount, ballRadius, playGroundDimension);
-    std::cout << "Generated X-index positions " << std::endl;
-
-    std::vector<float> arrayY = generateBallsPositionY(ballcount, ballRadius, playGroundDimension);
-    std::cout << "Generated Y-index positions " << std::endl;
-
-    if (arrayX.size() == arrayY.size()) {
-        std::cout << "X-Index and Y-Index aligned, conducting merging" << std::endl;
-        for(int i = 0; i < arrayX.size(); i++) {
-            array.push_back(sf::Vector2f(arrayX[i] + offset.x, arrayY[i] + offset.y));
-        }
-    }
-    std::cout << "Position generation complete." << std::endl;
-    return array;
-}
-
-std::vector<sf::Vector2f> References::generateHolesPositions(int holeCount, float holeRadius, sf::Vector2f playGroundDimension, sf::Vector2f offset) {
+std::vector<sf::Vector2f> generateHolesPositions(const TableSpec& spec) {
     std::vector<sf::Vector2f> array;
     std::vector<sf::Vector2f> positions = {
-        hole_topLeft,       // Hole TopLeft
-        hole_bottomLeft,    // Hole BottomLeft
-        hole_topMid,        // Hole TopMid
-        hole_bottomMid,     // Hole BottomMid
-        hole_topRight,      // Hole TopRight
-        hole_bottomRight    // Hole BottomRight
+        spec.hole_topLeft(),       // Hole TopLeft
+        spec.hole_bottomLeft(),    // Hole BottomLeft
+        spec.hole_topMid(),        // Hole TopMid
+        spec.hole_bottomMid(),     // Hole BottomMid
+        spec.hole_topRight(),      // Hole TopRight
+        spec.hole_bottomRight()    // Hole BottomRight
     };
     
-    std::cout << "Generating positions for " << holeCount << " holes." << std::endl;
+    BILLIARD_LOG(Debug, Setup) << "Generating positions for " << spec.holeCount << " holes.";
 
     for(int i = 0; i < positions.size(); i++) {
         array.push_back(positions[i]);
-        std::cout << "Generated positions for " << " hole-" << i + 1 << std::endl;
+        BILLIARD_LOG(Debug, Setup) << "Generated positions for " << " hole-" << i + 1;
     }
     
-    std::cout << "Generated positions for " << holeCount << " holes." << std::endl;
+    BILLIARD_LOG(Debug, Setup) << "Generated positions for " << spec.holeCount << " holes.";
 
     return array;
 }
 
 /* === positionDisplay Class Definition STARTS HERE === */
 
-void References::displayPosition (std::string log, sf::Vector2f position) {
-    std::cout << log << "-> " << "( " << position.x 
-              << ", " << position.y << ")" << std::endl;
+void displayPosition (std::string log, sf::Vector2f position) {
+    BILLIARD_LOG(Debug, Gameplay) << log << "-> " << "( " << position.x
+                                  << ", " << position.y << ")";
 }
 
 /* === Ball Class Definition STARTS HERE === */
 
-Ball::Ball(sf::Vector2f position, sf::Color color) : velocity(0.f, 0.f) {
-    shape.setRadius(ball_radius);
+Ball::Ball(sf::Vector2f position, sf::Color color, BallType type, const TableSpec& spec) : velocity(0.f, 0.f), id(-1), type(type), pocketed(false), restFrames(0) {
+    reset(position, color, type, spec);
+}
+
+void Ball::reset(sf::Vector2f position, sf::Color color, BallType type, const TableSpec& spec) {
+    const float ball_radius = spec.ball_radius;
+    const float ball_border_width = spec.ball_border_width;
+
+    this->type = type;
+    this->pocketed = false;
+    this->restFrames = 0;
+    velocity = sf::Vector2f(0.f, 0.f);
+
+    if (type == BallType::Striped) {
+        // Striped balls draw their white band as an outline, shrink the fill to keep the same footprint
+        shape.setRadius(ball_radius - ball_border_width / 2);
+        shape.setOrigin(ball_radius - ball_border_width / 2, ball_radius - ball_border_width / 2);
+        shape.setOutlineThickness(ball_border_width);
+        shape.setOutlineColor(sf::Color(spec.ballBorderColor));
+    } else {
+        shape.setRadius(ball_radius);
+        shape.setOrigin(ball_radius, ball_radius);
+        shape.setOutlineThickness(0.f);
+    }
     shape.setPosition(position);
     shape.setFillColor(color);
-    shape.setOrigin(ball_radius, ball_radius);
+    previousPosition = position;
 }
 
-void Ball::draw(sf::RenderWindow& window) { // Pass by reference for better efficiency and maintain original updated state
-    window.draw(shape);
+void Ball::draw(sf::RenderTarget& target) { // Pass by reference for better efficiency and maintain original updated state
+    target.draw(shape);
 }
 
 void Ball::applyForce(const sf::Vector2f& force) {
     velocity += force;
 }
 
+template <const TableSpec& Spec>
 bool Ball::checkCollision(const Ball& other) const {
     float distance = std::sqrt(std::pow(other.getPosition().x - getPosition().x, 2) +
                                std::pow(other.getPosition().y - getPosition().y, 2));
-    return distance <= (ball_radius * 2 + 0.1f); // collision if distance <= 2 * radius
+    return distance <= (Spec.ball_radius * 2 + 0.1f); // collision if distance <= 2 * radius
 }
 
-void Ball::resolveCollision(Ball& other) {
-    sf::Vector2f delta = other.getPosition() - getPosition();
-    float distance = std::sqrt(delta.x * delta.x + delta.y * delta.y);
-
-    // Smallest distance threshold to avoid excessive collision calculations
-    if (distance < 1e-6f) return;
-
-    // Normalized direction vector along the collision normal
-    sf::Vector2f normal = delta / distance;
-    float overlap = (2 * ball_radius - distance) / 2.0f;
-
-    // Adjust overlap to avoid excessive separation
-    float separationFactor = 0.5f; // Factor to reduce separation
-    shape.move(-normal * overlap * separationFactor);
-    other.shape.move(normal * overlap * separationFactor);
-
-    // Tangent vector, perpendicular to normal
-    sf::Vector2f tangent(-normal.y, normal.x);
-
-    // Calculate the normal and tangential components of each ball's velocity
-    float v1n = velocity.x * normal.x + velocity.y * normal.y;
-    float v2n = other.velocity.x * normal.x + other.velocity.y * normal.y;
-    float v1t = velocity.x * tangent.x + velocity.y * tangent.y;
-    float v2t = other.velocity.x * tangent.x + other.velocity.y * tangent.y;
-
-    // Apply conservation of momentum in the normal direction with restitution
-    float newV1n = (v1n * (1 - restitution) + v2n * (1 + restitution)) / 2.0f;
-    float newV2n = (v2n * (1 - restitution) + v1n * (1 + restitution)) / 2.0f;
-
-    // Convert the scalar normal and tangential velocities back to vectors
-    sf::Vector2f v1nVector = newV1n * normal;
-    sf::Vector2f v1tVector = v1t * tangent;  // Keep tangential component unchanged
-    sf::Vector2f v2nVector = newV2n * normal;
-    sf::Vector2f v2tVector = v2t * tangent;  // Keep tangential component unchanged
-
-    // Update the velocities of each ball by combining the normal and tangential components
-    velocity = v1nVector + v1tVector;
-    other.velocity = v2nVector + v2tVector;
+template <const TableSpec& Spec>
+void Ball::resolveCollision(Ball& other, const PhysicsParameters& physics) {
+    PhysicsBall<float> state = getPhysicsState();
+    PhysicsBall<float> otherState = other.getPhysicsState();
+    resolveBallCollision<float, Spec>(state, otherState, physics);
+    setPhysicsState(state);
+    other.setPhysicsState(otherState);
 }
 
+template <const TableSpec& Spec>
 bool Ball::checkCollisionWithTrapezium(const sf::ConvexShape& trapezium) const {
     for (size_t i = 0; i < trapezium.getPointCount(); ++i) {
         // Get the edges of the trapezium
@@ -168,136 +114,277 @@ bool Ball::checkCollisionWithTrapezium(const sf::ConvexShape& trapezium) const {
 
         // Check if the ball intersects the edge
         sf::Vector2f ballToClosest = shape.getPosition() - closestPoint;
-        if (std::sqrt(ballToClosest.x * ballToClosest.x + ballToClosest.y * ballToClosest.y) <= ball_radius) {
+        if (std::sqrt(ballToClosest.x * ballToClosest.x + ballToClosest.y * ballToClosest.y) <= Spec.ball_radius) {
             return true;
         }
     }
     return false;
 }
 
-void Ball::resolveCollisionWithTrapezium(const sf::ConvexShape& trapezium) {
-    for (size_t i = 0; i < trapezium.getPointCount(); ++i) {
-        sf::Vector2f p1 = trapezium.getTransform().transformPoint(trapezium.getPoint(i));
-        sf::Vector2f p2 = trapezium.getTransform().transformPoint(trapezium.getPoint((i + 1) % trapezium.getPointCount()));
+template <const TableSpec& Spec>
+void Ball::resolveCollisionWithTrapezium(const sf::ConvexShape& trapezium, const PhysicsParameters& physics) {
+    PhysicsBall<float> state = getPhysicsState();
+    resolveCushionCollision<float, Spec>(state, CushionPolygon<float>::fromShape(trapezium), physics);
+    setPhysicsState(state);
+}
 
-        sf::Vector2f edge = p2 - p1;
-        float edgeLengthSquared = edge.x * edge.x + edge.y * edge.y;
-        sf::Vector2f ballToEdgeStart = shape.getPosition() - p1;
 
-        float t = std::max(0.0f, std::min(1.0f, (ballToEdgeStart.x * edge.x + ballToEdgeStart.y * edge.y) / edgeLengthSquared));
-        sf::Vector2f closestPoint = p1 + t * edge;
+template <const TableSpec& Spec>
+void Ball::update(const Table& table, const PhysicsParameters& physics) {
+    // Move by the velocity, bounce off the cushions and apply friction, see integrateBall
+    previousPosition = shape.getPosition();
+    PhysicsBall<float> state = getPhysicsState();
+    integrateBall<float, Spec>(state, table.getCushionPolygons(), physics);
+    setPhysicsState(state);
+}
 
-        sf::Vector2f ballToClosest = shape.getPosition() - closestPoint;
-        float distance = std::sqrt(ballToClosest.x * ballToClosest.x + ballToClosest.y * ballToClosest.y);
+// One specialization of every kernel per table, other translation units link against these
+#define BILLIARD_INSTANTIATE_BALL_KERNELS(SPEC) \
+    template bool Ball::checkCollision<SPEC>(const Ball&) const; \
+    template void Ball::resolveCollision<SPEC>(Ball&, const PhysicsParameters&); \
+    template bool Ball::checkCollisionWithTrapezium<SPEC>(const sf::ConvexShape&) const; \
+    template void Ball::resolveCollisionWithTrapezium<SPEC>(const sf::ConvexShape&, const PhysicsParameters&); \
+    template void Ball::update<SPEC>(const Table&, const PhysicsParameters&); \
+    template bool Hole::isBallInHole<SPEC>(const sf::Vector2f&) const; \
+    template bool Hole::sweptCapture<SPEC>(const sf::Vector2f&, const sf::Vector2f&, float&) const;
 
-        if (distance <= ball_radius) {
-            // Calculate the normal vector
-            sf::Vector2f normal = ballToClosest / distance;
+// Getter Functions
 
-            // Reflect the velocity based on the normal
-            velocity -= 2.0f * (velocity.x * normal.x + velocity.y * normal.y) * normal;
+sf::Vector2f Ball::getPosition() const {
+    return shape.getPosition();
+}
 
-            // Apply restitution
-            velocity *= restitution;
+sf::Vector2f Ball::getPreviousPosition() const {
+    return previousPosition;
+}
 
-            // Adjust position to prevent overlap
-            shape.move(normal * (ball_radius - distance));
-            break;
-        }
-    }
+sf::Vector2f Ball::getVelocity() const {
+    return velocity;
 }
 
+PhysicsBall<float> Ball::getPhysicsState() const {
+    PhysicsBall<float> state;
+    state.position = Vec2<float>(shape.getPosition());
+    state.velocity = Vec2<float>(velocity);
+    return state;
+}
 
-void Ball::update(const Table& table) {
-    // Move the ball by its current velocity
-    shape.move(velocity);
+void Ball::setPhysicsState(const PhysicsBall<float>& state) {
+    shape.setPosition(state.position.x, state.position.y);
+    velocity = sf::Vector2f(state.velocity.x, state.velocity.y);
+}
 
-    // Check collisions with trapezium-shaped walls
-    if (checkCollisionWithTrapezium(table.topLeftSecWall)) {
-        resolveCollisionWithTrapezium(table.topLeftSecWall);
-    }
-    if (checkCollisionWithTrapezium(table.topRightSecWall)) {
-        resolveCollisionWithTrapezium(table.topRightSecWall);
+// Setter Functions
+
+void Ball::setPosition(sf::Vector2f position) {
+    this->shape.setPosition(position);
+    this->previousPosition = position;
+}
+
+void Ball::setVelocity(sf::Vector2f velocity) {
+    this->velocity = velocity;
+}
+
+/* === BallPool Class Definition STARTS HERE === */
+
+BallPool::BallPool(const TableSpec& spec) : spec(&spec), used(0) {}
+
+void BallPool::reset(std::size_t expectedCount) {
+    // Keep every constructed slot, they are restyled by spawn() instead of being rebuilt
+    if (slots.capacity() < expectedCount) {
+        slots.reserve(expectedCount);
+        onTable.reserve(expectedCount);
+        tableSlot.reserve(expectedCount);
+        awake.reserve(expectedCount);
+        awakeSlot.reserve(expectedCount);
     }
-    if (checkCollisionWithTrapezium(table.bottomLeftSecWall)) {
-        resolveCollisionWithTrapezium(table.bottomLeftSecWall);
+    used = 0;
+    onTable.clear();
+    tableSlot.clear();
+    awake.clear();
+    awakeSlot.clear();
+
+    grid.configure(spec->table_offset(), spec->table_dimension(), 2 * spec->ball_radius);
+    grid.reserveIds(expectedCount);
+}
+
+Ball& BallPool::spawn(sf::Vector2f position, sf::Color color, BallType type) {
+    int id = static_cast<int>(used);
+    if (used < slots.size()) {
+        slots[used].reset(position, color, type, *spec);
+    } else {
+        slots.emplace_back(position, color, type, *spec);
     }
-    if (checkCollisionWithTrapezium(table.bottomRightSecWall)) {
-        resolveCollisionWithTrapezium(table.bottomRightSecWall);
+    ++used;
+
+    Ball& ball = slots[id];
+    ball.id = id;
+    tableSlot.push_back(static_cast<int>(onTable.size()));
+    onTable.push_back(id);
+    awakeSlot.push_back(-1);
+    grid.insert(id, position);
+    return ball;
+}
+
+void BallPool::pocket(int id) {
+    int slot = tableSlot[id];
+    if (slot < 0) return;
+
+    // Swap-remove, the order of onTable carries no meaning
+    int lastId = onTable.back();
+    onTable[slot] = lastId;
+    tableSlot[lastId] = slot;
+    onTable.pop_back();
+
+    tableSlot[id] = -1;
+    slots[id].pocketed = true;
+    slots[id].setVelocity(sf::Vector2f(0.f, 0.f));
+
+    sleep(id);
+    grid.remove(id);
+}
+
+void BallPool::wake(int id) {
+    slots[id].restFrames = 0;
+    if (awakeSlot[id] >= 0 || tableSlot[id] < 0) return;
+
+    awakeSlot[id] = static_cast<int>(awake.size());
+    awake.push_back(id);
+}
+
+void BallPool::sleep(int id) {
+    int slot = awakeSlot[id];
+    if (slot < 0) return;
+
+    int lastId = awake.back();
+    awake[slot] = lastId;
+    awakeSlot[lastId] = slot;
+    awake.pop_back();
+
+    awakeSlot[id] = -1;
+    slots[id].setVelocity(sf::Vector2f(0.f, 0.f));
+}
+
+void BallPool::place(int id, sf::Vector2f position) {
+    slots[id].setPosition(position);
+    rebin(id);
+    wake(id);
+}
+
+void BallPool::rebin(int id) {
+    grid.move(id, slots[id].getPosition());
+}
+
+void BallPool::restore(int id, sf::Vector2f position, bool inPlay, bool isAwake) {
+    Ball& ball = slots[id];
+    if (!inPlay) {
+        pocket(id);
+        ball.setPosition(position);
+        return;
     }
-    if (checkCollisionWithTrapezium(table.leftSecWall)) {
-        resolveCollisionWithTrapezium(table.leftSecWall);
+
+    ball.setPosition(position);
+    if (tableSlot[id] < 0) {
+        tableSlot[id] = static_cast<int>(onTable.size());
+        onTable.push_back(id);
+        ball.pocketed = false;
+        grid.insert(id, position);
+    } else {
+        grid.move(id, position);
     }
-    if (checkCollisionWithTrapezium(table.rightSecWall)) {
-        resolveCollisionWithTrapezium(table.rightSecWall);
+
+    if (isAwake) {
+        wake(id);
+    } else {
+        sleep(id);
     }
+}
 
-    // Apply friction to gradually slow down the ball
-    velocity *= friction;
+// Getter Functions
 
-    // Threshold to stop small movements
-    if (std::abs(velocity.x) < minVelocityThreshold) velocity.x = 0.0f;
-    if (std::abs(velocity.y) < minVelocityThreshold) velocity.y = 0.0f;
+Ball& BallPool::get(int id) {
+    return slots[id];
 }
 
+const Ball& BallPool::get(int id) const {
+    return slots[id];
+}
 
+std::size_t BallPool::size() const {
+    return used;
+}
 
+const std::vector<int>& BallPool::getOnTable() const {
+    return onTable;
+}
 
+const std::vector<int>& BallPool::getAwake() const {
+    return awake;
+}
 
-// Getter Functions
+bool BallPool::isAwake(int id) const {
+    return awakeSlot[id] >= 0;
+}
 
-sf::Vector2f Ball::getPosition() const {
-    return shape.getPosition();
+int BallPool::getAwakeSlot(int id) const {
+    return awakeSlot[id];
 }
 
-sf::Vector2f Ball::getVelocity() const {
-    return velocity;
+const SpatialGrid& BallPool::getGrid() const {
+    return grid;
 }
 
-// Setter Functions
+/* === InputLatencyMeter Class Definition STARTS HERE === */
 
-void Ball::setPosition(sf::Vector2f position) {
-    this->shape.setPosition(position);
+InputLatencyMeter::InputLatencyMeter() : pendingInput(-1) {
+    reset();
 }
 
-void Ball::setVelocity(sf::Vector2f velocity) {
-    this->velocity = velocity;
+sf::Int64 InputLatencyMeter::now() const {
+    return clock.getElapsedTime().asMicroseconds();
 }
 
-/* === SolidBall Class Definition STARTS HERE === */
+void InputLatencyMeter::markInput(sf::Int64 timestamp) {
+    // Several events before one frame: the frame is as late as the oldest of them
+    if (pendingInput < 0) pendingInput = timestamp;
+}
 
-SolidBall::SolidBall(sf::Vector2f position, sf::Color color) : Ball(position, color) {
-    shape.setRadius(ball_radius);
-    shape.setPosition(position);
-    shape.setOrigin(ball_radius, ball_radius);
-    shape.setFillColor(color);
+void InputLatencyMeter::markPresented() {
+    if (pendingInput < 0) return;
+
+    sf::Int64 latency = now() - pendingInput;
+    totalMicroseconds += latency;
+    maxMicroseconds = std::max(maxMicroseconds, latency);
+    ++samples;
+    pendingInput = -1;
 }
-/* === StripedBall Class Definition STARTS HERE === */
 
-StripedBall::StripedBall(sf::Vector2f position, sf::Color color) : Ball(position, color) {
-    shape.setRadius(ball_radius - ball_border_width / 2);
-    shape.setPosition(position);
-    shape.setOrigin(ball_radius - ball_border_width / 2, ball_radius - ball_border_width / 2);
-    shape.setOutlineThickness(ball_border_width);
-    shape.setOutlineColor(ballBorderColor);
-    shape.setFillColor(color);
+void InputLatencyMeter::reset() {
+    totalMicroseconds = 0;
+    maxMicroseconds = 0;
+    samples = 0;
+}
+
+// Getter Functions
+
+int InputLatencyMeter::getSampleCount() const {
+    return samples;
 }
 
-/* === BlackBall Class Definition STARTS HERE === */
+double InputLatencyMeter::getMeanMilliseconds() const {
+    return samples > 0 ? totalMicroseconds / 1000.0 / samples : 0.0;
+}
 
-BlackBall::BlackBall(sf::Vector2f position, sf::Color color) : Ball(position, color) {
-    shape.setRadius(ball_radius);
-    shape.setPosition(position);
-    shape.setOrigin(ball_radius, ball_radius);
-    shape.setFillColor(color); // Typically black
+double InputLatencyMeter::getMaxMilliseconds() const {
+    return maxMicroseconds / 1000.0;
 }
 
+
+
 /* === CueStick Class Definition STARTS HERE === */
 
-CueStick::CueStick() : power(0.0f) {
-    if (!stickTexture.loadFromFile("./img/cue_stick.png")) {
-        std::cerr << "Failed to load cue stick texture!" << std::endl;
-    }
+CueStick::CueStick(const TableSpec& spec) : spec(spec), power(0.0f) {
+    const sf::Texture& stickTexture = GameAssets::shared().getCueStickTexture();
     stickSprite.setTexture(stickTexture);
     stickSprite.setOrigin(0, stickTexture.getSize().y / 2);
 }
@@ -323,18 +410,18 @@ void CueStick::update(const sf::Vector2f& mousePosition) {
             direction /= length;
         }
 
-        float offsetDistance = std::min(maxOffsetDistance, minOffsetDistance + length / 2.0f);
+        float offsetDistance = std::min(spec.maxOffsetDistance, spec.minOffsetDistance + length / 2.0f);
         sf::Vector2f stickPosition = startPosition + direction * offsetDistance;
         stickSprite.setPosition(stickPosition);
-        stickSprite.setRotation(std::atan2(direction.y, direction.x) * 180.0f / phi);
+        stickSprite.setRotation(std::atan2(direction.y, direction.x) * 180.0f / spec.phi);
 
-        power = std::min(100.0f, length / force_scaling_factor);
+        power = std::min(100.0f, length / spec.force_scaling_factor);
     }
 }
 
-void CueStick::draw(sf::RenderWindow& window) {
+void CueStick::draw(sf::RenderTarget& target) {
     if (isDragging) {
-        window.draw(stickSprite);
+        target.draw(stickSprite);
     }
 }
 
@@ -359,165 +446,212 @@ sf::Vector2f CueStick::getDirection(const sf::Vector2f& cueBallPosition) const {
 
 /* === Hole Class Definitions === */
 
-Hole::Hole(sf::Vector2f position) {
-    shape.setRadius(hole_radius);
-    shape.setOrigin(hole_radius, hole_radius);
+Hole::Hole(sf::Vector2f position, const TableSpec& spec) {
+    shape.setRadius(spec.hole_radius);
+    shape.setOrigin(spec.hole_radius, spec.hole_radius);
     shape.setPosition(position);
-    shape.setFillColor(holeColor); // Default hole color
+    shape.setFillColor(sf::Color(spec.holeColor)); // Default hole color
 }
 
-void Hole::draw(sf::RenderWindow& window) {
-    window.draw(shape);
+void Hole::draw(sf::RenderTarget& target) {
+    target.draw(shape);
 }
 
-bool Hole::isBallInHole(const sf::Vector2f& ballPosition, float ballRadius) const {
-    float distance = std::sqrt(std::pow(getPosition().x - ballPosition.x, 2) +
-                               std::pow(getPosition().y - ballPosition.y, 2));
-    return distance <= ((hole_radius + ballRadius) * 0.7); // Ball is in hole if it overlaps with the hole radius
+template <const TableSpec& Spec>
+bool Hole::isBallInHole(const sf::Vector2f& ballPosition) const {
+    constexpr float captureRadius = (Spec.hole_radius + Spec.ball_radius) * Spec.hole_capture_factor;
+    sf::Vector2f delta = getPosition() - ballPosition;
+    return delta.x * delta.x + delta.y * delta.y <= captureRadius * captureRadius; // Ball is in hole if it overlaps with the hole radius
 }
 
+template <const TableSpec& Spec>
+bool Hole::sweptCapture(const sf::Vector2f& from, const sf::Vector2f& to, float& entryTime) const {
+    constexpr float captureRadius = (Spec.hole_radius + Spec.ball_radius) * Spec.hole_capture_factor;
+
+    // Solve |from + t * path - center| = captureRadius for the first t in [0, 1]
+    sf::Vector2f path = to - from;
+    sf::Vector2f offset = from - getPosition();
+    float c = offset.x * offset.x + offset.y * offset.y - captureRadius * captureRadius;
+    if (c <= 0.0f) {
+        entryTime = 0.0f; // Already inside when the step started
+        return true;
+    }
+
+    float a = path.x * path.x + path.y * path.y;
+    float b = offset.x * path.x + offset.y * path.y;
+    if (a <= 0.0f || b >= 0.0f) return false; // Not moving, or moving away from the hole
+
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) return false; // The path passes beside the capture region
+
+    float t = (-b - std::sqrt(discriminant)) / a;
+    if (t > 1.0f) return false;
+
+    entryTime = t;
+    return true;
+}
+
+BILLIARD_INSTANTIATE_BALL_KERNELS(pool9ftTable)
+BILLIARD_INSTANTIATE_BALL_KERNELS(snookerTable)
+BILLIARD_INSTANTIATE_BALL_KERNELS(sandboxTable)
+
 sf::Vector2f Hole::getPosition() const {
     return shape.getPosition();
 }
 
+const sf::CircleShape& Hole::getShape() const {
+    return shape;
+}
+
 /* === Table Class Definitions === */
 
 // Constructor
 
-Table::Table() {
-    table.setSize(sf::Vector2f(table_width, table_height));
-    table.setFillColor(tableColor);
-    table.setOrigin(table_width / 2, table_height / 2);
-    table.setPosition(window_width / 2, window_height / 2);
+Table::Table(const TableSpec& spec) {
+    const sf::Vector2f hole_topLeft = spec.hole_topLeft();
+    const sf::Vector2f hole_bottomLeft = spec.hole_bottomLeft();
+    const sf::Vector2f hole_topMid = spec.hole_topMid();
+    const sf::Vector2f hole_bottomMid = spec.hole_bottomMid();
+    const sf::Vector2f hole_topRight = spec.hole_topRight();
+    const sf::Vector2f hole_bottomRight = spec.hole_bottomRight();
+
+    table.setSize(sf::Vector2f(spec.table_width, spec.table_height));
+    table.setFillColor(sf::Color(spec.tableColor));
+    table.setOrigin(spec.table_width / 2, spec.table_height / 2);
+    table.setPosition(spec.window_width / 2, spec.window_height / 2);
 
     // Walls
-    topWall.setSize(sf::Vector2f(table_topBottomWall_width, table_topBottomWall_height));
-    topWall.setOrigin(sf::Vector2f(table_topBottomWall_width / 2, table_topBottomWall_height / 2));
-    topWall.setFillColor(tableWallColor);
-    topWall.setPosition(table_topWall);
-    topWallShadow.setSize(sf::Vector2f(table_topBottomWallShadow_width, table_topBottomWallShadow_height));
-    topWallShadow.setOrigin(sf::Vector2f(table_topBottomWallShadow_width / 2, table_topBottomWallShadow_height / 2));
-    topWallShadow.setPosition(table_topWallShadow);
-    topWallShadow.setFillColor(tableShadowColor);
+    topWall.setSize(sf::Vector2f(spec.table_topBottomWall_width(), spec.wall_thickness));
+    topWall.setOrigin(sf::Vector2f(spec.table_topBottomWall_width() / 2, spec.wall_thickness / 2));
+    topWall.setFillColor(sf::Color(spec.tableWallColor));
+    topWall.setPosition(spec.table_topWall());
+    topWallShadow.setSize(sf::Vector2f(spec.table_topBottomWall_width(), spec.wall_thickness));
+    topWallShadow.setOrigin(sf::Vector2f(spec.table_topBottomWall_width() / 2, spec.wall_thickness / 2));
+    topWallShadow.setPosition(spec.table_topWall());
+    topWallShadow.setFillColor(sf::Color(spec.tableShadowColor));
 
     topLeftSecWall.setPointCount(4); 
-    topLeftSecWall.setPoint(0, sf::Vector2f(hole_topLeft.x + hole_radius, hole_topLeft.y)); 
-    topLeftSecWall.setPoint(1, sf::Vector2f(hole_topMid.x - hole_radius, hole_topLeft.y)); 
-    topLeftSecWall.setPoint(2, sf::Vector2f(hole_topMid.x - 1.5 * hole_radius, hole_topLeft.y + 0.5 * hole_radius));
-    topLeftSecWall.setPoint(3, sf::Vector2f(hole_topLeft.x + 1.5 * hole_radius, hole_topLeft.y + 0.5 * hole_radius));
-    topLeftSecWall.setFillColor(tableSecWallColor);
+    topLeftSecWall.setPoint(0, sf::Vector2f(hole_topLeft.x + spec.hole_radius, hole_topLeft.y)); 
+    topLeftSecWall.setPoint(1, sf::Vector2f(hole_topMid.x - spec.hole_radius, hole_topLeft.y)); 
+    topLeftSecWall.setPoint(2, sf::Vector2f(hole_topMid.x - 1.5 * spec.hole_radius, hole_topLeft.y + 0.5 * spec.hole_radius));
+    topLeftSecWall.setPoint(3, sf::Vector2f(hole_topLeft.x + 1.5 * spec.hole_radius, hole_topLeft.y + 0.5 * spec.hole_radius));
+    topLeftSecWall.setFillColor(sf::Color(spec.tableSecWallColor));
 
     topRightSecWall.setPointCount(4);
-    topRightSecWall.setPoint(0, sf::Vector2f(hole_topMid.x + hole_radius, hole_topLeft.y));
-    topRightSecWall.setPoint(1, sf::Vector2f(hole_topRight.x - hole_radius, hole_topLeft.y)); 
-    topRightSecWall.setPoint(3, sf::Vector2f(hole_topMid.x + 1.5 * hole_radius, hole_topLeft.y + 0.5 * hole_radius));
-    topRightSecWall.setPoint(2, sf::Vector2f(hole_topRight.x - 1.5 * hole_radius, hole_topLeft.y + 0.5 * hole_radius)); 
-    topRightSecWall.setFillColor(tableSecWallColor);
-
-    bottomWall.setSize(sf::Vector2f(table_topBottomWall_width, table_topBottomWall_height));
-    bottomWall.setOrigin(sf::Vector2f(table_topBottomWall_width / 2, table_topBottomWall_height / 2));
-    bottomWall.setFillColor(tableWallColor);    
-    bottomWall.setPosition(table_bottomWall);
-    bottomWallShadow.setSize(sf::Vector2f(table_topBottomWallShadow_width, table_topBottomWallShadow_height));
-    bottomWallShadow.setOrigin(sf::Vector2f(table_topBottomWallShadow_width / 2, table_topBottomWallShadow_height / 2));
-    bottomWallShadow.setPosition(table_bottomWallShadow);
-    bottomWallShadow.setFillColor(tableShadowColor);
+    topRightSecWall.setPoint(0, sf::Vector2f(hole_topMid.x + spec.hole_radius, hole_topLeft.y));
+    topRightSecWall.setPoint(1, sf::Vector2f(hole_topRight.x - spec.hole_radius, hole_topLeft.y)); 
+    topRightSecWall.setPoint(3, sf::Vector2f(hole_topMid.x + 1.5 * spec.hole_radius, hole_topLeft.y + 0.5 * spec.hole_radius));
+    topRightSecWall.setPoint(2, sf::Vector2f(hole_topRight.x - 1.5 * spec.hole_radius, hole_topLeft.y + 0.5 * spec.hole_radius)); 
+    topRightSecWall.setFillColor(sf::Color(spec.tableSecWallColor));
+
+    bottomWall.setSize(sf::Vector2f(spec.table_topBottomWall_width(), spec.wall_thickness));
+    bottomWall.setOrigin(sf::Vector2f(spec.table_topBottomWall_width() / 2, spec.wall_thickness / 2));
+    bottomWall.setFillColor(sf::Color(spec.tableWallColor));    
+    bottomWall.setPosition(spec.table_bottomWall());
+    bottomWallShadow.setSize(sf::Vector2f(spec.table_topBottomWall_width(), spec.wall_thickness));
+    bottomWallShadow.setOrigin(sf::Vector2f(spec.table_topBottomWall_width() / 2, spec.wall_thickness / 2));
+    bottomWallShadow.setPosition(spec.table_bottomWall());
+    bottomWallShadow.setFillColor(sf::Color(spec.tableShadowColor));
 
     bottomLeftSecWall.setPointCount(4); 
-    bottomLeftSecWall.setPoint(0, sf::Vector2f(hole_bottomLeft.x + hole_radius, hole_bottomLeft.y));
-    bottomLeftSecWall.setPoint(1, sf::Vector2f(hole_bottomMid.x - hole_radius, hole_bottomLeft.y));
-    bottomLeftSecWall.setPoint(2, sf::Vector2f(hole_bottomMid.x - 1.5 * hole_radius, hole_bottomLeft.y - 0.5 * hole_radius)); 
-    bottomLeftSecWall.setPoint(3, sf::Vector2f(hole_bottomLeft.x + 1.5 * hole_radius, hole_bottomLeft.y - 0.5 * hole_radius)); 
-    bottomLeftSecWall.setFillColor(tableSecWallColor);
+    bottomLeftSecWall.setPoint(0, sf::Vector2f(hole_bottomLeft.x + spec.hole_radius, hole_bottomLeft.y));
+    bottomLeftSecWall.setPoint(1, sf::Vector2f(hole_bottomMid.x - spec.hole_radius, hole_bottomLeft.y));
+    bottomLeftSecWall.setPoint(2, sf::Vector2f(hole_bottomMid.x - 1.5 * spec.hole_radius, hole_bottomLeft.y - 0.5 * spec.hole_radius)); 
+    bottomLeftSecWall.setPoint(3, sf::Vector2f(hole_bottomLeft.x + 1.5 * spec.hole_radius, hole_bottomLeft.y - 0.5 * spec.hole_radius)); 
+    bottomLeftSecWall.setFillColor(sf::Color(spec.tableSecWallColor));
 
     bottomRightSecWall.setPointCount(4);
-    bottomRightSecWall.setPoint(0, sf::Vector2f(hole_bottomMid.x + hole_radius, hole_bottomLeft.y)); 
-    bottomRightSecWall.setPoint(1, sf::Vector2f(hole_bottomRight.x - hole_radius, hole_bottomLeft.y)); 
-    bottomRightSecWall.setPoint(3, sf::Vector2f(hole_bottomMid.x + 1.5 * hole_radius, hole_bottomLeft.y - 0.5 * hole_radius));
-    bottomRightSecWall.setPoint(2, sf::Vector2f(hole_bottomRight.x - 1.5 * hole_radius, hole_bottomLeft.y - 0.5 * hole_radius));
-    bottomRightSecWall.setFillColor(tableSecWallColor);
-
-    leftWall.setSize(sf::Vector2f(table_leftRightWall_width, table_leftRightWall_height));
-    leftWall.setOrigin(sf::Vector2f(table_leftRightWall_width / 2, table_leftRightWall_height / 2));
-    leftWall.setFillColor(tableWallColor);
-    leftWall.setPosition(table_leftWall);
-    leftWallShadow.setSize(sf::Vector2f(table_leftRightWallShadow_width, table_leftRightWallShadow_height));
-    leftWallShadow.setOrigin(sf::Vector2f(table_leftRightWallShadow_width / 2, table_leftRightWallShadow_height / 2));
-    leftWallShadow.setPosition(table_leftWallShadow);
-    leftWallShadow.setFillColor(tableShadowColor);
+    bottomRightSecWall.setPoint(0, sf::Vector2f(hole_bottomMid.x + spec.hole_radius, hole_bottomLeft.y)); 
+    bottomRightSecWall.setPoint(1, sf::Vector2f(hole_bottomRight.x - spec.hole_radius, hole_bottomLeft.y)); 
+    bottomRightSecWall.setPoint(3, sf::Vector2f(hole_bottomMid.x + 1.5 * spec.hole_radius, hole_bottomLeft.y - 0.5 * spec.hole_radius));
+    bottomRightSecWall.setPoint(2, sf::Vector2f(hole_bottomRight.x - 1.5 * spec.hole_radius, hole_bottomLeft.y - 0.5 * spec.hole_radius));
+    bottomRightSecWall.setFillColor(sf::Color(spec.tableSecWallColor));
+
+    leftWall.setSize(sf::Vector2f(spec.wall_thickness, spec.table_height));
+    leftWall.setOrigin(sf::Vector2f(spec.wall_thickness / 2, spec.table_height / 2));
+    leftWall.setFillColor(sf::Color(spec.tableWallColor));
+    leftWall.setPosition(spec.table_leftWall());
+    leftWallShadow.setSize(sf::Vector2f(spec.wall_thickness, spec.table_height));
+    leftWallShadow.setOrigin(sf::Vector2f(spec.wall_thickness / 2, spec.table_height / 2));
+    leftWallShadow.setPosition(spec.table_leftWall());
+    leftWallShadow.setFillColor(sf::Color(spec.tableShadowColor));
 
     leftSecWall.setPointCount(4); 
-    leftSecWall.setPoint(0, sf::Vector2f(hole_topLeft.x, hole_topLeft.y + hole_radius)); 
-    leftSecWall.setPoint(1, sf::Vector2f(hole_bottomLeft.x, hole_bottomLeft.y - ball_radius));
-    leftSecWall.setPoint(2, sf::Vector2f(hole_bottomLeft.x + 0.5 * hole_radius, hole_bottomLeft.y - 1.5 * hole_radius)); 
-    leftSecWall.setPoint(3, sf::Vector2f(hole_topLeft.x + 0.5 * hole_radius, hole_topLeft.y + 1.5 * hole_radius));
-    leftSecWall.setFillColor(tableSecWallColor);
-
-    rightWall.setSize(sf::Vector2f(table_leftRightWall_width, table_leftRightWall_height));
-    rightWall.setOrigin(sf::Vector2f(table_leftRightWall_width / 2, table_leftRightWall_height / 2));
-    rightWall.setFillColor(tableWallColor);
-    rightWall.setPosition(table_rightWall);
-    rightWallShadow.setSize(sf::Vector2f(table_leftRightWallShadow_width, table_leftRightWallShadow_height));
-    rightWallShadow.setOrigin(sf::Vector2f(table_leftRightWallShadow_width / 2, table_leftRightWallShadow_height / 2));
-    rightWallShadow.setPosition(table_rightWallShadow);
-    rightWallShadow.setFillColor(tableShadowColor);
+    leftSecWall.setPoint(0, sf::Vector2f(hole_topLeft.x, hole_topLeft.y + spec.hole_radius)); 
+    leftSecWall.setPoint(1, sf::Vector2f(hole_bottomLeft.x, hole_bottomLeft.y - spec.ball_radius));
+    leftSecWall.setPoint(2, sf::Vector2f(hole_bottomLeft.x + 0.5 * spec.hole_radius, hole_bottomLeft.y - 1.5 * spec.hole_radius)); 
+    leftSecWall.setPoint(3, sf::Vector2f(hole_topLeft.x + 0.5 * spec.hole_radius, hole_topLeft.y + 1.5 * spec.hole_radius));
+    leftSecWall.setFillColor(sf::Color(spec.tableSecWallColor));
+
+    rightWall.setSize(sf::Vector2f(spec.wall_thickness, spec.table_height));
+    rightWall.setOrigin(sf::Vector2f(spec.wall_thickness / 2, spec.table_height / 2));
+    rightWall.setFillColor(sf::Color(spec.tableWallColor));
+    rightWall.setPosition(spec.table_rightWall());
+    rightWallShadow.setSize(sf::Vector2f(spec.wall_thickness, spec.table_height));
+    rightWallShadow.setOrigin(sf::Vector2f(spec.wall_thickness / 2, spec.table_height / 2));
+    rightWallShadow.setPosition(spec.table_rightWall());
+    rightWallShadow.setFillColor(sf::Color(spec.tableShadowColor));
 
     rightSecWall.setPointCount(4); 
-    rightSecWall.setPoint(0, sf::Vector2f(hole_topRight.x, hole_topRight.y + hole_radius)); 
-    rightSecWall.setPoint(1, sf::Vector2f(hole_bottomRight.x, hole_bottomRight.y - ball_radius));
-    rightSecWall.setPoint(2, sf::Vector2f(hole_bottomRight.x - 0.5 * hole_radius, hole_bottomRight.y - 1.5 * hole_radius)); 
-    rightSecWall.setPoint(3, sf::Vector2f(hole_topRight.x - 0.5 * hole_radius, hole_topRight.y + 1.5 * hole_radius));
-    rightSecWall.setFillColor(tableSecWallColor);
+    rightSecWall.setPoint(0, sf::Vector2f(hole_topRight.x, hole_topRight.y + spec.hole_radius)); 
+    rightSecWall.setPoint(1, sf::Vector2f(hole_bottomRight.x, hole_bottomRight.y - spec.ball_radius));
+    rightSecWall.setPoint(2, sf::Vector2f(hole_bottomRight.x - 0.5 * spec.hole_radius, hole_bottomRight.y - 1.5 * spec.hole_radius)); 
+    rightSecWall.setPoint(3, sf::Vector2f(hole_topRight.x - 0.5 * spec.hole_radius, hole_topRight.y + 1.5 * spec.hole_radius));
+    rightSecWall.setFillColor(sf::Color(spec.tableSecWallColor));
 
     // Wall Corner
-    topLeftCorner.setRadius(cornerRadius);
-    topLeftCorner.setOrigin(cornerRadius, cornerRadius);
-    topLeftCorner.setPosition(topLeftCornerPosition);
-    topLeftCorner.setFillColor(tableWallColor);
-
-    topRightCorner.setRadius(cornerRadius);
-    topRightCorner.setOrigin(cornerRadius, cornerRadius);
-    topRightCorner.setPosition(topRightCornerPosition);
-    topRightCorner.setFillColor(tableWallColor);
-
-    bottomLeftCorner.setRadius(cornerRadius);
-    bottomLeftCorner.setOrigin(cornerRadius, cornerRadius);
-    bottomLeftCorner.setPosition(bottomLeftCornerPosition);
-    bottomLeftCorner.setFillColor(tableWallColor);
-
-    bottomRightCorner.setRadius(cornerRadius);
-    bottomRightCorner.setOrigin(cornerRadius, cornerRadius);
-    bottomRightCorner.setPosition(bottomRightCornerPosition);
-    bottomRightCorner.setFillColor(tableWallColor);
-
+    topLeftCorner.setRadius(spec.cornerRadius);
+    topLeftCorner.setOrigin(spec.cornerRadius, spec.cornerRadius);
+    topLeftCorner.setPosition(spec.topLeftCornerPosition());
+    topLeftCorner.setFillColor(sf::Color(spec.tableWallColor));
+
+    topRightCorner.setRadius(spec.cornerRadius);
+    topRightCorner.setOrigin(spec.cornerRadius, spec.cornerRadius);
+    topRightCorner.setPosition(spec.topRightCornerPosition());
+    topRightCorner.setFillColor(sf::Color(spec.tableWallColor));
+
+    bottomLeftCorner.setRadius(spec.cornerRadius);
+    bottomLeftCorner.setOrigin(spec.cornerRadius, spec.cornerRadius);
+    bottomLeftCorner.setPosition(spec.bottomLeftCornerPosition());
+    bottomLeftCorner.setFillColor(sf::Color(spec.tableWallColor));
+
+    bottomRightCorner.setRadius(spec.cornerRadius);
+    bottomRightCorner.setOrigin(spec.cornerRadius, spec.cornerRadius);
+    bottomRightCorner.setPosition(spec.bottomRightCornerPosition());
+    bottomRightCorner.setFillColor(sf::Color(spec.tableWallColor));
+
+    // The cushions never move, their corners are transformed once for the kernels
+    for (const sf::ConvexShape* cushion : getCushions()) {
+        cushionPolygons.push_back(CushionPolygon<float>::fromShape(*cushion));
+    }
 }
 
 // Functions
 
-void Table::draw(sf::RenderWindow& window) {
-    window.draw(table);
+void Table::draw(sf::RenderTarget& target) {
+    target.draw(table);
     
-    window.draw(topWallShadow);
-    window.draw(bottomWallShadow);
-    window.draw(leftWallShadow);
-    window.draw(rightWallShadow);
-
-    window.draw(topWall);
-    window.draw(bottomWall);
-    window.draw(leftWall);
-    window.draw(rightWall);
-
-    window.draw(topLeftCorner);
-    window.draw(topRightCorner);
-    window.draw(bottomLeftCorner);
-    window.draw(bottomRightCorner);
-
-    window.draw(topLeftSecWall);
-    window.draw(topRightSecWall);
-    window.draw(bottomLeftSecWall);
-    window.draw(bottomRightSecWall);
-    window.draw(leftSecWall);
-    window.draw(rightSecWall);
+    target.draw(topWallShadow);
+    target.draw(bottomWallShadow);
+    target.draw(leftWallShadow);
+    target.draw(rightWallShadow);
+
+    target.draw(topWall);
+    target.draw(bottomWall);
+    target.draw(leftWall);
+    target.draw(rightWall);
+
+    target.draw(topLeftCorner);
+    target.draw(topRightCorner);
+    target.draw(bottomLeftCorner);
+    target.draw(bottomRightCorner);
+
+    target.draw(topLeftSecWall);
+    target.draw(topRightSecWall);
+    target.draw(bottomLeftSecWall);
+    target.draw(bottomRightSecWall);
+    target.draw(leftSecWall);
+    target.draw(rightSecWall);
 }
 
 // Getter Functions
@@ -530,6 +664,24 @@ sf::Vector2f Table::getDimension() {
     return table.getSize();
 }
 
+std::vector<const sf::ConvexShape*> Table::getCushions() const {
+    return { &topLeftSecWall, &topRightSecWall, &bottomLeftSecWall, &bottomRightSecWall, &leftSecWall, &rightSecWall };
+}
+
+const std::vector<CushionPolygon<float>>& Table::getCushionPolygons() const {
+    return cushionPolygons;
+}
+
+std::vector<const sf::Shape*> Table::getShapes() const {
+    return {
+        &table,
+        &topWallShadow, &bottomWallShadow, &leftWallShadow, &rightWallShadow,
+        &topWall, &bottomWall, &leftWall, &rightWall,
+        &topLeftCorner, &topRightCorner, &bottomLeftCorner, &bottomRightCorner,
+        &topLeftSecWall, &topRightSecWall, &bottomLeftSecWall, &bottomRightSecWall, &leftSecWall, &rightSecWall
+    };
+}
+
 /* 
 === Game Class Definition STARTS HERE === 
     
@@ -537,112 +689,143 @@ sf::Vector2f Table::getDimension() {
 
 */
 
+bool HudState::operator==(const HudState& other) const {
+    return scores[0] == other.scores[0] && scores[1] == other.scores[1] && turn == other.turn && winner == other.winner &&
+           over == other.over && ballInHand == other.ballInHand && showSpin == other.showSpin && spin == other.spin &&
+           rewindTicks == other.rewindTicks;
+}
+
+// "input 0.0, physics 0.0, ..." allocations per frame of every phase, into a caller buffer so nothing is allocated
+static void formatAllocationPhases(const AllocationCounts* counts, double frames, char* out, std::size_t size) {
+    std::size_t used = 0;
+    out[0] = '\0';
+    for (int phase = 0; phase < AllocationTracker::phaseCount && used < size; ++phase) {
+        int written = std::snprintf(out + used, size - used, "%s%s %.1f", phase > 0 ? ", " : "",
+                                    AllocationTracker::getPhaseName(static_cast<AllocationPhase>(phase)),
+                                    counts[phase].allocations / frames);
+        if (written < 0) break;
+        used += static_cast<std::size_t>(written);
+    }
+}
+
 // Private Functions
 void Game::initVariables() {
     this->window = nullptr;
-    this->playerTurn = 1; // Set playerTurn to Player 1 by default
-    this->playerScores[0] = 0; // Player 1 score
-    this->playerScores[1] = 0; // Player 2 score
-    this->isCueBallPocketed = false; // Initialize to prevent undefined behavior
-
-    std::cout << "variable initialized" << std::endl;
+    this->soundsAttached = false;
+    this->spectatorServer = nullptr;
+    this->matchRecorder = nullptr;
+    this->stateHistory = nullptr;
+    this->rewinding = false;
+    this->rewindTick = -1;
+    this->cueBall = nullptr;
+    this->ballCount = 0;
+    this->reportTimings = rackOptions.ballCount > spec.ballCount; // Stress racks report how the frame time scales
+    this->reportLatency = false;
+    this->dynamicResolution = nullptr;
+
+    FramePacerSettings pacing;
+    pacing.frameRate = spec.frLimit;
+    this->framePacer = FramePacer(pacing);
+    this->physicsMicroseconds = 0;
+    this->renderMicroseconds = 0;
+    this->timedFrames = 0;
+    this->eventEngine = nullptr;
+    this->analyticShotActive = false;
+    this->analyticShotTime = 0.0;
+    this->analyticShotEnd = 0.0;
+    this->analyticNextEvent = 0;
+    this->cueTipOffset = sf::Vector2f(0.f, 0.f);
+    this->shotPreview = nullptr;
+    this->simulation = new Simulation(spec);
+    this->showShotPreview = false;
+    this->showStats = false;
+    this->allocationFrames = 0;
+    this->allocatingFrames = 0;
+    this->statsFrame = 0;
+
+    BILLIARD_LOG(Debug, Setup) << "variable initialized";
 }
 
 void Game::initWindow() {
-    this->videoMode.width = window_width;
-    this->videoMode.height = window_height;
+    this->videoMode.width = spec.window_width;
+    this->videoMode.height = spec.window_height;
     this->window = new sf::RenderWindow(this->videoMode, "Billiard Simulation");
 
     if (this->window) {
-        std::cout << "Window created successfully with width: " << this->videoMode.width 
-                  << " and height: " << this->videoMode.height << std::endl;
+        BILLIARD_LOG(Info, Setup) << "Window created successfully with width: " << this->videoMode.width
+                                  << " and height: " << this->videoMode.height;
     } else {
-        std::cout << "Failed to create window." << std::endl;
+        BILLIARD_LOG(Error, Setup) << "Failed to create window.";
     }
 
-    this->window->setFramerateLimit(frLimit);
+    this->framePacer.apply(*this->window);
 }
 
 
 void Game::initBalls() {
-    std::cout << "Starting ball initialization..." << std::endl;
-    ballPositions = generateBallsPositions(ballCount, ball_radius, table_dimension, table_offset);
-
-    if (ballColors.size() < ballCount) {
-        std::cout << "Error: ballColors has fewer elements than expected." << std::endl;
-        return; // Exit to prevent invalid access
-    }
-    if (ballPositions.size() < ballCount) {
-        std::cout << "Error: ballPositions has fewer elements than expected." << std::endl;
-        return; // Exit to prevent invalid access
-    }
-
-    for (int i = 0; i < ballCount; ++i) {
-        std::cout << "Initializing ball " << i << std::endl;
-
-        Ball* newBall;
-        if (i == ballCount - 1) {  // Last ball is the cue ball
-            newBall = new Ball(ballPositions[i], ballColors[i]);
-            cueBall = newBall;
-
-            // Store the initial position for teleportation
-            initialCueBallPosition = ballPositions[i];
-
-            std::cout << "Cue ball initialized." << std::endl;
-        } else if (i == 7) {  // The 8th ball is the BlackBall
-            newBall = new BlackBall(ballPositions[i], sf::Color::Black);
-            std::cout << "BlackBall initialized." << std::endl;
-        } else if (i % 2 == 0) {  // Even-indexed balls as SolidBall
-            newBall = new SolidBall(ballPositions[i], ballColors[i]);
-            std::cout << "SolidBall initialized." << std::endl;
-        } else {  // Odd-indexed balls as StripedBall
-            newBall = new StripedBall(ballPositions[i], ballColors[i]);
-            std::cout << "StripedBall initialized." << std::endl;
-        }
+    BILLIARD_LOG(Debug, Setup) << "Starting ball initialization...";
+    std::vector<sf::Vector2f> ballPositions = generateRack(spec, rackOptions);
 
-        balls.push_back(newBall);
-        std::cout << "Ball " << i << " initialized at position ("
-                  << ballPositions[i].x << ", " << ballPositions[i].y << ")" << std::endl;
+    if (ballPositions.size() < static_cast<std::size_t>(rackOptions.ballCount)) {
+        BILLIARD_LOG(Warning, Setup) << "the " << getRackPatternName(rackOptions.pattern) << " rack only holds "
+                                     << ballPositions.size() << " of " << rackOptions.ballCount << " balls.";
+    }
+    ballCount = static_cast<int>(ballPositions.size());
+
+    simulation->rack(ballPositions);
+    match.reset(ballCount - 1); // Every ball but the cue ball
+    pocketedSolidBalls.clear();
+    pocketedStripedBalls.clear();
+    pocketedSolidBalls.reserve(ballCount);
+    pocketedStripedBalls.reserve(ballCount);
+
+    const bool logEachBall = ballCount <= 64 && Logger::isEnabled(LogLevel::Debug, LogCategory::Setup); // Sandbox racks only log a summary
+    for (int i = 0; i < ballCount && logEachBall; ++i) {
+        switch (simulation->getBallPool().get(i).type) {
+            case BallType::Cue: BILLIARD_LOG(Debug, Setup) << "Cue ball initialized."; break;
+            case BallType::Black: BILLIARD_LOG(Debug, Setup) << "BlackBall initialized."; break;
+            case BallType::Solid: BILLIARD_LOG(Debug, Setup) << "SolidBall initialized."; break;
+            case BallType::Striped: BILLIARD_LOG(Debug, Setup) << "StripedBall initialized."; break;
+        }
+        BILLIARD_LOG(Debug, Setup) << "Ball " << i << " initialized at position ("
+                                   << ballPositions[i].x << ", " << ballPositions[i].y << ")";
     }
 
-    std::cout << "Balls initialized." << std::endl;
+    // Taken after spawning, the pool never moves its slots once the rack is complete
+    cueBall = ballCount > 0 ? &simulation->getBallPool().get(simulation->getCueBallId()) : nullptr;
+
+    BILLIARD_LOG(Info, Setup) << ballCount << " balls initialized in a " << getRackPatternName(rackOptions.pattern) << " rack.";
 }
 
 
 
 
 void Game::initHoles() {
-    std::vector<sf::Vector2f> holesPosition = generateHolesPositions(holeCount, hole_radius, table_dimension, table_offset);
+    // The simulation owns the holes, only report them
+    const std::vector<Hole*>& holes = simulation->getHoles();
 
-    if (holesPosition.size() < holeCount) {
-        std::cout << "Error: ballColors has fewer elements than expected." << std::endl;
-        return; // Exit to prevent invalid access
+    if (holes.size() < spec.holeCount) {
+        BILLIARD_LOG(Error, Setup) << "ballColors has fewer elements than expected.";
+        return;
     }
 
-    for (int i = 0; i < holesPosition.size(); i++){
-        std::cout << "Initializing hole " << i << std::endl;
-        Hole* newHole = new Hole(holesPosition[i]);
-        holes.push_back(newHole);
-        std::cout << "Hole " << i << " initialized at position (" << holesPosition[i].x << ", " << holesPosition[i].y << ")" << std::endl;
+    for (size_t i = 0; i < holes.size(); i++) {
+        BILLIARD_LOG(Debug, Setup) << "Hole " << i << " initialized at position (" << holes[i]->getPosition().x << ", " << holes[i]->getPosition().y << ")";
     }
 }
 
 void Game::initSoundEffects() {
-    if (!collisionSoundBuffer.loadFromFile("./sound/ball_collide.wav")) {
-        std::cerr << "Failed to load collision sound!" << std::endl;
-    } 
-    collisionSound.setBuffer(collisionSoundBuffer);
+    // The shared buffers may still be decoding, update() tries again until they are ready
+    const GameAssets& assets = GameAssets::shared();
+    if (!assets.isAudioReady()) return;
 
-    if (!cueStickHitBuffer.loadFromFile("./sound/pool_ball_hit.wav")) {
-        std::cerr << "Failed to load cue stick hit sound!" << std::endl;
-    }
-    cueStickHitSound.setBuffer(cueStickHitBuffer);
+    collisionSound.setBuffer(assets.getCollisionSound());
+    cueStickHitSound.setBuffer(assets.getCueHitSound());
+    soundsAttached = true;
 }
 
 void Game::initFontText() {
-    if (!font.loadFromFile("Arial.ttf")) {
-        std::cerr << "Failed to load font!" << std::endl;
-    }
+    const sf::Font& font = GameAssets::shared().getFont();
 
     scoreText.setFont(font);
     scoreText.setCharacterSize(30);
@@ -651,85 +834,215 @@ void Game::initFontText() {
     turnText.setFont(font);
     turnText.setCharacterSize(30);
     turnText.setFillColor(sf::Color::White);
+
+    statsText.setFont(font);
+    statsText.setCharacterSize(20);
+    statsText.setFillColor(sf::Color::White);
+    statsText.setPosition(10.f, spec.window_height - 30.f);
 }
 
 void Game::resetBalls() {
-    // Delete existing balls
-    for (Ball* ball : balls) {
-        delete ball;
-    }
-    balls.clear();
-
-    // Reinitialize balls as needed
+    // The pool restyles its existing slots, nothing is freed or allocated here
     this->initBalls();
 }
 
 void Game::updateUI() {
+    HudState hud;
+    hud.scores[0] = match.getScore(1);
+    hud.scores[1] = match.getScore(2);
+    hud.turn = match.getPlayerTurn();
+    hud.winner = match.getWinner();
+    hud.over = match.isOver();
+    hud.ballInHand = match.hasBallInHand();
+    hud.showSpin = this->eventEngine && !match.isOver();
+    if (hud.showSpin) {
+        // Tip offset in tenths of a ball radius, changed with the arrow keys
+        hud.spin = sf::Vector2i(static_cast<int>(std::round(cueTipOffset.x * 10)), static_cast<int>(std::round(cueTipOffset.y * 10)));
+    }
+    if (rewinding) {
+        hud.rewindTicks = static_cast<int>(stateHistory->getLastTick() - rewindTick);
+    }
+
+    // The strings and the text geometry are only rebuilt when something changed, a steady frame allocates nothing
+    if (hud == shownHud) return;
+    shownHud = hud;
+
     // Update teks skor
-    scoreText.setString(
-        "Player 1: " + std::to_string(playerScores[0]) + 
-        "  Player 2: " + std::to_string(playerScores[1])
-    );
+    char line[128];
+    std::snprintf(line, sizeof(line), "Player 1: %d  Player 2: %d", hud.scores[0], hud.scores[1]);
+    scoreText.setString(line);
     scoreText.setCharacterSize(40);  // Ukuran font yang lebih besar
     scoreText.setFillColor(sf::Color::White);  // Warna putih
-    scoreText.setPosition(window_width / 2 - scoreText.getLocalBounds().width / 2, 10.f);  // Tengah horizontal
+    scoreText.setPosition(spec.window_width / 2 - scoreText.getLocalBounds().width / 2, 10.f);  // Tengah horizontal
 
     // Update teks giliran pemain
-    turnText.setString("Turn: Player " + std::to_string(playerTurn));
+    int length;
+    if (hud.rewindTicks >= 0) {
+        length = std::snprintf(line, sizeof(line), "Rewind -%.2f s  Left/Right scrub, Enter plays from here, Backspace returns",
+                               hud.rewindTicks / static_cast<float>(spec.frLimit));
+    } else if (hud.over) {
+        length = hud.winner > 0 ? std::snprintf(line, sizeof(line), "Player %d wins!  Press R for a new rack", hud.winner)
+                                : std::snprintf(line, sizeof(line), "Draw!  Press R for a new rack");
+    } else {
+        length = std::snprintf(line, sizeof(line), "Turn: Player %d%s", hud.turn, hud.ballInHand ? "  Ball in hand" : "");
+    }
+    if (hud.showSpin && length > 0 && length < static_cast<int>(sizeof(line))) {
+        std::snprintf(line + length, sizeof(line) - length, "  Spin: %d, %d", hud.spin.x, hud.spin.y);
+    }
+    turnText.setString(line);
     turnText.setCharacterSize(40);  // Ukuran font yang lebih besar
     turnText.setFillColor(sf::Color::White);  // Warna putih
-    turnText.setPosition(window_width / 2 - turnText.getLocalBounds().width / 2, 50.f);  // Tengah horizontal
+    turnText.setPosition(spec.window_width / 2 - turnText.getLocalBounds().width / 2, 50.f);  // Tengah horizontal
 }
 
 bool Game::areBallsMoving() const {
-    for (const Ball* ball : balls) {
-        if (std::abs(ball->getVelocity().x) > minVelocityThreshold ||
-            std::abs(ball->getVelocity().y) > minVelocityThreshold) {
-            return true; // A ball is still in motion
-        }
-    }
-    return false; // All balls have stopped
+    // An analytic shot moves the balls outside the simulation until it has played out
+    return analyticShotActive || simulation->isMoving();
 }
 
 // Constructor 
-Game::Game() {
-    std::cout << "Starting game construction..." << std::endl;
+Game::Game(const TableSpec& spec, const RackOptions& rackOptions)
+    : spec(spec), cueStick(spec), rackOptions(rackOptions) {
+    BILLIARD_LOG(Debug, Setup) << "Starting game construction...";
 
     this->initVariables();
-    std::cout << "Variables initialized." << std::endl;
+    BILLIARD_LOG(Debug, Setup) << "Variables initialized.";
 
     this->initWindow();
-    std::cout << "Window initialized." << std::endl;
+    BILLIARD_LOG(Debug, Setup) << "Window initialized.";
 
     this->initBalls();
-    std::cout << "Balls initialized." << std::endl;
+    BILLIARD_LOG(Debug, Setup) << "Balls initialized.";
 
     this->initHoles();
-    std::cout << "Holes initialized." << std::endl;
+    BILLIARD_LOG(Debug, Setup) << "Holes initialized.";
 
     this->initFontText();
-    std::cout << "Font Text UI initialized." << std::endl;
+    BILLIARD_LOG(Debug, Setup) << "Font Text UI initialized.";
 
     this->initSoundEffects();
-    std::cout << "Sound effects initialized." << std::endl;
+    BILLIARD_LOG(Debug, Setup) << "Sound effects initialized.";
 
-    std::cout << "Game created successfully." << std::endl;
+    this->shotPreview = new ShotPreview(spec, simulation->getTable(), simulation->getHolePositions());
+    BILLIARD_LOG(Debug, Setup) << "Shot preview initialized.";
+
+    BILLIARD_LOG(Info, Setup) << "Game created successfully.";
 }
 
 // Destructor
 Game::~Game() {
+    FrameTimeStats frames = this->framePacer.getStats();
+    if (frames.frames > 0) {
+        BILLIARD_LOG(Info, Timing) << "frame times (" << FramePacer::getModeName(framePacer.getSettings().mode) << "): p50 " << frames.p50
+                                   << " ms, p99 " << frames.p99 << " ms, max " << frames.max << " ms, "
+                                   << frames.missed << " of " << frames.frames << " frames missed the deadline";
+    }
+    if (allocationFrames > 0 && AllocationTracker::isActive()) {
+        AllocationCounts total = this->getAllocationTotal();
+        char phases[160];
+        formatAllocationPhases(allocationTotals, static_cast<double>(allocationFrames), phases, sizeof(phases));
+        BILLIARD_LOG(Info, Timing) << "heap: " << allocatingFrames << " of " << allocationFrames << " frames allocated, "
+                                   << total.allocations << " allocations (" << total.bytes << " bytes), per frame " << phases;
+    }
+
+    delete this->shotPreview;
+    delete this->eventEngine;
+    delete this->spectatorServer;
+    delete this->matchRecorder;
+    delete this->stateHistory;
+    delete this->dynamicResolution;
     delete this->window;
-    for(auto& ball : balls) {
-        delete ball;
-        ball = nullptr; // Extra safe step for memory leaks case
+    delete this->simulation;
+}
+
+bool Game::enableSpectatorServer(unsigned short port, float broadcastRate, int keyframeInterval, int quantThreshold) {
+    delete this->spectatorServer;
+    this->spectatorServer = new SpectatorServer(spec, port, broadcastRate, keyframeInterval, quantThreshold);
+
+    if (!this->spectatorServer->start()) {
+        delete this->spectatorServer;
+        this->spectatorServer = nullptr;
+        return false;
     }
-    for(auto& hole : holes) {
-        delete hole;
-        hole = nullptr;
+    return true;
+}
+
+bool Game::enableMatchRecorder(const std::string& path, int keyframeInterval) {
+    delete this->matchRecorder;
+    this->matchRecorder = new MatchRecorder(spec, keyframeInterval);
+
+    if (!this->matchRecorder->open(path)) {
+        delete this->matchRecorder;
+        this->matchRecorder = nullptr;
+        return false;
     }
+    return true;
+}
+
+void Game::setContactSolverSettings(const ContactSolverSettings& settings) {
+    simulation->getContactSolver().setSettings(settings);
+}
+
+void Game::setPhysics(const PhysicsParameters& physics) {
+    simulation->setPhysics(physics);
+}
+
+void Game::enableRewind(const StateHistorySettings& settings) {
+    if (this->eventEngine) {
+        BILLIARD_LOG(Warning, Setup) << "Rewind needs the fixed-step engine, the analytic engine moves balls outside the physics step.";
+        return;
+    }
+    delete this->stateHistory;
+    this->stateHistory = new StateHistory(settings);
+    BILLIARD_LOG(Info, Setup) << "Rewind history of " << settings.memoryBytes / 1024 << " KB, Backspace to scrub it.";
+}
+
+void Game::enableLatencyReport() {
+    this->reportLatency = true;
+    this->inputLatency.reset();
+    this->latencyReportClock.restart();
+}
+
+void Game::setFramePacing(const FramePacerSettings& settings) {
+    this->framePacer = FramePacer(settings);
+    this->framePacer.apply(*this->window);
+}
+
+void Game::enableDynamicResolution(const DynamicResolutionSettings& settings) {
+    delete this->dynamicResolution;
+    this->dynamicResolution = new DynamicResolution(this->window->getSize(), settings);
+    BILLIARD_LOG(Info, Render) << "Dynamic resolution between " << this->dynamicResolution->getSettings().minScale * 100 << "% and "
+                               << this->dynamicResolution->getSettings().maxScale * 100 << "% of the window.";
+}
+
+void Game::enableAnalyticEngine() {
+    if (this->eventEngine) return;
+
+    this->eventEngine = new EventEngine(spec, simulation->getTable(), simulation->getHolePositions());
+    BILLIARD_LOG(Info, Setup) << "Analytic engine enabled, arrow keys move the cue tip.";
 }
 
 // Getter Functions
+const std::vector<PocketEvent>& Game::getPocketEvents() const {
+    return simulation->getPocketEvents();
+}
+
+const Match& Game::getMatch() const {
+    return match;
+}
+
+const InputLatencyMeter& Game::getInputLatency() const {
+    return inputLatency;
+}
+
+FrameTimeStats Game::getFrameTimeStats() const {
+    return framePacer.getStats();
+}
+
+float Game::getRenderScale() const {
+    return this->dynamicResolution ? this->dynamicResolution->getScale() : 1.0f;
+}
+
 const bool Game::running() const {
     bool isRunning = this->window && this->window->isOpen();
     // std::cout << "Game running: " << std::boolalpha << isRunning << std::endl;
@@ -745,17 +1058,25 @@ void Game::pollEvents() {
                 this->window->close();
                 break;
 
+            case sf::Event::MouseMoved:
+                // The pose itself is latched in render(), the event only starts the latency clock
+                if (cueStick.isDrag() && !isCueBallDraggable) {
+                    inputLatency.markInput(inputLatency.now());
+                }
+                break;
+
             case sf::Event::MouseButtonPressed:
-                if (ev.mouseButton.button == sf::Mouse::Left) {
-                    sf::Vector2f mousePosition = static_cast<sf::Vector2f>(sf::Mouse::getPosition(*this->window));
+                if (ev.mouseButton.button == sf::Mouse::Left && !rewinding) {
+                    // Where the button went down, not where the cursor is by the time the queue is read
+                    sf::Vector2f mousePosition(static_cast<float>(ev.mouseButton.x), static_cast<float>(ev.mouseButton.y));
                     float dx = mousePosition.x - cueBall->getPosition().x;
                     float dy = mousePosition.y - cueBall->getPosition().y;
                     float distanceSquared = dx * dx + dy * dy;
 
-                    if (distanceSquared <= ball_radius * ball_radius) {
+                    if (distanceSquared <= spec.ball_radius * spec.ball_radius) {
                         // Mouse clicked inside the cue ball
                         if (isCueBallDraggable) {
-                            std::cout << "Dragging the cue ball..." << std::endl;
+                            BILLIARD_LOG(Info, Gameplay) << "Dragging the cue ball...";
                         }
                     } else {
                         // Mouse clicked outside the cue ball
@@ -763,7 +1084,7 @@ void Game::pollEvents() {
                             isCueBallDraggable = false; // Disable dragging
                         }
 
-                        if (!areBallsMoving()) {
+                        if (!areBallsMoving() && !match.isOver()) {
                             // Start dragging the cue stick
                             cueStick.startDragging(cueBall->getPosition());
                         }
@@ -772,18 +1093,78 @@ void Game::pollEvents() {
                 break;
 
             case sf::Event::MouseButtonReleased:
-                if (ev.mouseButton.button == sf::Mouse::Left) {
+                if (ev.mouseButton.button == sf::Mouse::Left && !rewinding) {
                     if (!isCueBallDraggable) {
-                        // Apply force to the cue ball when the cue stick is released
+                        // Aim from the release event itself, the cursor may have moved on since
+                        bool wasDragging = cueStick.isDrag();
+                        if (wasDragging) {
+                            cueStick.update(sf::Vector2f(static_cast<float>(ev.mouseButton.x), static_cast<float>(ev.mouseButton.y)));
+                            inputLatency.markInput(inputLatency.now()); // Until the struck ball is drawn
+                        }
+
+                        // Apply force to the cue ball when the cue stick is released, a click without a drag is no shot
                         sf::Vector2f direction = cueStick.getDirection(cueBall->getPosition());
                         float power = cueStick.getPower();
-                        cueBall->applyForce(direction * power);
+                        bool isShot = false;
+                        if (wasDragging && power > 0.0f) {
+                            if (this->eventEngine) {
+                                if (!analyticShotActive && match.beginShot()) {
+                                    this->startAnalyticShot(direction * power * static_cast<float>(spec.frLimit)); // px/frame to px/s
+                                    isShot = true;
+                                }
+                            } else if (match.beginShot()) {
+                                simulation->strike(direction * power);
+                                isShot = true;
+                            }
+                        }
                         cueStick.stopDragging();
-                        
-                        float volume = std::min(100.0f, power); // Cap volume at 100
-                        cueStickHitSound.setVolume(volume);
-                        cueStickHitSound.play();
+                        this->clearShotPreview();
+
+                        if (isShot) {
+                            float volume = std::min(100.0f, power); // Cap volume at 100
+                            cueStickHitSound.setVolume(volume);
+                            cueStickHitSound.play();
+                        }
+                    }
+                }
+                break;
+
+            case sf::Event::KeyPressed:
+                if (ev.key.code == sf::Keyboard::R && match.isOver() && !areBallsMoving() && !rewinding) {
+                    this->resetBalls();
+                    isCueBallDraggable = false;
+                }
+                if (ev.key.code == sf::Keyboard::F3) {
+                    // The overlay measures from the moment it is shown
+                    showStats = !showStats;
+                    statsText.setString("Measuring...");
+                    std::copy(allocationTotals, allocationTotals + AllocationTracker::phaseCount, statsAllocations);
+                    statsFrame = allocationFrames;
+                    statsClock.restart();
+                }
+                if (ev.key.code == sf::Keyboard::Backspace && this->stateHistory) {
+                    if (rewinding) {
+                        this->stopRewind(false);
+                    } else {
+                        this->startRewind();
                     }
+                } else if (rewinding) {
+                    // Shift scrubs a second of motion at a time
+                    const long long stride = ev.key.shift ? spec.frLimit : 1;
+                    if (ev.key.code == sf::Keyboard::Left) this->scrubRewind(-stride);
+                    if (ev.key.code == sf::Keyboard::Right) this->scrubRewind(stride);
+                    if (ev.key.code == sf::Keyboard::Enter) this->stopRewind(true);
+                }
+                if (this->eventEngine) {
+                    const float tipStep = 0.1f;
+                    if (ev.key.code == sf::Keyboard::Up) cueTipOffset.y += tipStep;
+                    if (ev.key.code == sf::Keyboard::Down) cueTipOffset.y -= tipStep;
+                    if (ev.key.code == sf::Keyboard::Right) cueTipOffset.x += tipStep;
+                    if (ev.key.code == sf::Keyboard::Left) cueTipOffset.x -= tipStep;
+
+                    // Beyond half a radius the tip would miscue
+                    float offset = std::sqrt(cueTipOffset.x * cueTipOffset.x + cueTipOffset.y * cueTipOffset.y);
+                    if (offset > 0.5f) cueTipOffset *= 0.5f / offset;
                 }
                 break;
 
@@ -795,15 +1176,210 @@ void Game::pollEvents() {
 
 
 
+void Game::updatePhysics() {
+    simulation->setGhostBall(isDraggingCueBall && cueBall ? cueBall->id : -1);
+    {
+        AllocationCheck check("physics step"); // Only logs with --alloc-check
+        simulation->step();
+    }
+
+    // Add collision sound effect, once per step for the hardest contact
+    float collisionIntensity = simulation->getCollisionIntensity();
+    if (collisionIntensity > 0.0f) {
+        collisionSound.setVolume(std::min(100.0f, collisionIntensity)); // Volume based on intensity (0 - 100)
+        collisionSound.play();
+    }
+
+    for (const PocketEvent& event : simulation->getPocketEvents()) {
+        this->pocketBall(simulation->getBallPool().get(event.ballId));
+    }
+}
+
+void Game::startRewind() {
+    if (stateHistory->isEmpty() || analyticShotActive) return;
+
+    rewinding = true;
+    rewindTick = stateHistory->getLastTick();
+    isDraggingCueBall = false;
+    cueStick.stopDragging();
+    this->clearShotPreview();
+}
+
+void Game::scrubRewind(long long ticks) {
+    long long tick = std::max(stateHistory->getFirstTick(), std::min(stateHistory->getLastTick(), rewindTick + ticks));
+    if (tick == rewindTick) return;
+    rewindTick = tick;
+    this->showRewindTick();
+}
+
+void Game::stopRewind(bool resumeHere) {
+    if (!resumeHere) {
+        rewindTick = stateHistory->getLastTick();
+        this->showRewindTick();
+    }
+    stateHistory->resume();
+    rewinding = false;
+    BILLIARD_LOG(Info, Gameplay) << (resumeHere ? "Playing on from the rewound table." : "Back to the newest table.");
+}
+
+void Game::showRewindTick() {
+    if (!stateHistory->seek(rewindTick, *simulation, match)) return;
+
+    // Everything the game derives from the balls and the match follows the restored state
+    BallPool& ballPool = simulation->getBallPool();
+    cueBall = &ballPool.get(simulation->getCueBallId());
+    ballCount = static_cast<int>(ballPool.size());
+    pocketedSolidBalls.clear();
+    pocketedStripedBalls.clear();
+    for (int id = 0; id < ballCount; ++id) {
+        const Ball& ball = ballPool.get(id);
+        if (!ball.pocketed) continue;
+        if (ball.type == BallType::Solid) pocketedSolidBalls.push_back(id);
+        if (ball.type == BallType::Striped) pocketedStripedBalls.push_back(id);
+    }
+    isCueBallDraggable = match.hasBallInHand() && match.getPhase() == MatchPhase::AwaitingShot;
+}
+
+void Game::pocketBall(Ball& ball) {
+    if (&ball == cueBall) {
+        match.cueBallPocketed(); // Ball in hand for the next player once the shot is over
+        BILLIARD_LOG(Info, Gameplay) << "Cue ball fell into the hole! Teleporting to initial position.";
+    } else {
+        match.objectBallPocketed(); // A point for the active player
+        if (ball.type == BallType::Solid) {
+            pocketedSolidBalls.push_back(ball.id);
+        } else if (ball.type == BallType::Striped) {
+            pocketedStripedBalls.push_back(ball.id);
+        }
+    }
+}
+
+void Game::startAnalyticShot(sf::Vector2f velocity) {
+    BallPool& ballPool = simulation->getBallPool();
+
+    // The whole shot is solved up front, update() then only samples it
+    eventEngine->clear();
+    analyticBallIds.clear();
+    int cueIndex = -1;
+    for (int id : ballPool.getOnTable()) {
+        if (&ballPool.get(id) == cueBall) cueIndex = static_cast<int>(analyticBallIds.size());
+        eventEngine->addBall(ballPool.get(id).getPosition());
+        analyticBallIds.push_back(id);
+    }
+    if (cueIndex < 0) return;
+
+    eventEngine->strike(cueIndex, velocity, cueTipOffset);
+    analyticShotEnd = eventEngine->simulate();
+    analyticShotTime = 0.0;
+    analyticNextEvent = 0;
+    analyticShotActive = true;
+
+    BILLIARD_LOG(Info, Physics) << "Shot solved with " << eventEngine->getEvents().size() << " events, "
+                                << analyticShotEnd << " s of motion.";
+}
+
+void Game::updateAnalyticShot() {
+    BallPool& ballPool = simulation->getBallPool();
+    analyticShotTime += 1.0 / spec.frLimit;
+
+    // Events that happened during this frame, in order
+    const std::vector<EngineEvent>& events = eventEngine->getEvents();
+    for (; analyticNextEvent < events.size() && events[analyticNextEvent].time <= analyticShotTime; ++analyticNextEvent) {
+        const EngineEvent& event = events[analyticNextEvent];
+        Ball& ball = ballPool.get(analyticBallIds[event.ball]);
+
+        if (event.type == EngineEventType::Pocket) {
+            simulation->pocket(ball.id);
+            this->pocketBall(ball);
+        } else if (event.type == EngineEventType::BallBall) {
+            collisionSound.setVolume(100.0f);
+            collisionSound.play();
+        }
+    }
+
+    for (std::size_t i = 0; i < analyticBallIds.size(); ++i) {
+        Ball& ball = ballPool.get(analyticBallIds[i]);
+        if (ball.pocketed || eventEngine->isPocketedAt(static_cast<int>(i), analyticShotTime)) continue;
+
+        ball.setPosition(eventEngine->samplePosition(static_cast<int>(i), analyticShotTime));
+        ballPool.rebin(ball.id);
+    }
+
+    if (analyticShotTime >= analyticShotEnd) {
+        analyticShotActive = false;
+    }
+}
+
+void Game::updateShotPreview() {
+    if (areBallsMoving()) return;
+
+    // Same launch velocity as the release in pollEvents, in px/s
+    sf::Vector2f velocity = cueStick.getDirection(cueBall->getPosition()) * cueStick.getPower() * static_cast<float>(spec.frLimit);
+    if (velocity != previewVelocity || cueTipOffset != previewTipOffset) {
+        previewVelocity = velocity;
+        previewTipOffset = cueTipOffset;
+
+        if (velocity == sf::Vector2f(0.f, 0.f)) {
+            this->clearShotPreview();
+        } else {
+            const BallPool& ballPool = simulation->getBallPool();
+            ShotPreviewRequest& request = previewRequest;
+            request.positions.clear();
+            request.cueIndex = -1;
+            for (int id : ballPool.getOnTable()) {
+                if (&ballPool.get(id) == cueBall) request.cueIndex = static_cast<int>(request.positions.size());
+                request.positions.push_back(ballPool.get(id).getPosition());
+            }
+            request.velocity = velocity;
+            request.tipOffset = cueTipOffset;
+            shotPreview->request(request);
+        }
+    }
+
+    // Whatever finished since the last frame, a solve still running keeps the previous guide on screen
+    ShotPreviewResult& result = previewResult;
+    if (!shotPreview->poll(result)) return;
+
+    const sf::Color cueColor(255, 255, 255, 160);
+    const sf::Color objectColor(255, 220, 0, 160);
+    previewLines.setPrimitiveType(sf::Lines);
+    previewLines.clear();
+    for (std::size_t k = 1; k < result.cuePath.size(); ++k) {
+        previewLines.append(sf::Vertex(result.cuePath[k - 1], cueColor));
+        previewLines.append(sf::Vertex(result.cuePath[k], cueColor));
+    }
+    for (std::size_t k = 1; k < result.objectPath.size(); ++k) {
+        previewLines.append(sf::Vertex(result.objectPath[k - 1], objectColor));
+        previewLines.append(sf::Vertex(result.objectPath[k], objectColor));
+    }
+
+    previewGhost.setRadius(spec.ball_radius);
+    previewGhost.setOrigin(spec.ball_radius, spec.ball_radius);
+    previewGhost.setFillColor(sf::Color::Transparent);
+    previewGhost.setOutlineColor(result.objectIndex >= 0 ? cueColor : sf::Color::Transparent);
+    previewGhost.setOutlineThickness(1.0f);
+    previewGhost.setPosition(result.contactPosition);
+    showShotPreview = true;
+}
+
+void Game::clearShotPreview() {
+    shotPreview->cancel();
+    showShotPreview = false;
+    previewVelocity = sf::Vector2f(0.f, 0.f);
+    previewLines.clear();
+}
+
 void Game::update() {
+    frameAllocations.begin();
+    AllocationScope inputScope(AllocationPhase::Input);
     this->pollEvents();
-    
-    bool ballPocketed = false;      // Indikator apakah ada bola masuk ke lubang
-    bool cueBallPocketed = false;  // Indikator apakah bola putih masuk ke lubang
-    static bool playerScored = false;     // Indikator apakah pemain mendapatkan poin
-    static bool allBallsStopped = true;  // Status bola berhenti, default true untuk awal permainan
 
-    if (isCueBallDraggable) {
+    if (!soundsAttached) {
+        this->initSoundEffects();
+    }
+
+    if (isCueBallDraggable && !rewinding) {
+        BallPool& ballPool = simulation->getBallPool();
         isDraggingCueBall = true;
         sf::Vector2f mousePosition = static_cast<sf::Vector2f>(sf::Mouse::getPosition(*this->window));
 
@@ -811,22 +1387,22 @@ void Game::update() {
             // Calculate the desired position of the cue ball
             sf::Vector2f desiredPosition = mousePosition;
 
-            // Check collisions with other balls
+            // Check collisions with the neighbouring balls
             bool canMove = true;
-            for (Ball* ball : balls) {
-                if (ball != cueBall) {
-                    float distance = std::sqrt(std::pow(ball->getPosition().x - desiredPosition.x, 2) +
-                                            std::pow(ball->getPosition().y - desiredPosition.y, 2));
-                    if (distance <= ball_radius * 2) {
+            ballPool.getGrid().forEachNear(desiredPosition, spec.ball_radius * 2, [&](int id) {
+                const Ball& ball = ballPool.get(id);
+                if (&ball != cueBall) {
+                    float distance = std::sqrt(std::pow(ball.getPosition().x - desiredPosition.x, 2) +
+                                            std::pow(ball.getPosition().y - desiredPosition.y, 2));
+                    if (distance <= spec.ball_radius * 2) {
                         canMove = false;
-                        break; // Stop checking further if a collision is found
                     }
                 }
-            }
+            });
 
             // Move the cue ball only if there are no collisions
             if (canMove) {
-                cueBall->setPosition(desiredPosition);
+                ballPool.place(cueBall->id, desiredPosition);
             }
         } else {
             isDraggingCueBall = false; // Reset dragging state when the button is released
@@ -837,121 +1413,227 @@ void Game::update() {
     if (cueStick.isDrag() && !isCueBallDraggable) {
         sf::Vector2f mousePosition = static_cast<sf::Vector2f>(sf::Mouse::getPosition(*this->window));
         cueStick.update(mousePosition);
+        this->updateShotPreview();
     }
 
-    for (Ball* ball : balls) {
-        ball->update(table); // Pass the Table object
+    AllocationTracker::setPhase(AllocationPhase::Physics);
+    sf::Clock physicsClock;
+    if (rewinding) {
+        // The table holds still on the tick being shown
+    } else if (analyticShotActive) {
+        this->updateAnalyticShot();
+    } else {
+        this->updatePhysics();
     }
-
-
-    for (size_t i = 0; i < balls.size(); ++i) {
-        for (size_t j = i + 1; j < balls.size(); ++j) {
-            // Skip collisions for the cue ball while dragging
-            if (isDraggingCueBall && (balls[i] == cueBall || balls[j] == cueBall)) {
-                continue;
-            }
-
-            if (balls[i]->checkCollision(*balls[j])) {
-                balls[i]->resolveCollision(*balls[j]);
-                // Add collision sound effect
-                float collisionIntensity = std::min(
-                    100.0f, 
-                    static_cast<float>(std::sqrt(std::pow(balls[i]->getVelocity().x, 2) + std::pow(balls[i]->getVelocity().y, 2)) +
-                    std::sqrt(std::pow(balls[j]->getVelocity().x, 2) + std::pow(balls[j]->getVelocity().y, 2)))
-                );
-                collisionSound.setVolume(collisionIntensity); // Volume based on intensity (0 - 100)
-                collisionSound.play();
-            }
+    physicsMicroseconds += physicsClock.getElapsedTime().asMicroseconds();
+
+    // The rules only look at a shot once every ball rests
+    if (!rewinding && match.getPhase() == MatchPhase::ShotInProgress && !areBallsMoving()) {
+        ShotOutcome outcome = match.endShot();
+        isCueBallDraggable = match.hasBallInHand();
+        if (outcome.foul) {
+            BILLIARD_LOG(Info, Gameplay) << "Foul by player " << outcome.shooter << ", ball in hand for player " << match.getPlayerTurn() << ".";
         }
-    }
-
-    for (Hole* hole : holes) {
-        for (auto it = balls.begin(); it != balls.end();) {
-            if (hole->isBallInHole((*it)->getPosition(), ball_radius)) {
-                if (*it == cueBall) {
-                    cueBallPocketed = true;
-                    std::cout << "Cue ball fell into the hole! Teleporting to initial position." << std::endl;
-                    cueBall->setVelocity({0, 0});
-                    cueBall->setPosition(initialCueBallPosition);
-                    isCueBallDraggable = true;
-                    ++it;
-                } else {
-                    playerScores[playerTurn - 1] += 1;  // Tambahkan skor ke pemain aktif
-                    playerScored = true;  // Tandai bahwa pemain mendapat poin
-                    Ball* ball = *it;
-                    if (dynamic_cast<SolidBall*>(ball)) {
-                        pocketedSolidBalls.push_back(ball);
-                    } else if (dynamic_cast<StripedBall*>(ball)) {
-                        pocketedStripedBalls.push_back(ball);
-                    }
-                    it = balls.erase(it);
-                }
-            } else {
-                ++it;
-            }
+        if (match.isOver()) {
+            BILLIARD_LOG(Info, Gameplay) << "Match over after " << match.getShotCount() << " shots, " << match.getScore(1)
+                                         << " to " << match.getScore(2) << ".";
         }
     }
-
-    // Periksa apakah semua bola sudah berhenti
-    bool currentBallsStopped = !areBallsMoving();
-
-    if (currentBallsStopped && !allBallsStopped) {
-        if (cueBallPocketed) {
-            // Penalti jika bola putih masuk
-            cueBallPocketed = false;  // Reset indikator
-            playerTurn = (playerTurn % 2) + 1;  // Ganti giliran pemain
-        } else if (!playerScored) {
-            // Ganti giliran pemain hanya jika tidak mendapatkan poin
-            playerTurn = (playerTurn % 2) + 1;
-            
-        } else {
-            // Pemain mencetak poin, giliran tidak berubah
-        }
-
-        // Reset indikator playerScored hanya setelah giliran diproses
-        playerScored = false;
+    if (this->stateHistory && !rewinding) {
+        this->stateHistory->record(*simulation, match); // Nothing is added while the table rests
     }
 
-    allBallsStopped = currentBallsStopped;  // Update status berhenti bola
-
+    AllocationTracker::setPhase(AllocationPhase::Interface);
     this->updateUI();  // Perbarui tampilan UI
+    this->updateStatsOverlay();
+
+    AllocationTracker::setPhase(AllocationPhase::Network);
+    if (this->spectatorServer) {
+        this->spectatorServer->publish(simulation->getBallPool());
+    }
+    if (this->matchRecorder) {
+        this->matchRecorder->record(simulation->getBallPool());
+    }
 }
 
 
 
 void Game::render() {
-    this->window->clear(window_color);
+    AllocationScope renderScope(AllocationPhase::Render);
+    sf::Clock renderClock;
 
-    table.draw(*this->window);
+    // The table goes to the scaled offscreen target when dynamic resolution is on, the HUD text never does
+    sf::RenderTarget& scene = this->dynamicResolution ? this->dynamicResolution->begin(sf::Color(spec.window_color)) : *this->window;
+    if (!this->dynamicResolution) {
+        this->window->clear(sf::Color(spec.window_color));
+    }
 
-    for (Hole* hole : holes) {
-        hole->draw(*this->window);
+    BallPool& ballPool = simulation->getBallPool();
+    simulation->getTable().draw(scene);
+
+    for (Hole* hole : simulation->getHoles()) {
+        hole->draw(scene);
     }
 
-    for (Ball* ball : balls) {
-        ball->draw(*this->window);
+    const std::vector<int>& onTable = ballPool.getOnTable();
+    if (onTable.size() <= 256) {
+        for (int id : onTable) {
+            ballPool.get(id).draw(scene);
+        }
+    } else {
+        // One hexagon per ball in a single vertex array, the vertices are reused from frame to frame
+        const int segments = 6;
+        ballBatch.setPrimitiveType(sf::Triangles);
+        ballBatch.resize(onTable.size() * segments * 3);
+
+        std::size_t vertex = 0;
+        for (int id : onTable) {
+            const Ball& ball = ballPool.get(id);
+            sf::Vector2f center = ball.getPosition();
+            sf::Color color = ball.shape.getFillColor();
+            for (int k = 0; k < segments; ++k) {
+                float a0 = 2 * spec.phi * k / segments;
+                float a1 = 2 * spec.phi * (k + 1) / segments;
+                ballBatch[vertex++] = sf::Vertex(center, color);
+                ballBatch[vertex++] = sf::Vertex(center + spec.ball_radius * sf::Vector2f(std::cos(a0), std::sin(a0)), color);
+                ballBatch[vertex++] = sf::Vertex(center + spec.ball_radius * sf::Vector2f(std::cos(a1), std::sin(a1)), color);
+            }
+        }
+        scene.draw(ballBatch);
     }
 
     // Render pocketed solid balls
     for (size_t i = 0; i < pocketedSolidBalls.size(); ++i) {
-        sf::Vector2f position(50 , 50 + i * (2 * ball_radius + 10)); // Top-left alignment
-        pocketedSolidBalls[i]->setPosition(position);
-        pocketedSolidBalls[i]->draw(*this->window);
+        sf::Vector2f position(50 , 50 + i * (2 * spec.ball_radius + 10)); // Top-left alignment
+        if (position.y > spec.window_height) break;
+        Ball& ball = ballPool.get(pocketedSolidBalls[i]);
+        ball.setPosition(position);
+        ball.draw(scene);
     }
 
     // Render pocketed striped balls
     for (size_t i = 0; i < pocketedStripedBalls.size(); ++i) {
-        sf::Vector2f position(window_width - 50, 50 + i * (2 * ball_radius + 10)); // Top-right alignment
-        pocketedStripedBalls[i]->setPosition(position);
-        pocketedStripedBalls[i]->draw(*this->window);
+        sf::Vector2f position(spec.window_width - 50, 50 + i * (2 * spec.ball_radius + 10)); // Top-right alignment
+        if (position.y > spec.window_height) break;
+        Ball& ball = ballPool.get(pocketedStripedBalls[i]);
+        ball.setPosition(position);
+        ball.draw(scene);
     }
 
-    cueStick.draw(*this->window);
+    if (showShotPreview && cueStick.isDrag()) {
+        scene.draw(previewLines);
+        scene.draw(previewGhost);
+    }
 
+    // Late latch: the stick follows the cursor as it is now, not as it was when update() ran
+    if (cueStick.isDrag() && !isCueBallDraggable) {
+        cueStick.update(static_cast<sf::Vector2f>(sf::Mouse::getPosition(*this->window)));
+    }
+    cueStick.draw(scene);
+
+    if (this->dynamicResolution) {
+        this->dynamicResolution->present(*this->window);
+    }
     this->window->draw(scoreText);
     this->window->draw(turnText);
+    if (showStats) {
+        this->window->draw(statsText);
+    }
 
+    // Under vsync display() blocks for the refresh, only the work before it tells how busy the frame is
+    const bool vsync = framePacer.getSettings().mode == PacingMode::VSync;
+    double frameMilliseconds = vsync ? frameClock.getElapsedTime().asMicroseconds() / 1000.0 : 0.0;
     this->window->display();
+    inputLatency.markPresented();
+    if (!vsync) frameMilliseconds = frameClock.getElapsedTime().asMicroseconds() / 1000.0;
+
+    if (this->dynamicResolution && framePacer.getSettings().frameRate > 0) {
+        this->dynamicResolution->reportFrame(frameMilliseconds, 1000.0 / framePacer.getSettings().frameRate);
+    }
+
+    renderMicroseconds += renderClock.getElapsedTime().asMicroseconds();
+    ++timedFrames;
+    this->countFrameAllocations();
+    this->reportFrameTimings();
+    this->reportInputLatency();
+
+    this->framePacer.endFrame();
+    this->frameClock.restart(); // The next frame starts with update()
+}
+
+void Game::reportFrameTimings() {
+    if (!reportTimings || timingReportClock.getElapsedTime() < sf::seconds(2.0f) || timedFrames == 0) return;
+
+    const ContactSolver& contactSolver = simulation->getContactSolver();
+    BILLIARD_LOG(Info, Timing) << "balls: " << simulation->getBallPool().getOnTable().size()
+                               << "  physics: " << physicsMicroseconds / 1000.0 / timedFrames << " ms"
+                               << "  render: " << renderMicroseconds / 1000.0 / timedFrames << " ms"
+                               << "  scale: " << getRenderScale()
+                               << "  contacts: " << contactSolver.getStats().contacts
+                               << "  solver iterations: " << contactSolver.getStats().iterations
+                               << "  colors: " << contactSolver.getStats().colors
+                               << "  allocations: " << (this->getAllocationTotal().allocations - reportedAllocations.allocations) / static_cast<double>(timedFrames) << "/frame"
+                               << "  frames: " << timedFrames;
+    reportedAllocations = this->getAllocationTotal();
+
+    physicsMicroseconds = 0;
+    renderMicroseconds = 0;
+    timedFrames = 0;
+    timingReportClock.restart();
+}
+
+void Game::countFrameAllocations() {
+    frameAllocations.end();
+    for (int phase = 0; phase < AllocationTracker::phaseCount; ++phase) {
+        allocationTotals[phase] += frameAllocations.getLast(static_cast<AllocationPhase>(phase));
+    }
+    ++allocationFrames;
+    if (frameAllocations.getLastTotal().allocations > 0) ++allocatingFrames;
+}
+
+AllocationCounts Game::getAllocationTotal() const {
+    AllocationCounts total;
+    for (const AllocationCounts& counts : allocationTotals) {
+        total += counts;
+    }
+    return total;
+}
+
+void Game::updateStatsOverlay() {
+    // Refreshing the text allocates too, once a second it shows up under interface
+    if (!showStats || statsClock.getElapsedTime() < sf::seconds(1.0f)) return;
+
+    AllocationCounts interval[AllocationTracker::phaseCount];
+    AllocationCounts intervalTotal;
+    for (int phase = 0; phase < AllocationTracker::phaseCount; ++phase) {
+        interval[phase] = allocationTotals[phase] - statsAllocations[phase];
+        intervalTotal += interval[phase];
+    }
+    const double frames = static_cast<double>(std::max(1LL, allocationFrames - statsFrame));
+
+    char phases[160];
+    formatAllocationPhases(interval, frames, phases, sizeof(phases));
+    FrameTimeStats times = framePacer.getStats();
+    char line[320];
+    std::snprintf(line, sizeof(line), "frame p50 %.2f ms  p99 %.2f ms   heap %.1f allocations  %.0f bytes per frame (%s)",
+                  times.p50, times.p99, intervalTotal.allocations / frames, intervalTotal.bytes / frames, phases);
+    statsText.setString(line);
+
+    std::copy(allocationTotals, allocationTotals + AllocationTracker::phaseCount, statsAllocations);
+    statsFrame = allocationFrames;
+    statsClock.restart();
+}
+
+void Game::reportInputLatency() {
+    if (!reportLatency || latencyReportClock.getElapsedTime() < sf::seconds(2.0f)) return;
+
+    if (inputLatency.getSampleCount() > 0) {
+        BILLIARD_LOG(Info, Timing) << "aim latency: " << inputLatency.getMeanMilliseconds() << " ms mean, "
+                                   << inputLatency.getMaxMilliseconds() << " ms max over "
+                                   << inputLatency.getSampleCount() << " frames";
+    }
+    inputLatency.reset();
+    latencyReportClock.restart();
 }
 
 
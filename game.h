@@ -10,223 +10,166 @@
 #include <algorithm>
 
 
-struct SizeRef {
-    // Window Dimension
-    const float window_width = 2500.0f;
-    const float window_height = 1500.0f;
-    const int frLimit = 60;
-
-    // Table Properties
-    const float table_width = 2000.f;
-    const float table_height = 1000.0f;
-    sf::Vector2f table_dimension = sf::Vector2f(table_width, table_height);
-
-    // Offset Property
-    const float table_offsetX = (window_width - table_width) / 2;
-    const float table_offsetY = (window_height - table_height) / 2;
-    sf::Vector2f table_offset = sf::Vector2f(table_offsetX, table_offsetY);
-
-    const float table_topBottomWall_width = table_width + 80.0f; // added 120.0f corresponding to the 2 times height
-    const float table_topBottomWall_height = 40.0f;
-    const float table_topBottomWallShadow_width = table_topBottomWall_width;
-    const float table_topBottomWallShadow_height = table_topBottomWall_height;
-
-    const float table_leftRightWall_width = 40.0f;
-    const float table_leftRightWall_height = table_height;
-    const float table_leftRightWallShadow_width = table_leftRightWall_width;
-    const float table_leftRightWallShadow_height = table_leftRightWall_height;
-
-    const float cornerRadius = 60.0f;
-    const float shadowOffset = 15.0f;
-
-    // Hole Properties
-    const int holeCount = 6;
-    const float hole_radius = 40.0f;
-
-    // Ball Properties
-    const int ballCount = 16;
-    const float ball_border_width = 4.0f;
-    const float ball_radius = 25.0f;
-
-    // CueStick Properties
-    const float stick_width = 5.0f;
-    const float stick_length = 200.0f;
-    const float minOffsetDistance = 40.0f; // Minimum distance from cue ball
-    const float maxOffsetDistance = 150.0f; // Maximum distance based on drag
-
-    // Pyhsics Properties
-    const float force_scaling_factor = 5.0f;
-    const float phi = 3.14159f;
-    const float friction = 0.985f;
-    const float minVelocityThreshold = 0.05f;
-    const float restitution = 0.97f; // Coefficient of restitution (1.0 = elastic, 0.0 = inelastic)
-};
-
-struct ColorRef {
-    // Window Color 
-    sf::Color window_color = sf::Color(46, 80, 119);
-
-    // Ball Color Properties
-    sf::Color ballBorderColor = sf::Color(255, 255, 255);
-    std::vector<sf::Color> ballColors = {
-        sf::Color(255, 215, 0),       // Yellow (Ball 1)
-        sf::Color(255, 0, 0),         // Red (Ball 2)
-        sf::Color(0, 0, 255),         // Blue (Ball 3)
-        sf::Color(255, 69, 0),        // Orange (Ball 4)
-        sf::Color(128, 0, 128),       // Purple (Ball 6)
-        sf::Color(0, 128, 0),         // Green (Ball 5)
-        sf::Color(139, 69, 19),       // Brown (Ball 8)
-        sf::Color(255, 192, 203),     // Pink (Ball 9)
-        sf::Color(255, 20, 147),      // Deep Pink (Ball 7)
-        sf::Color(0, 255, 255),       // Cyan (Ball 10)
-        sf::Color(255, 165, 0),       // Dark Orange (Ball 12)
-        sf::Color(0, 100, 0),         // Dark Green (Ball 14)
-        sf::Color(75, 0, 130),        // Indigo (Ball 11)
-        sf::Color(128, 128, 0),       // Olive (Ball 15)
-        sf::Color(86, 86, 86),        // Gray (Ball 13)
-        sf::Color(255, 255, 255)      // White (Cue Ball)
-    };
-
-    // Table Color Properties
-    sf::Color tableColor = sf::Color(0, 204, 0); // Bright green
-    sf::Color tableWallColor= sf::Color(139, 69, 19); // Dark wood color
-    sf::Color tableShadowColor = sf::Color(105, 58, 26);
-    sf::Color tableSecWallColor = sf::Color(86, 86, 86);
-    // Hole Color Properties
-    sf::Color holeColor = sf::Color(0, 0, 0);
-};
+#include "table_spec.h"
+#include "rack.h"
+#include "spatial_grid.h"
+#include "contact_solver.h"
+#include "frame_pacer.h"
+#include "scalar_physics.h"
+#include "match.h"
+#include "shot_preview.h"
+#include "allocation_tracker.h"
 
-struct SizePositionRef : public SizeRef {
-    
-    // Ball Positions
-    // std::vector<sf::Vector2f> ballPositions = generate(ballCount, ball_radius, table_dimension, table_offset);
-    // Table Position Properties
-    // const float shadowOffset = 15.0f;
-    const sf::Vector2f table_topWall = sf::Vector2f(window_width / 2, (window_height - table_height - table_topBottomWall_height) / 2);
-    const sf::Vector2f table_topWallShadow = sf::Vector2f(table_topWall.x, table_topWall.y);
-    
-    const sf::Vector2f table_bottomWall = sf::Vector2f(window_width / 2, (window_height + table_height + table_topBottomWall_height) / 2);
-    const sf::Vector2f table_bottomWallShadow = sf::Vector2f(table_bottomWall.x, table_bottomWall.y);
-
-    const sf::Vector2f table_leftWall = sf::Vector2f((window_width - table_width - table_leftRightWall_width) / 2, window_height / 2);
-    const sf::Vector2f table_leftWallShadow = sf::Vector2f(table_leftWall.x, table_leftWall.y);
-
-    const sf::Vector2f table_rightWall = sf::Vector2f((window_width + table_width + table_leftRightWall_width) / 2, window_height / 2);
-    const sf::Vector2f table_rightWallShadow = sf::Vector2f(table_rightWall.x, table_rightWall.y);
-
-    // Window : 3000 x 1800 // Table : 2000 x 1200
-    // Window : 800 x 400 // Table : 700 x 300
-
-    const sf::Vector2f topLeftCornerPosition = sf::Vector2f(table_topWall.x - table_width - cornerRadius, table_topWall.y - cornerRadius);
-    const sf::Vector2f topRightCornerPosition = sf::Vector2f(table_topWall.x + table_width + cornerRadius, table_topWall.y - cornerRadius);
-    const sf::Vector2f bottomLeftCornerPosition = sf::Vector2f(table_topWall.x - table_width - cornerRadius, table_bottomWall.y + cornerRadius);
-    const sf::Vector2f bottomRightCornerPosition = sf::Vector2f(table_topWall.x + table_width + cornerRadius, table_bottomWall.y + cornerRadius);
-
-    const sf::Vector2f hole_topLeft = table_offset;
-    const sf::Vector2f hole_bottomLeft = sf::Vector2f(table_offsetX, table_offsetY + table_height);
-    const sf::Vector2f hole_topMid = sf::Vector2f(window_width / 2, (window_height - table_height - table_topBottomWall_height * 0.5) / 2);
-    const sf::Vector2f hole_bottomMid = sf::Vector2f(window_width / 2, (window_height + table_height + table_topBottomWall_height * 0.5) / 2);
-    const sf::Vector2f hole_topRight = sf::Vector2f((window_width + table_width) / 2, table_offsetY);
-    const sf::Vector2f hole_bottomRight = sf::Vector2f((window_width + table_width) / 2, (table_offsetY + table_height));
-
-};
 
-/* ------ Use This Struct Inheritance to Hold All Size, Position, and Color References ------ */
+/* ------ Position Engine, Generates the Hole Layout of a TableSpec (racks live in rack.h) ------ */
 
-struct References : public SizePositionRef, public ColorRef {
-    std::vector<float> generateBallsPositionX (int ballCount, float ballRadius, sf::Vector2f playGroundDimension);
-    std::vector<float> generateBallsPositionY (int ballCount, float ballRadius, sf::Vector2f playGroundDimension);
-    std::vector<sf::Vector2f> generateBallsPositions(int ballcount, float ballRadius, sf::Vector2f playGroundDimension, sf::Vector2f offset);
-    void displayPosition(std::string log, sf::Vector2f position);
-    std::vector<sf::Vector2f> generateHolesPositions (int holeCount, float holeRadius, sf::Vector2f playGroundDimension, sf::Vector2f offset);
-}; 
+void displayPosition(std::string log, sf::Vector2f position);
+std::vector<sf::Vector2f> generateHolesPositions (const TableSpec& spec);
 
 /* ------------------------------------------------------------------------------------------ */
-class Table : private References {
+class SpectatorServer;
+class MatchRecorder;
+class EventEngine;
+class Simulation;
+class DynamicResolution;
+struct DynamicResolutionSettings;
+class StateHistory;
+struct StateHistorySettings;
+
+class Table {
     private:
         sf::RectangleShape table;
         sf::RectangleShape topWall, bottomWall, leftWall, rightWall;
         sf::RectangleShape topWallShadow, bottomWallShadow, leftWallShadow, rightWallShadow;
         sf::CircleShape topLeftCorner, topRightCorner, bottomLeftCorner, bottomRightCorner;
+        std::vector<CushionPolygon<float>> cushionPolygons; // The SecWalls in world coordinates, same order as getCushions()
 
     public:
         sf::ConvexShape topLeftSecWall, topRightSecWall, bottomLeftSecWall, bottomRightSecWall, leftSecWall, rightSecWall;
 
         // Constructor
-        Table();
+        explicit Table(const TableSpec& spec = pool9ftTable);
 
         // Functions
-        void draw(sf::RenderWindow& window);
+        void draw(sf::RenderTarget& target);
 
         // Getter Functions
         sf::Vector2f getPosition();
         sf::Vector2f getDimension();
+        std::vector<const sf::Shape*> getShapes() const; // In the order draw() paints them
+        std::vector<const sf::ConvexShape*> getCushions() const; // The SecWalls, in the order balls are bounced off them
+        const std::vector<CushionPolygon<float>>& getCushionPolygons() const;
 
 };
 
-class Ball : public References {
-private:
-    // Private Variables
+enum class BallType : sf::Uint8 {
+    Cue = 0,
+    Solid = 1,
+    Striped = 2,
+    Black = 3
+};
 
+class Ball {
 public:
     sf::CircleShape shape;
     sf::Vector2f velocity;
+    sf::Vector2f previousPosition; // Start of the path swept by the last update, used for pocket capture
+    int id; // Slot index inside the BallPool, stable for the whole rack
+    BallType type;
+    bool pocketed;
+    int restFrames; // Consecutive frames without velocity or contacts, the pool sleeps the ball past spec.sleepFrames
 
     // Constructor
-    Ball(sf::Vector2f position, sf::Color color);
+    Ball(sf::Vector2f position, sf::Color color, BallType type, const TableSpec& spec);
 
     // Functions
-    void draw(sf::RenderWindow& window);
+    void reset(sf::Vector2f position, sf::Color color, BallType type, const TableSpec& spec); // Restyle in place, reuses the shape's buffers
+    void draw(sf::RenderTarget& target);
     void applyForce(const sf::Vector2f& force);
-    bool checkCollision(const Ball& other) const;
-    void resolveCollision(Ball& other);
-    bool checkCollisionWithTrapezium(const sf::ConvexShape& trapezium) const;
-    void resolveCollisionWithTrapezium(const sf::ConvexShape& trapezium);
 
-    void update(const Table& table); // Pass Table by reference
+    // Physics kernels, specialized per table so its constants fold into the loops. The collision,
+    // cushion and integration math lives in the scalar kernels of scalar_physics.h, run with float
+    template <const TableSpec& Spec> bool checkCollision(const Ball& other) const;
+    template <const TableSpec& Spec> void resolveCollision(Ball& other, const PhysicsParameters& physics);
+    template <const TableSpec& Spec> bool checkCollisionWithTrapezium(const sf::ConvexShape& trapezium) const;
+    template <const TableSpec& Spec> void resolveCollisionWithTrapezium(const sf::ConvexShape& trapezium, const PhysicsParameters& physics);
+    template <const TableSpec& Spec> void update(const Table& table, const PhysicsParameters& physics); // Pass Table by reference
 
 
     // Getter Functions
     sf::Vector2f getPosition() const;
+    sf::Vector2f getPreviousPosition() const;
     sf::Vector2f getVelocity() const;
+    PhysicsBall<float> getPhysicsState() const;
 
     // Setter Functions
-    void setPosition(sf::Vector2f position);
+    void setPosition(sf::Vector2f position); // Teleports, the next swept path starts here
     void setVelocity(sf::Vector2f velocity);
-
-    virtual ~Ball() {};
+    void setPhysicsState(const PhysicsBall<float>& state); // Position and velocity, the swept path is left alone
 };
 
-class SolidBall : public Ball {
-public:
-    SolidBall(sf::Vector2f position, sf::Color color);
-};
+/*
+    Contiguous storage for every ball of a rack.
 
-class StripedBall : public Ball {
-public:
-    StripedBall(sf::Vector2f position, sf::Color color);
-};
+    Slots are kept alive across resets and restyled in place, so racking again only touches
+    the heap when the pool grows past its previous high-water mark. Pocketed balls keep their
+    slot with the pocketed flag set and are swap-removed from the on-table id list.
+    Call reset() with the expected ball count before spawning so references stay valid.
+
+    Balls on the table are either awake or asleep. Only awake balls are integrated, tested
+    against cushions and pockets, and used to start pair tests; a sleeping ball costs nothing
+    until a contact, a cue hit or a placement wakes it. Every ball on the table is indexed in
+    a SpatialGrid so an awake ball only meets its neighbours. Balls spawn asleep.
+*/
+class BallPool {
+private:
+    const TableSpec* spec;
+    std::vector<Ball> slots;
+    std::size_t used;
+    std::vector<int> onTable;   // Ids of the balls still in play, unordered
+    std::vector<int> tableSlot; // Index of each id inside onTable, -1 once pocketed
+    std::vector<int> awake;     // Ids of the balls being simulated, unordered
+    std::vector<int> awakeSlot; // Index of each id inside awake, -1 while asleep or pocketed
+    SpatialGrid grid;           // Every ball on the table, cells of one ball diameter
 
-class BlackBall : public Ball {
 public:
-    BlackBall(sf::Vector2f position, sf::Color color);
+    explicit BallPool(const TableSpec& spec = pool9ftTable);
+
+    void reset(std::size_t expectedCount);
+    Ball& spawn(sf::Vector2f position, sf::Color color, BallType type);
+    void pocket(int id);
+    void wake(int id);
+    void sleep(int id);
+    void place(int id, sf::Vector2f position); // Teleports the ball and wakes it
+    void rebin(int id);                        // Call after moving a ball so the grid follows it
+    void restore(int id, sf::Vector2f position, bool inPlay, bool isAwake); // Back to an earlier state, set the velocity afterwards
+
+    // Getter Functions
+    Ball& get(int id);
+    const Ball& get(int id) const;
+    std::size_t size() const;
+    const std::vector<int>& getOnTable() const;
+    const std::vector<int>& getAwake() const;
+    bool isAwake(int id) const;
+    int getAwakeSlot(int id) const;
+    const SpatialGrid& getGrid() const;
 };
 
-class CueStick : private References {
+class CueStick {
 private:
-    sf::Texture stickTexture; // Texture for the cue stick
-    sf::Sprite stickSprite;   // Sprite to draw the cue stick
+    const TableSpec& spec;
+    sf::Sprite stickSprite; // Sprite to draw the cue stick, its texture is shared through GameAssets
     sf::Vector2f startPosition;
     sf::Vector2f endPosition;
     bool isDragging = false;
     float power;
 
 public:
-    CueStick();
+    explicit CueStick(const TableSpec& spec = pool9ftTable);
     void startDragging(const sf::Vector2f& cueBallPosition);
     void stopDragging();
     void update(const sf::Vector2f& mousePosition);
-    void draw(sf::RenderWindow& window);
+    void draw(sf::RenderTarget& target);
 
     // Getter Functions
     bool isDrag() const;
@@ -235,57 +178,164 @@ public:
 };
 
 
-class Hole : private References {
+class Hole {
 private:
     sf::CircleShape shape;
 
 public:
-    Hole(sf::Vector2f position);
-    void draw(sf::RenderWindow& window);
-    bool isBallInHole(const sf::Vector2f& ballPosition, float ballRadius) const;
+    Hole(sf::Vector2f position, const TableSpec& spec);
+    void draw(sf::RenderTarget& target);
+    template <const TableSpec& Spec> bool isBallInHole(const sf::Vector2f& ballPosition) const;
+    // True when the path from -> to enters the capture region, entryTime is the fraction of the path travelled
+    template <const TableSpec& Spec> bool sweptCapture(const sf::Vector2f& from, const sf::Vector2f& to, float& entryTime) const;
     // Getter Functions
     sf::Vector2f getPosition() const;
+    const sf::CircleShape& getShape() const;
 };
 
 
-class Game : private References {
+struct PocketEvent {
+    int ballId;
+    int holeIndex;
+    double time;           // Physics steps since the rack, the fraction is when the ball entered during its step
+    sf::Vector2f position; // Ball center where it crossed into the capture region
+};
+
 
+/*
+    Aiming latency, from an input event to the end of the display() call of the first frame
+    that shows it. SFML events carry no timestamp, so an event is stamped when pollEvents()
+    takes it off the queue; the numbers leave out the time it sat in the OS queue before.
+*/
+class InputLatencyMeter {
 private:
+    sf::Clock clock;            // Time base of every input timestamp
+    sf::Int64 pendingInput;     // Oldest input not on screen yet, -1 when there is none
+    sf::Int64 totalMicroseconds;
+    sf::Int64 maxMicroseconds;
+    int samples;
+
+public:
+    InputLatencyMeter();
+
+    sf::Int64 now() const; // Microseconds
+    void markInput(sf::Int64 timestamp); // The next presented frame reflects this input
+    void markPresented();                // Call right after display()
+    void reset();
+
+    // Getter Functions
+    int getSampleCount() const;
+    double getMeanMilliseconds() const;
+    double getMaxMilliseconds() const;
+};
+
+
+// What the score and turn texts show, they are only rebuilt when it changes
+struct HudState {
+    int scores[2] = { -1, -1 };
+    int turn = 0;
+    int winner = 0;
+    bool over = false;
+    bool ballInHand = false;
+    bool showSpin = false;
+    sf::Vector2i spin; // Tip offset in tenths of a ball radius
+    int rewindTicks = -1; // How far behind the newest recorded tick the table is shown, -1 while playing
+
+    bool operator==(const HudState& other) const;
+};
+
+
+class Game {
+
+private:
+    const TableSpec& spec;
+
     // Window Variables
     sf::RenderWindow* window;
     sf::Event ev;
     sf::VideoMode videoMode;
 
     // Game Objects
-    SolidBall* solidBall;
-    StripedBall* stripedBall;
+    Simulation* simulation; // Balls, table, holes and the fixed-step physics
     Ball* cueBall;
-    std::vector<Ball*> balls;
     CueStick cueStick;
-    Table table;
-    std::vector<sf::Vector2f> ballPositions;
-    Hole* hole;
-    std::vector<Hole*> holes;
 
-    int playerTurn;
-    int playerScores[2];
-    bool isCueBallPocketed;
+    Match match; // Turns, scores, fouls and the end of the match
 
-    sf::Font font;
-    sf::Text scoreText;
+    sf::Text scoreText; // The font and sound buffers are shared through GameAssets
     sf::Text turnText;
+    HudState shownHud;
+
+    // Profiler overlay, toggled with F3 and refreshed once a second
+    sf::Text statsText;
+    bool showStats;
+    sf::Clock statsClock;
 
-    sf::SoundBuffer cueStickHitBuffer;
     sf::Sound cueStickHitSound;
-    sf::SoundBuffer collisionSoundBuffer; 
     sf::Sound collisionSound;
+    bool soundsAttached; // False until the shared sounds finished decoding
    
     bool isCueBallDraggable = false;
     bool isDraggingCueBall = false;
-    sf::Vector2f initialCueBallPosition;
 
-    std::vector<Ball*> pocketedSolidBalls;   // Solid balls that fell into holes
-    std::vector<Ball*> pocketedStripedBalls; // Striped balls that fell into holes
+    RackOptions rackOptions;
+    int ballCount; // Balls in the current rack, the cue ball included
+
+    // Frame timings, reported periodically by the sandbox stress mode
+    bool reportTimings;
+    sf::Clock timingReportClock;
+    sf::Int64 physicsMicroseconds;
+    sf::Int64 renderMicroseconds;
+    int timedFrames;
+    sf::VertexArray ballBatch; // Large racks are drawn in one call instead of one per ball
+
+    FramePacer framePacer; // Waits out each frame after display(), and keeps the frame-time histogram
+    sf::Clock frameClock;  // Restarted once the pacer lets the next frame start
+    DynamicResolution* dynamicResolution; // Optional, the table is drawn at a scale that follows the frame times
+
+    // Aiming input, the stick pose is latched again right before display()
+    InputLatencyMeter inputLatency;
+    bool reportLatency;
+    sf::Clock latencyReportClock;
+
+    // Heap activity of the game thread, steady play is expected to allocate nothing
+    AllocationSampler frameAllocations; // The last frame, per phase
+    AllocationCounts allocationTotals[AllocationTracker::phaseCount]; // Since the game started
+    long long allocationFrames;
+    long long allocatingFrames;         // Frames with at least one allocation
+    AllocationCounts reportedAllocations; // Totals at the last timing report
+    AllocationCounts statsAllocations[AllocationTracker::phaseCount]; // Totals at the last overlay refresh
+    long long statsFrame;
+
+    std::vector<int> pocketedSolidBalls;   // Ids of solid balls that fell into holes
+    std::vector<int> pocketedStripedBalls; // Ids of striped balls that fell into holes
+
+    SpectatorServer* spectatorServer; // Optional, broadcasts the table to viewers when set
+    MatchRecorder* matchRecorder;     // Optional, writes the same stream to a file every frame
+
+    // Optional rewind history, Backspace stops play and shows the recorded ticks instead
+    StateHistory* stateHistory;
+    bool rewinding;
+    long long rewindTick; // Tick on the table while rewinding
+
+    // Optional analytic engine, a shot is solved once on release and replayed frame by frame
+    EventEngine* eventEngine;
+    bool analyticShotActive;
+    double analyticShotTime;
+    double analyticShotEnd;
+    std::size_t analyticNextEvent;
+    std::vector<int> analyticBallIds; // Pool id of every engine ball
+    sf::Vector2f cueTipOffset;        // In ball radii, x is side spin, y is top (+) or back (-) spin
+
+    // Aiming guide, solved off the render thread by shotPreview and drawn from the last finished result
+    ShotPreview* shotPreview;
+    ShotPreviewRequest previewRequest; // Reused, the preview swaps the buffers back and forth
+    ShotPreviewResult previewResult;
+    sf::Vector2f previewVelocity;   // Aim of the last request, a new one is only sent when it changes
+    sf::Vector2f previewTipOffset;
+    sf::VertexArray previewLines;   // Cue ball and object ball paths
+    sf::CircleShape previewGhost;   // Cue ball at the first contact
+    bool showShotPreview;
 
     // Private Functions
     void initVariables();
@@ -296,14 +346,47 @@ private:
     void initFontText();
     void resetBalls();
     void updateUI();
+    void updateStatsOverlay();
+    void countFrameAllocations();
+    AllocationCounts getAllocationTotal() const;
+    void reportFrameTimings();
+    void reportInputLatency();
     bool areBallsMoving() const;
+    void updatePhysics();
+    void pocketBall(Ball& ball);
+    void startAnalyticShot(sf::Vector2f velocity);
+    void updateAnalyticShot();
+    void updateShotPreview();
+    void clearShotPreview();
+    void startRewind();
+    void scrubRewind(long long ticks);
+    void stopRewind(bool resumeHere); // Play on from the tick shown, or return to the newest one
+    void showRewindTick();
 
 public:
     // Constructor / Destructor
-    Game();
+    explicit Game(const TableSpec& spec = pool9ftTable, const RackOptions& rackOptions = RackOptions());
     virtual ~Game();
 
+    // Spectator Broadcast
+    bool enableSpectatorServer(unsigned short port, float broadcastRate, int keyframeInterval, int quantThreshold);
+    bool enableMatchRecorder(const std::string& path, int keyframeInterval);
+
+    // Shots are solved by the event-driven EventEngine instead of the fixed-step loop
+    void enableAnalyticEngine();
+    void setContactSolverSettings(const ContactSolverSettings& settings);
+    void setPhysics(const PhysicsParameters& physics); // Fixed-step engine only, the analytic engine keeps its own model
+    void enableLatencyReport(); // Logs the aiming latency every two seconds
+    void setFramePacing(const FramePacerSettings& settings);
+    void enableDynamicResolution(const DynamicResolutionSettings& settings);
+    void enableRewind(const StateHistorySettings& settings); // Fixed-step engine only
+
     // Getter Functions
+    const std::vector<PocketEvent>& getPocketEvents() const;
+    const InputLatencyMeter& getInputLatency() const;
+    const Match& getMatch() const;
+    FrameTimeStats getFrameTimeStats() const;
+    float getRenderScale() const; // 1 unless dynamic resolution lowered it
     const bool running() const; // SafePromising not to modify Object Class Member Variables and not modify returned value
 
     // Functions
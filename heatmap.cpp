@@ -0,0 +1,235 @@
+#include "heatmap.h"
+#include "simulation.h"
+#include "logger.h"
+#include <SFML\Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+
+namespace {
+
+const char* const ballTypeNames[] = { "cue", "solid", "striped", "black" };
+
+// Black through red and yellow to white, t in [0, 1]
+sf::Color heatColor(float t) {
+    auto channel = [](float value) {
+        return static_cast<sf::Uint8>(std::max(0.0f, std::min(1.0f, value)) * 255.0f + 0.5f);
+    };
+    return sf::Color(channel(t * 3.0f), channel(t * 3.0f - 1.0f), channel(t * 3.0f - 2.0f));
+}
+
+} // namespace
+
+
+/* === HeatmapGrid Class Definition STARTS HERE === */
+
+HeatmapGrid::HeatmapGrid() : inverseCellSize(1.0f), columns(0), rows(0) {
+}
+
+void HeatmapGrid::configure(sf::Vector2f origin, sf::Vector2f size, float cellSize) {
+    this->origin = origin;
+    inverseCellSize = 1.0f / std::max(1.0f, cellSize);
+    columns = std::max(1, static_cast<int>(std::ceil(size.x * inverseCellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil(size.y * inverseCellSize)));
+    cells.assign(static_cast<std::size_t>(columns) * rows, 0);
+}
+
+void HeatmapGrid::clear() {
+    std::fill(cells.begin(), cells.end(), 0);
+}
+
+void HeatmapGrid::add(sf::Vector2f position) {
+    int column = std::max(0, std::min(columns - 1, static_cast<int>((position.x - origin.x) * inverseCellSize)));
+    int row = std::max(0, std::min(rows - 1, static_cast<int>((position.y - origin.y) * inverseCellSize)));
+    ++cells[row * columns + column];
+}
+
+void HeatmapGrid::merge(const HeatmapGrid& other) {
+    if (other.columns != columns || other.rows != rows) return;
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+        cells[i] += other.cells[i];
+    }
+}
+
+bool HeatmapGrid::writeRaw(const std::string& path) const {
+    std::vector<char> bytes(cells.size() * 4);
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+        float value = static_cast<float>(cells[i]);
+        sf::Uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int b = 0; b < 4; ++b) {
+            bytes[i * 4 + b] = static_cast<char>((bits >> (8 * b)) & 0xFF);
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+bool HeatmapGrid::writePng(const std::string& path) const {
+    // The square root keeps the quiet cells visible next to the rack spot and the pockets
+    sf::Uint64 peak = this->getMax();
+    double scale = peak > 0 ? 1.0 / std::sqrt(static_cast<double>(peak)) : 0.0;
+
+    sf::Image image;
+    image.create(static_cast<unsigned int>(columns), static_cast<unsigned int>(rows));
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            double value = static_cast<double>(cells[row * columns + column]);
+            image.setPixel(column, row, heatColor(static_cast<float>(std::sqrt(value) * scale)));
+        }
+    }
+    return image.saveToFile(path);
+}
+
+// Getter Functions
+
+int HeatmapGrid::getColumns() const {
+    return columns;
+}
+
+int HeatmapGrid::getRows() const {
+    return rows;
+}
+
+sf::Uint64 HeatmapGrid::getCell(int column, int row) const {
+    return cells[row * columns + column];
+}
+
+double HeatmapGrid::getTotal() const {
+    double total = 0.0;
+    for (sf::Uint64 value : cells) total += static_cast<double>(value);
+    return total;
+}
+
+sf::Uint64 HeatmapGrid::getMax() const {
+    return cells.empty() ? 0 : *std::max_element(cells.begin(), cells.end());
+}
+
+
+/* === HeatmapAccumulator Class Definition STARTS HERE === */
+
+HeatmapAccumulator::HeatmapAccumulator(const TableSpec& spec, const HeatmapSettings& settings) : shots(0), steps(0) {
+    const sf::Vector2f origin = spec.table_offset();
+    const sf::Vector2f size = spec.table_dimension();
+    for (int type = 0; type < ballTypeCount; ++type) {
+        travel[type].configure(origin, size, settings.cellSize);
+        rest[type].configure(origin, size, settings.cellSize);
+    }
+    pocketOrigins.resize(generateHolesPositions(spec).size());
+    for (HeatmapGrid& grid : pocketOrigins) {
+        grid.configure(origin, size, settings.cellSize);
+    }
+}
+
+void HeatmapAccumulator::beginShot(const Simulation& simulation) {
+    const BallPool& ballPool = simulation.getBallPool();
+    for (int id : ballPool.getOnTable()) {
+        if (id >= static_cast<int>(shotStart.size())) shotStart.resize(id + 1);
+        shotStart[id] = ballPool.get(id).getPosition();
+    }
+}
+
+void HeatmapAccumulator::step(const Simulation& simulation) {
+    const BallPool& ballPool = simulation.getBallPool();
+    for (int id : ballPool.getAwake()) {
+        const Ball& ball = ballPool.get(id);
+        travel[static_cast<int>(ball.type)].add(ball.getPosition());
+    }
+    for (const PocketEvent& event : simulation.getPocketEvents()) {
+        this->ballPocketed(event.ballId, event.holeIndex);
+    }
+    ++steps;
+}
+
+void HeatmapAccumulator::ballPocketed(int ballId, int holeIndex) {
+    if (holeIndex < 0 || holeIndex >= static_cast<int>(pocketOrigins.size()) || ballId >= static_cast<int>(shotStart.size())) return;
+    pocketOrigins[holeIndex].add(shotStart[ballId]);
+}
+
+void HeatmapAccumulator::endShot(const Simulation& simulation) {
+    const BallPool& ballPool = simulation.getBallPool();
+    for (int id : ballPool.getOnTable()) {
+        const Ball& ball = ballPool.get(id);
+        rest[static_cast<int>(ball.type)].add(ball.getPosition());
+    }
+    ++shots;
+}
+
+void HeatmapAccumulator::merge(const HeatmapAccumulator& other) {
+    for (int type = 0; type < ballTypeCount; ++type) {
+        travel[type].merge(other.travel[type]);
+        rest[type].merge(other.rest[type]);
+    }
+    for (std::size_t hole = 0; hole < pocketOrigins.size() && hole < other.pocketOrigins.size(); ++hole) {
+        pocketOrigins[hole].merge(other.pocketOrigins[hole]);
+    }
+    shots += other.shots;
+    steps += other.steps;
+}
+
+void HeatmapAccumulator::clear() {
+    for (int type = 0; type < ballTypeCount; ++type) {
+        travel[type].clear();
+        rest[type].clear();
+    }
+    for (HeatmapGrid& grid : pocketOrigins) {
+        grid.clear();
+    }
+    shots = 0;
+    steps = 0;
+}
+
+bool HeatmapAccumulator::write(const std::string& prefix, bool png) const {
+    const std::string extension = png ? ".png" : ".f32";
+    auto writeGrid = [&](const HeatmapGrid& grid, const std::string& name) {
+        return png ? grid.writePng(prefix + "_" + name + extension) : grid.writeRaw(prefix + "_" + name + extension);
+    };
+
+    bool written = true;
+    for (int type = 0; type < ballTypeCount; ++type) {
+        written = writeGrid(travel[type], std::string("travel_") + ballTypeNames[type]) && written;
+        written = writeGrid(rest[type], std::string("rest_") + ballTypeNames[type]) && written;
+    }
+    for (std::size_t hole = 0; hole < pocketOrigins.size(); ++hole) {
+        written = writeGrid(pocketOrigins[hole], "pocket" + std::to_string(hole)) && written;
+    }
+
+    if (written) {
+        BILLIARD_LOG(Info, Physics) << "Wrote " << (2 * ballTypeCount + pocketOrigins.size()) << " heatmaps of "
+                                    << travel[0].getColumns() << "x" << travel[0].getRows() << " cells to " << prefix << "_*" << extension
+                                    << " (" << shots << " shots, " << steps << " steps)";
+    } else {
+        BILLIARD_LOG(Error, Physics) << "Failed to write the heatmaps to " << prefix << "_*" << extension;
+    }
+    return written;
+}
+
+// Getter Functions
+
+const HeatmapGrid& HeatmapAccumulator::getTravel(int ballType) const {
+    return travel[ballType];
+}
+
+const HeatmapGrid& HeatmapAccumulator::getRest(int ballType) const {
+    return rest[ballType];
+}
+
+const HeatmapGrid& HeatmapAccumulator::getPocketOrigins(int hole) const {
+    return pocketOrigins[hole];
+}
+
+int HeatmapAccumulator::getHoleCount() const {
+    return static_cast<int>(pocketOrigins.size());
+}
+
+long long HeatmapAccumulator::getShotCount() const {
+    return shots;
+}
+
+long long HeatmapAccumulator::getStepCount() const {
+    return steps;
+}
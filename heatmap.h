@@ -0,0 +1,91 @@
+#pragma once
+
+#include <SFML\System.hpp>
+#include <string>
+#include <vector>
+
+#include "table_spec.h"
+
+class Simulation;
+
+
+/*
+    Shot Heatmaps
+
+    Density maps of where balls travel and where they stop, accumulated over any number of
+    shots into grids of fixed resolution over the playing area (spec.table_dimension()), so
+    the memory never grows with the shot count. Per ball type there is
+        travel  one sample per awake ball per physics step, the time balls spend in each cell
+        rest    where balls lie once a shot is over
+    and per hole a map of where the balls that dropped into it were when the shot began.
+
+    A HeatmapAccumulator belongs to one thread and is never shared: step() follows every
+    Simulation::step() and only increments plain integer counts, so a cell stays exact however
+    many shots land in it. Threads each fill their own and merge() them once at the end, the
+    counts turn into f32 only when a grid is written.
+*/
+
+struct HeatmapSettings {
+    float cellSize = 10.0f; // Pixels per cell side
+};
+
+// Sample counts on a uniform grid, positions outside it land in the nearest edge cell
+class HeatmapGrid {
+private:
+    sf::Vector2f origin;
+    float inverseCellSize;
+    int columns;
+    int rows;
+    std::vector<sf::Uint64> cells; // Row by row
+
+public:
+    HeatmapGrid();
+
+    void configure(sf::Vector2f origin, sf::Vector2f size, float cellSize);
+    void clear();
+    void add(sf::Vector2f position); // One sample
+    void merge(const HeatmapGrid& other); // Same configuration only, anything else is ignored
+
+    bool writeRaw(const std::string& path) const; // columns * rows little endian f32, row by row
+    bool writePng(const std::string& path) const; // Square root scale up to the hottest cell
+
+    // Getter Functions
+    int getColumns() const;
+    int getRows() const;
+    sf::Uint64 getCell(int column, int row) const;
+    double getTotal() const;
+    sf::Uint64 getMax() const;
+};
+
+class HeatmapAccumulator {
+private:
+    static const int ballTypeCount = 4; // Cue, solid, striped, black, in BallType order
+
+    HeatmapGrid travel[ballTypeCount];
+    HeatmapGrid rest[ballTypeCount];
+    std::vector<HeatmapGrid> pocketOrigins; // Per hole
+    std::vector<sf::Vector2f> shotStart;    // Per ball id, where it was when the shot began
+    long long shots;
+    long long steps;
+
+public:
+    explicit HeatmapAccumulator(const TableSpec& spec, const HeatmapSettings& settings = HeatmapSettings());
+
+    void beginShot(const Simulation& simulation);
+    void step(const Simulation& simulation); // After every Simulation::step(), also takes its pocket events
+    void ballPocketed(int ballId, int holeIndex); // For shots solved without steps
+    void endShot(const Simulation& simulation);
+    void merge(const HeatmapAccumulator& other);
+    void clear();
+
+    // Writes prefix_travel_<type>, prefix_rest_<type> and prefix_pocket<n>, as .png or .f32
+    bool write(const std::string& prefix, bool png) const;
+
+    // Getter Functions
+    const HeatmapGrid& getTravel(int ballType) const;
+    const HeatmapGrid& getRest(int ballType) const;
+    const HeatmapGrid& getPocketOrigins(int hole) const;
+    int getHoleCount() const;
+    long long getShotCount() const;
+    long long getStepCount() const;
+};
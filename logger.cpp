@@ -0,0 +1,180 @@
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+
+namespace {
+
+const char* const levelNames[] = { "debug", "info", "warning", "error", "off" };
+const char* const categoryNames[] = { "setup", "gameplay", "physics", "assets", "network", "render", "timing" };
+
+} // namespace
+
+
+/* === Logger Class Definition STARTS HERE === */
+
+std::atomic<int> Logger::thresholds[static_cast<int>(LogCategory::Count)] = {
+    1, 1, 1, 1, 1, 1, 1 // Info
+};
+
+Logger::Logger() : slots(new Slot[capacity]), enqueuePosition(0), dequeuePosition(0), dropped(0), reportedDrops(0), stopping(false) {
+    for (std::size_t i = 0; i < capacity; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    worker = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_one();
+    worker.join(); // Drains what is left first
+    delete[] slots;
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+void Logger::write(LogLevel level, LogCategory category, const char* text, std::size_t length) {
+    // Bounded multi-producer queue: a slot is free for position p when its sequence equals p
+    std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots[position & (capacity - 1)];
+        std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+        if (difference == 0) {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        } else if (difference < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed); // Full, the worker is behind
+            return;
+        } else {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->category = category;
+    slot->length = static_cast<sf::Uint16>(std::min(length, maxLineLength));
+    std::memcpy(slot->text, text, slot->length);
+    slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+bool Logger::drain() {
+    bool wroteOut = false;
+    bool wroteErr = false;
+    std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+
+    while (true) {
+        Slot& slot = slots[position & (capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) break;
+
+        std::ostream& out = slot.level >= LogLevel::Warning ? std::cerr : std::cout;
+        out << '[' << getCategoryName(slot.category) << "] ";
+        if (slot.level >= LogLevel::Warning) out << getLevelName(slot.level) << ": ";
+        out.write(slot.text, slot.length);
+        out << '\n';
+        wroteOut = wroteOut || &out == &std::cout;
+        wroteErr = wroteErr || &out == &std::cerr;
+
+        slot.sequence.store(position + capacity, std::memory_order_release);
+        ++position;
+    }
+    dequeuePosition.store(position, std::memory_order_release);
+
+    std::size_t totalDrops = dropped.load(std::memory_order_relaxed);
+    if (totalDrops > reportedDrops) {
+        std::cerr << "[logger] " << totalDrops - reportedDrops << " lines dropped, the output could not keep up\n";
+        reportedDrops = totalDrops;
+        wroteErr = true;
+    }
+
+    // One flush per batch instead of one per line
+    if (wroteOut) std::cout.flush();
+    if (wroteErr) std::cerr.flush();
+    return wroteOut || wroteErr;
+}
+
+void Logger::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        lock.unlock();
+        bool wrote = drain();
+        lock.lock();
+        drained.notify_all();
+
+        if (stopping && !wrote) break;
+        // Writers never signal, a short wait keeps them lock free
+        if (!wrote) wakeUp.wait_for(lock, std::chrono::milliseconds(5));
+    }
+}
+
+void Logger::flush() {
+    std::size_t target = enqueuePosition.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mutex);
+    wakeUp.notify_one();
+    drained.wait(lock, [&]() { return dequeuePosition.load(std::memory_order_acquire) >= target || stopping; });
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    for (int i = 0; i <= static_cast<int>(LogLevel::Off); ++i) {
+        if (name == levelNames[i]) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Logger::parseCategory(const std::string& name, LogCategory& category) {
+    for (int i = 0; i < static_cast<int>(LogCategory::Count); ++i) {
+        if (name == categoryNames[i]) {
+            category = static_cast<LogCategory>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Logger::getLevelName(LogLevel level) {
+    return levelNames[static_cast<int>(level)];
+}
+
+const char* Logger::getCategoryName(LogCategory category) {
+    return categoryNames[static_cast<int>(category)];
+}
+
+// Getter Functions
+
+std::size_t Logger::getDroppedCount() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+// Setter Functions
+
+void Logger::setLevel(LogLevel level) {
+    for (std::atomic<int>& threshold : thresholds) {
+        threshold.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+}
+
+void Logger::setLevel(LogCategory category, LogLevel level) {
+    thresholds[static_cast<int>(category)].store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+
+/* === LogLine Class Definition STARTS HERE === */
+
+LogLine::LogLine(LogLevel level, LogCategory category)
+    : level(level), category(category), buffer(text, sizeof(text)), out(&buffer) {}
+
+LogLine::~LogLine() {
+    Logger::instance().write(level, category, text, buffer.length());
+}
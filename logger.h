@@ -0,0 +1,140 @@
+#pragma once
+
+#include <SFML\System.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+
+/*
+    Asynchronous Logger
+
+    BILLIARD_LOG(Info, Setup) << "Window created " << width << "x" << height;
+
+    A line is formatted on the caller's stack and copied into a fixed ring of slots with one
+    compare-and-swap, it never takes a lock, allocates or touches the console. A background
+    thread drains the ring, writes every waiting line and flushes once per batch, so a slow
+    stdout only delays that thread. When the ring is full new lines are dropped and counted
+    rather than stalling the frame.
+
+    Every category has its own threshold. A line below it costs one relaxed atomic load and
+    its arguments are never evaluated; lines below BILLIARD_LOG_MIN_LEVEL (0 - 4, set at
+    compile time) are removed entirely. Warnings and errors go to stderr, the rest to stdout.
+*/
+
+#ifndef BILLIARD_LOG_MIN_LEVEL
+#define BILLIARD_LOG_MIN_LEVEL 0
+#endif
+
+enum class LogLevel : sf::Uint8 {
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3,
+    Off = 4
+};
+
+enum class LogCategory : sf::Uint8 {
+    Setup = 0, // Construction and loading
+    Gameplay,  // Turns, input, pocketed balls
+    Physics,   // Solver and engine reports
+    Assets,
+    Network,
+    Render,
+    Timing,    // Frame time reports
+    Count
+};
+
+class Logger {
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        LogLevel level;
+        LogCategory category;
+        sf::Uint16 length;
+        char text[200];
+    };
+
+    static const std::size_t capacity = 1024; // Power of two
+    static const int compiledLevel = BILLIARD_LOG_MIN_LEVEL;
+    static std::atomic<int> thresholds[static_cast<int>(LogCategory::Count)];
+
+    Slot* slots;
+    std::atomic<std::size_t> enqueuePosition;
+    std::atomic<std::size_t> dequeuePosition; // Only the worker advances it
+    std::atomic<std::size_t> dropped;         // Lines lost to a full ring since the start
+    std::size_t reportedDrops;                // Part of dropped the worker already reported
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable drained;
+    bool stopping;
+
+    Logger();
+    ~Logger();
+    void run();
+    bool drain(); // Writes every waiting line, false when there was none
+
+public:
+    static constexpr std::size_t maxLineLength = sizeof(Slot::text); // Longer lines are cut
+
+    static Logger& instance();
+
+    static bool isEnabled(LogLevel level, LogCategory category) {
+        return static_cast<int>(level) >= compiledLevel &&
+               static_cast<int>(level) >= thresholds[static_cast<int>(category)].load(std::memory_order_relaxed);
+    }
+
+    void write(LogLevel level, LogCategory category, const char* text, std::size_t length);
+    void flush(); // Returns once every line written before the call is out
+
+    static bool parseLevel(const std::string& name, LogLevel& level);
+    static bool parseCategory(const std::string& name, LogCategory& category);
+    static const char* getLevelName(LogLevel level);
+    static const char* getCategoryName(LogCategory category);
+
+    // Getter Functions
+    std::size_t getDroppedCount() const; // Since the start
+
+    // Setter Functions
+    static void setLevel(LogLevel level); // Every category
+    static void setLevel(LogCategory category, LogLevel level);
+};
+
+// One line being formatted, handed to the Logger when the statement ends
+class LogLine {
+private:
+    class Buffer : public std::streambuf {
+    public:
+        Buffer(char* begin, std::size_t size) { setp(begin, begin + size); }
+        std::size_t length() const { return static_cast<std::size_t>(pptr() - pbase()); }
+    };
+
+    LogLevel level;
+    LogCategory category;
+    char text[Logger::maxLineLength];
+    Buffer buffer;
+    std::ostream out;
+
+public:
+    LogLine(LogLevel level, LogCategory category);
+    ~LogLine();
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    std::ostream& stream() { return out; }
+};
+
+// Lets the macro below be a single expression, so it is safe inside an unbraced if/else
+struct LogVoidify {
+    void operator&(std::ostream&) {}
+};
+
+#define BILLIARD_LOG(level, category)                                          \
+    !Logger::isEnabled(LogLevel::level, LogCategory::category) ? (void)0 :     \
+        LogVoidify() & LogLine(LogLevel::level, LogCategory::category).stream()
@@ -30,11 +30,997 @@
 // }
 
 
-int main() {
+#include "spectator.h"
+#include "vector_env.h"
+#include "replay_render.h"
+#include "logger.h"
+#include "dynamic_resolution.h"
+#include "scalar_physics.h"
+#include "match.h"
+#include "break_database.h"
+#include "calibration.h"
+#include "state_history.h"
+#include "shot_server.h"
+#include "heatmap.h"
+#include "worker_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+
+/*
+    Usage:
+        app [--table pool9ft|snooker|sandbox]   play locally
+        app --sandbox N [--pattern triangle|diamond|hex|random] [--seed s]
+                                                load N balls (sandbox table by default) and report timings
+        app --engine fixed|analytic             solve shots with the fixed-step loop (default) or the event engine
+        app --iterations n [--no-warm-start]   contact solver iteration limit and warm starting
+        app --threads n                         solve contacts in graph-colored batches on n threads
+        app --bench-contacts [threads]          time the colored solver against the serial one at 1k, 10k and 50k balls
+        app --bench-env [envs] [threads]        env steps per second of the training environment, whole shots and single frames
+        app --bench-scalar                      break shots per second of the physics kernels in float, double and fixed point
+        app --compare-scalar [shots]            play the same shots in float, double and fixed point and report how far they drift
+        app [--breaks file] --bench-matches [games] [threads]
+                                                full matches between scripted players, headless, with both engines,
+                                                the opening breaks taken from a break database
+        app [--table t] --build-breaks file [threads]
+                                                play every break of the default grid and write the break database
+        app --break-info file                   the best break of a break database and how fast it answers
+        app [--table t] [--breaks file] --heatmap png|raw prefix [games] [threads]
+                                                travel, rest and pocket heatmaps over headless matches
+        app [--table t] --calibrate tracks.csv out [threads]
+                                                fit friction and restitution to recorded ball tracks, written for --physics
+        app --physics file                      play with friction and restitution from a file instead of the table's
+        app --rewind [MB]                       keep a rewind history, Backspace to scrub it with the arrow keys
+        app --bench-rewind [games]              history memory, seek time and exact resume over headless matches
+        app [--table t] --serve-shots [port] [threads]
+                                                answer shot queries from other processes over loopback TCP (port 53100)
+        app [--table t] --bench-serve [threads] single-shot round trips to a local shot server, idle and under batch load
+        app --serve [port] [--rate hz] [--keyframe ticks] [--threshold q]
+                                                play and broadcast the table to spectators
+        app --record file                       play and record the match for replays
+        app --dynamic-resolution [min]          draw the table at a scale between min (0.5) and 1 that follows the frame times
+        app --latency                           log the aiming input-to-display latency every two seconds
+        app --alloc-check                       warn about every physics step that allocates, F3 shows the heap use per frame
+        app --pacing vsync|cap|uncapped [--frame-cap fps]
+                                                frame pacing, a precise cap at the table's frame rate by default
+        app --render file [--out pattern|-] [--size WxH] [--fps n] [--threads n]
+                                                render a recorded match to numbered images, or raw RGB24 on stdout with -
+        app --watch [host] [port]               watch a broadcasting table
+        app --log-level [category=]level        debug, info, warning, error or off, for one category
+                                                (setup, gameplay, physics, assets, network, render, timing) or all
+*/
+
+bool applyLogLevel(const std::string& option) {
+    std::size_t split = option.find('=');
+    LogLevel level;
+    if (!Logger::parseLevel(option.substr(split == std::string::npos ? 0 : split + 1), level)) return false;
+
+    if (split == std::string::npos) {
+        Logger::setLevel(level);
+        return true;
+    }
+    LogCategory category;
+    if (!Logger::parseCategory(option.substr(0, split), category)) return false;
+    Logger::setLevel(category, level);
+    return true;
+}
+
+int runSpectatorViewer(const std::string& host, unsigned short port) {
+    SpectatorViewer viewer;
+    if (!viewer.connect(host, port)) {
+        return 1;
+    }
+
+    while (viewer.running()) {
+        viewer.update();
+        viewer.render();
+    }
+    return 0;
+}
+
+// Same contacts solved serially, colored on one thread and colored on threadCount threads
+int runContactBenchmark(int threadCount) {
+    const int ballCounts[] = { 1000, 10000, 50000 };
+    const int repeats = 20;
+    const float reach = sandboxTable.ball_radius * 2 + 0.1f;
+
+    std::cout << "Contact solver benchmark, " << threadCount << " threads, " << repeats << " solves each" << std::endl;
+
+    for (int ballCount : ballCounts) {
+        RackOptions rackOptions;
+        rackOptions.ballCount = ballCount;
+        rackOptions.pattern = RackPattern::Hexagonal;
+        std::vector<sf::Vector2f> positions = generateRack(sandboxTable, rackOptions);
+
+        // A packed lattice where every ball moves, the worst case for the solver
+        BallPool ballPool(sandboxTable);
+        ballPool.reset(positions.size());
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> speed(-3.0f, 3.0f);
+        std::vector<sf::Vector2f> velocities;
+        for (const sf::Vector2f& position : positions) {
+            ballPool.spawn(position, sf::Color::White, BallType::Solid);
+            velocities.push_back(sf::Vector2f(speed(random), speed(random)));
+        }
+
+        std::vector<std::pair<int, int>> pairs;
+        for (int id : ballPool.getOnTable()) {
+            sf::Vector2f position = ballPool.get(id).getPosition();
+            ballPool.getGrid().forEachNear(position, reach, [&](int otherId) {
+                sf::Vector2f delta = ballPool.get(otherId).getPosition() - position;
+                if (otherId > id && delta.x * delta.x + delta.y * delta.y < reach * reach) {
+                    pairs.push_back(std::make_pair(id, otherId));
+                }
+            });
+        }
+
+        auto timeSolver = [&](bool graphColoring, int threads, std::vector<sf::Vector2f>& result, int& colors) {
+            ContactSolverSettings settings;
+            settings.graphColoring = graphColoring;
+            settings.threads = threads;
+            ContactSolver solver(settings);
+
+            sf::Int64 microseconds = 0;
+            for (int r = 0; r < repeats; ++r) {
+                for (std::size_t i = 0; i < positions.size(); ++i) {
+                    ballPool.get(static_cast<int>(i)).setPosition(positions[i]);
+                    ballPool.get(static_cast<int>(i)).velocity = velocities[i];
+                }
+                solver.clear();
+                for (const std::pair<int, int>& pair : pairs) {
+                    solver.addContact(pair.first, pair.second);
+                }
+
+                sf::Clock clock;
+                solver.solve<sandboxTable>(ballPool, sandboxTable.physics());
+                microseconds += clock.getElapsedTime().asMicroseconds();
+            }
+
+            result.clear();
+            for (std::size_t i = 0; i < positions.size(); ++i) {
+                result.push_back(ballPool.get(static_cast<int>(i)).getPosition());
+                result.push_back(ballPool.get(static_cast<int>(i)).velocity);
+            }
+            colors = solver.getStats().colors;
+            return microseconds / 1000.0 / repeats;
+        };
+
+        std::vector<sf::Vector2f> serialResult, singleResult, parallelResult;
+        int colors = 0;
+        double serialMs = timeSolver(false, 1, serialResult, colors);
+        double singleMs = timeSolver(true, 1, singleResult, colors);
+        double parallelMs = timeSolver(true, threadCount, parallelResult, colors);
+        bool identical = std::memcmp(singleResult.data(), parallelResult.data(), singleResult.size() * sizeof(sf::Vector2f)) == 0;
+
+        std::cout << "  balls: " << positions.size()
+                  << "  contacts: " << pairs.size()
+                  << "  colors: " << colors
+                  << "  serial: " << serialMs << " ms"
+                  << "  colored 1 thread: " << singleMs << " ms"
+                  << "  colored " << threadCount << " threads: " << parallelMs << " ms"
+                  << "  speedup: " << serialMs / parallelMs << "x"
+                  << "  identical: " << (identical ? "yes" : "NO") << std::endl;
+    }
+    return 0;
+}
+
+// A 16 ball break on the 9ft table, the cue ball aimed at the apex and turned by angle radians
+std::vector<sf::Vector2f> scalarShotRack(sf::Vector2f& cueVelocity, float angle, float speed) {
+    std::vector<sf::Vector2f> positions = generateRack(pool9ftTable, RackOptions());
+    sf::Vector2f aim = positions.front() - positions.back();
+    float baseAngle = std::atan2(aim.y, aim.x);
+    cueVelocity = speed * sf::Vector2f(std::cos(baseAngle + angle), std::sin(baseAngle + angle));
+    return positions;
+}
+
+template <typename Scalar>
+void timeScalarShots(const char* name, double seconds) {
+    sf::Vector2f cueVelocity;
+    std::vector<sf::Vector2f> positions = scalarShotRack(cueVelocity, 0.0f, 40.0f);
+    ScalarTable<Scalar> table(pool9ftTable);
+
+    long long shots = 0;
+    long long frames = 0;
+    sf::Clock clock;
+    while (clock.getElapsedTime().asSeconds() < seconds) {
+        table.rack(positions);
+        table.strike(cueVelocity);
+        while (table.isMoving() && table.getSteps() < 5000) {
+            table.step();
+        }
+        frames += table.getSteps();
+        ++shots;
+    }
+    double elapsed = clock.getElapsedTime().asSeconds();
+
+    std::cout << "  " << name << ":  " << shots / elapsed << " shots/s  "
+              << frames / elapsed << " frames/s  "
+              << elapsed * 1e9 / (frames * static_cast<double>(positions.size())) << " ns per ball and frame"
+              << "  (" << frames / shots << " frames per shot)" << std::endl;
+}
+
+int runScalarBenchmark() {
+    std::cout << "Scalar physics benchmark, 16 ball breaks on the 9ft table" << std::endl;
+    timeScalarShots<float>("float ", 2.0);
+    timeScalarShots<double>("double", 2.0);
+    timeScalarShots<Fixed>("fixed ", 2.0);
+    return 0;
+}
+
+// Plays every shot in the three types side by side, double is the reference
+int runScalarCrossCheck(int shotCount) {
+    struct Drift {
+        double maxDistance = 0.0;
+        long long firstPixel = -1; // First frame a ball is a whole pixel off, -1 when never
+        int pocketMismatches = 0;
+    };
+    struct Summary {
+        double maxDistance = 0.0;
+        int driftedShots = 0; // Shots where a ball ended up a pixel or more off at some point
+        int pocketMismatches = 0;
+    };
+    Summary floatSummary, fixedSummary;
+
+    std::cout << "Scalar cross-check, " << shotCount << " breaks, float and fixed point against double" << std::endl;
+
+    for (int shot = 0; shot < shotCount; ++shot) {
+        float angle = shotCount > 1 ? -0.05f + 0.1f * shot / (shotCount - 1) : 0.0f;
+        sf::Vector2f cueVelocity;
+        std::vector<sf::Vector2f> positions = scalarShotRack(cueVelocity, angle, 40.0f);
+
+        ScalarTable<float> floatTable(pool9ftTable);
+        ScalarTable<double> doubleTable(pool9ftTable);
+        ScalarTable<Fixed> fixedTable(pool9ftTable);
+        floatTable.rack(positions);
+        doubleTable.rack(positions);
+        fixedTable.rack(positions);
+        floatTable.strike(cueVelocity);
+        doubleTable.strike(cueVelocity);
+        fixedTable.strike(cueVelocity);
+
+        Drift shotFloat, shotFixed;
+        auto compare = [&](const auto& table, Drift& drift, bool final) {
+            for (int i = 0; i < doubleTable.getBallCount(); ++i) {
+                if (table.isPocketed(i) != doubleTable.isPocketed(i)) {
+                    if (final) ++drift.pocketMismatches;
+                    continue;
+                }
+                if (doubleTable.isPocketed(i)) continue;
+                double dx = static_cast<double>(table.getBall(i).position.x) - doubleTable.getBall(i).position.x;
+                double dy = static_cast<double>(table.getBall(i).position.y) - doubleTable.getBall(i).position.y;
+                double distance = std::sqrt(dx * dx + dy * dy);
+                drift.maxDistance = std::max(drift.maxDistance, distance);
+                if (distance >= 1.0 && drift.firstPixel < 0) drift.firstPixel = doubleTable.getSteps();
+            }
+        };
+
+        for (int frame = 0; frame < 5000 && (floatTable.isMoving() || doubleTable.isMoving() || fixedTable.isMoving()); ++frame) {
+            floatTable.step();
+            doubleTable.step();
+            fixedTable.step();
+            compare(floatTable, shotFloat, false);
+            compare(fixedTable, shotFixed, false);
+        }
+        compare(floatTable, shotFloat, true);
+        compare(fixedTable, shotFixed, true);
+
+        // The fixed point state as integers, equal on every machine that runs this shot
+        sf::Uint64 hash = 1469598103934665603ull;
+        for (int i = 0; i < fixedTable.getBallCount(); ++i) {
+            for (sf::Int64 raw : { fixedTable.getBall(i).position.x.getRaw(), fixedTable.getBall(i).position.y.getRaw() }) {
+                hash = (hash ^ static_cast<sf::Uint64>(raw)) * 1099511628211ull;
+            }
+        }
+
+        auto firstPixel = [](const Drift& drift) {
+            return drift.firstPixel < 0 ? std::string("never a pixel off") : "a pixel off at frame " + std::to_string(drift.firstPixel);
+        };
+        std::cout << "  shot " << shot << " (aim " << angle << " rad, " << doubleTable.getSteps() << " frames)"
+                  << "  float: " << shotFloat.maxDistance << " px max, " << firstPixel(shotFloat)
+                  << ", " << shotFloat.pocketMismatches << " pocket mismatches"
+                  << "  fixed: " << shotFixed.maxDistance << " px max, " << firstPixel(shotFixed)
+                  << ", " << shotFixed.pocketMismatches << " pocket mismatches"
+                  << "  fixed hash: " << std::hex << hash << std::dec << std::endl;
+
+        for (auto pair : { std::make_pair(&shotFloat, &floatSummary), std::make_pair(&shotFixed, &fixedSummary) }) {
+            pair.second->maxDistance = std::max(pair.second->maxDistance, pair.first->maxDistance);
+            pair.second->pocketMismatches += pair.first->pocketMismatches;
+            if (pair.first->firstPixel >= 0) ++pair.second->driftedShots;
+        }
+    }
+
+    std::cout << "  float: " << floatSummary.maxDistance << " px worst, " << floatSummary.driftedShots << " of " << shotCount
+              << " shots a pixel off, " << floatSummary.pocketMismatches << " pocket mismatches" << std::endl;
+    std::cout << "  fixed: " << fixedSummary.maxDistance << " px worst, " << fixedSummary.driftedShots << " of " << shotCount
+              << " shots a pixel off, " << fixedSummary.pocketMismatches << " pocket mismatches" << std::endl;
+    return 0;
+}
+
+// Random actions on a batch of 16 ball racks, once with whole shots per step and once with one frame per step
+int runEnvironmentBenchmark(int envCount, int threadCount) {
+    const double seconds = 2.0;
+    const int framesPerStep[] = { 0, 1 };
+
+    std::cout << "Training environment benchmark, " << envCount << " envs, " << threadCount << " threads" << std::endl;
+
+    for (int frames : framesPerStep) {
+        VectorEnvironmentSettings settings;
+        settings.envCount = envCount;
+        settings.threads = threadCount;
+        settings.framesPerStep = frames;
+        VectorEnvironment environment(settings);
+
+        std::vector<float> actions(envCount * 2);
+        std::vector<float> observations(static_cast<std::size_t>(envCount) * environment.observationSize());
+        std::vector<float> rewards(envCount);
+        std::vector<unsigned char> dones(envCount);
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+        std::uniform_real_distribution<float> power(10.0f, 100.0f);
+        environment.reset(observations.data());
+
+        long long steps = 0;
+        long long episodes = 0;
+        double totalReward = 0.0;
+        sf::Clock clock;
+        while (clock.getElapsedTime().asSeconds() < seconds) {
+            for (int i = 0; i < envCount; ++i) {
+                actions[2 * i] = angle(random);
+                actions[2 * i + 1] = power(random);
+            }
+            environment.step(actions.data(), observations.data(), rewards.data(), dones.data());
+            steps += envCount;
+            for (int i = 0; i < envCount; ++i) {
+                totalReward += rewards[i];
+                episodes += dones[i];
+            }
+        }
+        double elapsed = clock.getElapsedTime().asSeconds();
+
+        std::cout << "  " << (frames == 0 ? "whole shots:  " : "single frames:")
+                  << "  " << static_cast<long long>(steps / elapsed) << " steps/s"
+                  << "  episodes: " << episodes
+                  << "  mean reward: " << (steps > 0 ? totalReward / steps : 0.0) << std::endl;
+    }
+    return 0;
+}
+
+// Whole matches between two scripted players, every thread plays its own HeadlessMatch
+int runMatchBenchmark(int gameCount, int threadCount, const std::string& breaksPath) {
+    std::cout << "Headless match benchmark, " << gameCount << " matches per engine, " << threadCount << " threads" << std::endl;
+
+    BreakDatabase breaks;
+    if (!breaksPath.empty() && !breaks.open(breaksPath)) {
+        return 1;
+    }
+
+    for (bool analytic : { false, true }) {
+        struct Totals {
+            long long shots = 0;
+            long long work = 0;
+            int wins[3] = { 0, 0, 0 }; // Draws, player 1, player 2
+            int fouls = 0;
+            int unfinished = 0;
+            AllocationCounts allocations;
+        };
+        std::vector<Totals> totals(threadCount);
+        std::atomic<int> nextGame(0);
+
+        ScriptedPlayer first, second;
+        second.aimError = 0.03f; // The weaker player
+
+        WorkerPool workers(threadCount);
+        sf::Clock clock;
+        workers.run([&](int thread) {
+            RackOptions rackOptions;
+            HeadlessMatch headless(pool9ftTable, rackOptions, 1000u + static_cast<unsigned int>(thread), analytic);
+            headless.setBreakDatabase(&breaks);
+            Totals& sum = totals[thread];
+            AllocationCounts before = AllocationTracker::getThreadTotals();
+            while (nextGame++ < gameCount) {
+                MatchOutcome outcome = headless.play(first, second);
+                sum.shots += outcome.shots;
+                sum.work += outcome.work;
+                sum.fouls += outcome.fouls[0] + outcome.fouls[1];
+                if (outcome.finished) {
+                    ++sum.wins[outcome.winner];
+                } else {
+                    ++sum.unfinished;
+                }
+            }
+            sum.allocations = AllocationTracker::getThreadTotals() - before;
+        });
+        double elapsed = clock.getElapsedTime().asSeconds();
+
+        Totals sum;
+        for (const Totals& part : totals) {
+            sum.shots += part.shots;
+            sum.work += part.work;
+            sum.fouls += part.fouls;
+            sum.unfinished += part.unfinished;
+            sum.allocations += part.allocations;
+            for (int k = 0; k < 3; ++k) sum.wins[k] += part.wins[k];
+        }
+        std::cout << "  " << (analytic ? "analytic:" : "fixed:   ")
+                  << "  " << gameCount / elapsed << " matches/s  " << sum.shots / elapsed << " shots/s"
+                  << "  " << static_cast<double>(sum.shots) / gameCount << " shots and "
+                  << static_cast<double>(sum.fouls) / gameCount << " fouls per match"
+                  << "  " << static_cast<double>(sum.work) / std::max(1LL, sum.shots) << (analytic ? " events" : " frames") << " per shot"
+                  << "  wins " << sum.wins[1] << " : " << sum.wins[2] << ", " << sum.wins[0] << " draws, "
+                  << sum.unfinished << " unfinished"
+                  << "  " << static_cast<double>(sum.allocations.allocations) / std::max(1LL, sum.shots) << " allocations per shot" << std::endl;
+    }
+    return 0;
+}
+
+// Plays the matches twice, without and with the heatmaps, to report what accumulating costs
+int runHeatmap(const TableSpec& spec, bool png, const std::string& prefix, int gameCount, int threadCount, const std::string& breaksPath) {
+    BreakDatabase breaks;
+    if (!breaksPath.empty() && !breaks.open(breaksPath)) {
+        return 1;
+    }
+
+    ScriptedPlayer first, second;
+    second.aimError = 0.03f;
+    std::vector<HeatmapAccumulator> heatmaps(threadCount, HeatmapAccumulator(spec));
+    double seconds[2] = { 0.0, 0.0 };
+    long long frames[2] = { 0, 0 };
+
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<long long> work(threadCount, 0);
+        std::atomic<int> nextGame(0);
+        WorkerPool workers(threadCount);
+        sf::Clock clock;
+        workers.run([&](int thread) {
+            HeadlessMatch headless(spec, RackOptions(), 1000u + static_cast<unsigned int>(thread));
+            headless.setBreakDatabase(&breaks);
+            if (pass == 1) headless.setHeatmap(&heatmaps[thread]);
+            while (nextGame++ < gameCount) {
+                work[thread] += headless.play(first, second).work;
+            }
+        });
+        seconds[pass] = clock.getElapsedTime().asSeconds();
+        for (long long part : work) frames[pass] += part;
+    }
+
+    // The per-thread grids are only summed once every thread is done
+    for (int thread = 1; thread < threadCount; ++thread) {
+        heatmaps[0].merge(heatmaps[thread]);
+    }
+
+    double plain = seconds[0] / std::max(1LL, frames[0]) * 1e9;
+    double accumulating = seconds[1] / std::max(1LL, frames[1]) * 1e9;
+    std::cout << gameCount << " matches, " << heatmaps[0].getShotCount() << " shots, " << frames[1] << " steps on "
+              << threadCount << " threads" << std::endl;
+    std::cout << "  " << plain << " ns per step without heatmaps, " << accumulating << " ns with them ("
+              << (accumulating / plain - 1.0) * 100.0 << "%)" << std::endl;
+    return heatmaps[0].write(prefix, png) ? 0 : 1;
+}
+
+int runBreakInfo(const std::string& path) {
+    BreakDatabase breaks;
+    if (!breaks.open(path)) {
+        return 1;
+    }
+
+    const BreakGrid& grid = breaks.getGrid();
+    const BreakShot& best = breaks.getBestBreak();
+    std::cout << breaks.getTableName() << " table, " << breaks.getObjectBallCount() << " object balls, "
+              << breaks.getSampleCount() << " breaks (" << grid.columns << " x " << grid.rows << " placements, "
+              << grid.angles << " angles, " << grid.powers << " powers)" << std::endl;
+    std::cout << "  best break: cue ball at (" << best.placement.x << ", " << best.placement.y << "), angle "
+              << best.angle << " rad, power " << best.power << std::endl;
+    std::cout << "  " << best.prediction.expectedPocketed << " balls expected, "
+              << best.prediction.scratchChance * 100.0f << "% scratches, cue ball leaves around ("
+              << best.prediction.cueLeave.x << ", " << best.prediction.cueLeave.y << ")" << std::endl;
+
+    // Random shots inside the grid, the sum only keeps the queries from being optimized away
+    std::mt19937 random(7);
+    sf::FloatRect area = breaks.getPlacementArea();
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const int queries = 200000;
+    float sum = 0.0f;
+    sf::Clock clock;
+    for (int k = 0; k < queries; ++k) {
+        sf::Vector2f placement(area.left + area.width * unit(random), area.top + area.height * unit(random));
+        float angle = best.angle + grid.angleSpread * (unit(random) * 2.0f - 1.0f);
+        float power = grid.minPower + (grid.maxPower - grid.minPower) * unit(random);
+        sum += breaks.query(placement, angle, power).expectedPocketed;
+    }
+    double elapsed = clock.getElapsedTime().asSeconds();
+    std::cout << "  " << elapsed / queries * 1e9 << " ns per query (" << sum / queries << " balls on average)" << std::endl;
+    return 0;
+}
+
+int runCalibration(const TableSpec& spec, const std::string& tracksPath, const std::string& outPath, int threadCount) {
+    CalibrationSettings settings;
+    settings.threads = threadCount;
+    PhysicsCalibration calibration(spec, settings);
+    if (!calibration.loadTracks(tracksPath)) {
+        return 1;
+    }
+
+    CalibrationResult result = calibration.fit(spec.physics());
+    std::cout << calibration.getShotCount() << " shots, " << calibration.getSampleCount() << " samples on " << threadCount << " threads" << std::endl;
+    std::cout << "  RMS error " << result.initialError << " px with the " << spec.name << " defaults, " << result.error << " px fitted" << std::endl;
+    std::cout << "  friction " << result.physics.friction << ", restitution " << result.physics.restitution
+              << ", cushion restitution " << result.physics.cushionRestitution << ", min velocity " << result.physics.minVelocityThreshold << std::endl;
+    std::cout << "  " << result.evaluations << " evaluations (" << result.abandoned << " abandoned early), "
+              << result.frames << " steps in " << result.seconds << " s" << std::endl;
+    return PhysicsCalibration::saveParameters(outPath, result.physics) ? 0 : 1;
+}
+
+// Records headless matches, then times random seeks and checks that play resumed from a seek matches the record
+int runRewindBenchmark(int gameCount) {
+    const TableSpec& spec = pool9ftTable;
+    StateHistory history;
+    HeadlessMatch headless(spec, RackOptions(), 2024u);
+    headless.setStateHistory(&history);
+    ScriptedPlayer first, second;
+    second.aimError = 0.03f;
+
+    long long shots = 0, frames = 0;
+    sf::Clock clock;
+    for (int game = 0; game < gameCount; ++game) {
+        MatchOutcome outcome = headless.play(first, second);
+        shots += outcome.shots;
+        frames += outcome.work;
+    }
+    double recordSeconds = clock.getElapsedTime().asSeconds();
+
+    const long long firstTick = history.getFirstTick();
+    const long long lastTick = history.getLastTick();
+    const long long ticks = lastTick - firstTick + 1;
+    std::cout << gameCount << " matches, " << shots << " shots, " << frames << " steps recorded in " << recordSeconds << " s" << std::endl;
+    std::cout << "  the " << history.getCapacity() / 1024 << " KB history holds the last " << ticks << " ticks ("
+              << ticks / static_cast<double>(spec.frLimit) << " s of motion, " << history.getSegmentCount() << " segments), "
+              << static_cast<double>(history.getUsedBytes()) / std::max(1LL, ticks) << " bytes per tick" << std::endl;
+
+    Simulation simulation(spec);
+    Match match;
+    std::mt19937 random(11);
+    std::uniform_int_distribution<long long> anyTick(firstTick, lastTick);
+    const int seeks = 2000;
+    double worst = 0.0;
+    clock.restart();
+    for (int k = 0; k < seeks; ++k) {
+        sf::Clock one;
+        history.seek(anyTick(random), simulation, match);
+        worst = std::max(worst, static_cast<double>(one.getElapsedTime().asMicroseconds()));
+    }
+    double average = clock.getElapsedTime().asSeconds() / seeks * 1e6;
+    clock.restart();
+    for (long long tick = lastTick; tick > lastTick - 600 && tick >= firstTick; --tick) {
+        history.seek(tick, simulation, match);
+    }
+    double backwards = clock.getElapsedTime().asSeconds() / std::min(600LL, ticks) * 1e6;
+    std::cout << "  seek: " << average << " us on average and " << worst << " us at worst over " << seeks
+              << " random ticks, " << backwards << " us per tick scrubbing backwards" << std::endl;
+
+    // Step on from a seek and compare every following tick of the same shot, bit for bit
+    Simulation reference(spec);
+    Match referenceMatch;
+    int checked = 0, exact = 0;
+    for (int k = 0; k < 200; ++k) {
+        long long tick = anyTick(random);
+        history.seek(tick, simulation, match);
+        if (simulation.getBallPool().getAwake().empty()) continue; // Shot boundaries are not steps
+        bool same = true;
+        for (int step = 1; step <= 60 && tick + step <= lastTick && simulation.isMoving(); ++step) {
+            simulation.step();
+            history.seek(tick + step, reference, referenceMatch);
+            if (reference.getPhysicsStep() != simulation.getPhysicsStep()) break; // The shot ended
+            const BallPool& ours = simulation.getBallPool();
+            const BallPool& theirs = reference.getBallPool();
+            for (std::size_t id = 0; id < ours.size(); ++id) {
+                const Ball& a = ours.get(static_cast<int>(id));
+                const Ball& b = theirs.get(static_cast<int>(id));
+                same = same && a.getPosition() == b.getPosition() && a.getVelocity() == b.getVelocity() && a.pocketed == b.pocketed;
+            }
+        }
+        ++checked;
+        exact += same ? 1 : 0;
+    }
+    std::cout << "  resume: " << exact << " of " << checked << " seeks into a shot play on exactly as recorded" << std::endl;
+    return exact == checked ? 0 : 1;
+}
+
+// Answers shot queries from other processes until it is killed
+int runShotServer(const TableSpec& spec, unsigned short port, int threadCount) {
+    ShotServerSettings settings;
+    settings.port = port;
+    settings.threads = threadCount;
+    ShotServer server(spec, settings);
+    if (!server.start()) {
+        return 1;
+    }
+
+    sf::Uint64 reportedShots = 0;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+        ShotServerStats stats = server.getStats();
+        if (stats.shots == reportedShots) continue; // Quiet while nobody asks
+        reportedShots = stats.shots;
+        BILLIARD_LOG(Info, Network) << stats.requests << " requests, " << stats.shots << " shots, " << stats.rejected << " rejected, "
+                                    << stats.connections << " clients, queue " << stats.queueDepth << " (at most " << stats.maxQueueDepth
+                                    << "), latency p50 " << stats.latencyP50 << " us p99 " << stats.latencyP99 << " us, service p50 "
+                                    << stats.serviceP50 << " us p99 " << stats.serviceP99 << " us";
+    }
+}
+
+// Single-shot round trips through a local shot server, idle and next to clients pipelining batches
+int runShotServerBenchmark(const TableSpec& spec, int threadCount) {
+    ShotServerSettings settings;
+    settings.threads = threadCount;
+    ShotServer server(spec, settings);
+    if (!server.start()) {
+        return 1;
+    }
+
+    // Every query plays from the opening rack, the busiest table there is
+    ShotQuery single;
+    for (const sf::Vector2f& position : generateRack(spec, RackOptions())) {
+        ShotTableBall ball;
+        ball.position = position;
+        single.balls.push_back(ball);
+    }
+    std::mt19937 random(5);
+    auto randomStrike = [](std::mt19937& generator) {
+        std::uniform_real_distribution<float> anyAngle(-3.14159265f, 3.14159265f);
+        std::uniform_real_distribution<float> anyPower(20.0f, 100.0f);
+        float angle = anyAngle(generator);
+        return sf::Vector2f(std::cos(angle), std::sin(angle)) * anyPower(generator);
+    };
+    auto percentile = [](std::vector<double> samples, double fraction) {
+        if (samples.empty()) return 0.0;
+        std::sort(samples.begin(), samples.end());
+        return samples[std::min(samples.size() - 1, static_cast<std::size_t>(fraction * samples.size()))];
+    };
+
+    ShotClient client;
+    if (!client.connect(settings.port)) {
+        return 1;
+    }
+    ShotReply reply;
+    auto roundTrip = [&](sf::Uint32 requestId) {
+        single.requestId = requestId;
+        single.strikes.assign(1, randomStrike(random));
+        sf::Clock clock;
+        if (!client.send(single)) return -1.0;
+        while (client.receive(reply)) {
+            if (reply.type == ShotResultFrame && reply.requestId == requestId) return clock.getElapsedTime().asMicroseconds() / 1000.0;
+        }
+        return -1.0;
+    };
+
+    // The server must answer what a local simulation plays
+    Simulation local(spec);
+    std::vector<sf::Vector2f> rack;
+    for (const ShotTableBall& ball : single.balls) {
+        rack.push_back(ball.position);
+    }
+    int mismatches = 0;
+    std::vector<double> idle;
+    for (int k = 0; k < 2000; ++k) {
+        double milliseconds = roundTrip(static_cast<sf::Uint32>(k));
+        if (milliseconds < 0.0) {
+            std::cerr << "The shot server went away" << std::endl;
+            return 1;
+        }
+        idle.push_back(milliseconds);
+        if (k >= 100) continue;
+
+        local.rack(rack);
+        local.strike(single.strikes[0]);
+        for (int frame = 0; frame < settings.maxShotFrames && local.isMoving(); ++frame) {
+            local.step();
+        }
+        for (std::size_t id = 0; id < rack.size(); ++id) {
+            const Ball& ball = local.getBallPool().get(static_cast<int>(id));
+            if (ball.getPosition() != reply.outcome.balls[id].position || ball.pocketed == reply.outcome.balls[id].onTable) {
+                ++mismatches;
+                break;
+            }
+        }
+    }
+    std::cout << "Shot server, " << threadCount << " workers, " << rack.size() << " ball rack" << std::endl;
+    std::cout << "  idle: single-shot round trip p50 " << percentile(idle, 0.5) << " ms, p99 " << percentile(idle, 0.99)
+              << " ms, max " << percentile(idle, 1.0) << " ms over " << idle.size() << " queries, "
+              << 100 - mismatches << " of 100 checked against a local simulation" << std::endl;
+
+    // Batch clients pipeline all their requests at once and read the results as they stream in
+    const int batchClients = 4;
+    const int requestsPerClient = 16;
+    const int shotsPerRequest = 64;
+    std::atomic<int> batchesRunning(batchClients);
+    std::atomic<long long> batchShots(0);
+    std::vector<std::thread> batchThreads;
+    const ShotQuery batchTable = single;
+    sf::Clock loadClock;
+    for (int c = 0; c < batchClients; ++c) {
+        batchThreads.push_back(std::thread([&, c] {
+            ShotClient batchClient;
+            std::mt19937 generator(100 + c);
+            if (batchClient.connect(settings.port)) {
+                ShotQuery query = batchTable;
+                for (int request = 0; request < requestsPerClient; ++request) {
+                    query.requestId = static_cast<sf::Uint32>(request);
+                    query.strikes.clear();
+                    for (int shot = 0; shot < shotsPerRequest; ++shot) {
+                        query.strikes.push_back(randomStrike(generator));
+                    }
+                    batchClient.send(query);
+                }
+                ShotReply batchReply;
+                for (int received = 0; received < requestsPerClient * shotsPerRequest && batchClient.receive(batchReply); ) {
+                    if (batchReply.type != ShotResultFrame) continue;
+                    ++received;
+                    ++batchShots;
+                }
+            }
+            --batchesRunning;
+        }));
+    }
+    std::vector<double> loaded;
+    while (batchesRunning > 0) {
+        double milliseconds = roundTrip(static_cast<sf::Uint32>(100000 + loaded.size()));
+        if (milliseconds < 0.0) break;
+        loaded.push_back(milliseconds);
+    }
+    for (std::thread& thread : batchThreads) {
+        thread.join();
+    }
+    double loadSeconds = loadClock.getElapsedTime().asSeconds();
+    std::cout << "  loaded: " << batchClients << " clients pipelining " << requestsPerClient << " requests of " << shotsPerRequest
+              << " shots, " << batchShots / loadSeconds << " shots per second, single-shot round trip p50 " << percentile(loaded, 0.5)
+              << " ms, p99 " << percentile(loaded, 0.99) << " ms over " << loaded.size() << " queries" << std::endl;
+
+    client.requestStats(0);
+    while (client.receive(reply) && reply.type != ShotStatsFrame) {}
+    const ShotServerStats& stats = reply.stats;
+    std::cout << "  server: " << stats.requests << " requests, " << stats.shots << " shots, deepest queue " << stats.maxQueueDepth
+              << " shots, service p50 " << stats.serviceP50 << " us p99 " << stats.serviceP99 << " us, latency p99 "
+              << stats.latencyP99 << " us over the last " << settings.sampleWindow << " shots" << std::endl;
+
+    client.disconnect();
+    server.stop();
+    return mismatches == 0 ? 0 : 1;
+}
+
+int runReplayRender(const std::string& path, const ReplayRenderSettings& settings) {
+    // Raw frames own stdout, the log goes to stderr instead
+    if (settings.output == "-") {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    ReplayRenderer renderer;
+    if (!renderer.load(path)) {
+        return 1;
+    }
+    return renderer.render(settings) < 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+
+    const TableSpec* tableSpec = &pool9ftTable;
+    bool serve = false;
+    unsigned short servePort = spectatorDefaultPort;
+    float broadcastRate = 30.0f;
+    int keyframeInterval = 60;
+    int quantThreshold = 1;
+    RackOptions rackOptions;
+    bool tableChosen = false;
+    bool analyticEngine = false;
+    ContactSolverSettings solverSettings;
+    std::string recordPath;
+    bool latencyReport = false;
+    bool dynamicResolution = false;
+    DynamicResolutionSettings resolutionSettings;
+    FramePacerSettings pacing;
+    pacing.frameRate = 0; // The table's frame rate unless --frame-cap is given
+    std::string renderPath;
+    std::string breaksPath;
+    std::string physicsPath;
+    bool rewind = false;
+    StateHistorySettings rewindSettings;
+    ReplayRenderSettings renderSettings;
+    renderSettings.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+
+        if (arg == "--log-level" && hasValue) {
+            if (!applyLogLevel(argv[++i])) {
+                std::cerr << "Unknown log level, expected [category=]debug|info|warning|error|off" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--watch") {
+            std::string host = hasValue ? argv[++i] : "127.0.0.1";
+            unsigned short port = (i + 1 < argc && argv[i + 1][0] != '-') ? std::atoi(argv[++i]) : spectatorDefaultPort;
+            return runSpectatorViewer(host, port);
+        } else if (arg == "--table" && hasValue) {
+            tableSpec = findTableSpec(argv[++i]);
+            if (!tableSpec) {
+                std::cerr << "Unknown table, expected pool9ft, snooker or sandbox" << std::endl;
+                return 1;
+            }
+            tableChosen = true;
+        } else if (arg == "--sandbox" && hasValue) {
+            rackOptions.ballCount = std::max(1, std::atoi(argv[++i]));
+            if (!tableChosen) tableSpec = &sandboxTable;
+        } else if (arg == "--pattern" && hasValue) {
+            if (!parseRackPattern(argv[++i], rackOptions.pattern)) {
+                std::cerr << "Unknown pattern, expected triangle, diamond, hex or random" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--seed" && hasValue) {
+            rackOptions.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--engine" && hasValue) {
+            std::string engine = argv[++i];
+            if (engine != "fixed" && engine != "analytic") {
+                std::cerr << "Unknown engine, expected fixed or analytic" << std::endl;
+                return 1;
+            }
+            analyticEngine = engine == "analytic";
+        } else if (arg == "--iterations" && hasValue) {
+            solverSettings.maxIterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--no-warm-start") {
+            solverSettings.warmStart = false;
+        } else if (arg == "--threads" && hasValue) {
+            solverSettings.graphColoring = true;
+            solverSettings.threads = std::max(1, std::atoi(argv[++i]));
+            renderSettings.threads = solverSettings.threads;
+        } else if (arg == "--bench-contacts") {
+            int threads = hasValue ? std::max(1, std::atoi(argv[++i])) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            return runContactBenchmark(threads);
+        } else if (arg == "--bench-env") {
+            int envCount = hasValue ? std::max(1, std::atoi(argv[++i])) : 256;
+            bool hasThreads = i + 1 < argc && argv[i + 1][0] != '-';
+            int threads = hasThreads ? std::max(1, std::atoi(argv[++i])) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            return runEnvironmentBenchmark(envCount, threads);
+        } else if (arg == "--pacing" && hasValue) {
+            if (!FramePacer::parseMode(argv[++i], pacing.mode)) {
+                std::cerr << "Unknown pacing, expected vsync, cap or uncapped" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--frame-cap" && hasValue) {
+            pacing.frameRate = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--dynamic-resolution") {
+            dynamicResolution = true;
+            if (hasValue) resolutionSettings.minScale = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--latency") {
+            latencyReport = true;
+        } else if (arg == "--alloc-check") {
+            AllocationTracker::setStepCheck(true);
+        } else if (arg == "--bench-matches") {
+            int games = hasValue ? std::max(1, std::atoi(argv[++i])) : 200;
+            bool hasThreads = i + 1 < argc && argv[i + 1][0] != '-';
+            int threads = hasThreads ? std::max(1, std::atoi(argv[++i])) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            return runMatchBenchmark(games, threads, breaksPath);
+        } else if (arg == "--breaks" && hasValue) {
+            breaksPath = argv[++i];
+        } else if (arg == "--build-breaks" && hasValue) {
+            std::string path = argv[++i];
+            bool hasThreads = i + 1 < argc && argv[i + 1][0] != '-';
+            int threads = hasThreads ? std::max(1, std::atoi(argv[++i])) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            return BreakDatabase::generate(*tableSpec, BreakGrid(), threads, path) ? 0 : 1;
+        } else if (arg == "--heatmap" && i + 2 < argc) {
+            std::string format = argv[++i];
+            if (format != "png" && format != "raw") {
+                std::cerr << "Unknown heatmap format, expected png or raw" << std::endl;
+                return 1;
+            }
+            std::string prefix = argv[++i];
+            int games = i + 1 < argc && argv[i + 1][0] != '-' ? std::max(1, std::atoi(argv[++i])) : 100;
+            bool hasThreads = i + 1 < argc && argv[i + 1][0] != '-';
+            int threads = hasThreads ? std::max(1, std::atoi(argv[++i])) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            return runHeatmap(*tableSpec, format == "png", prefix, games, threads, breaksPath);
+        } else if (arg == "--calibrate" && i + 2 < argc) {
+            std::string tracksPath = argv[++i];
+            std::string outPath = argv[++i];
+            bool hasThreads = i + 1 < argc && argv[i + 1][0] != '-';
+            int threads = hasThreads ? std::max(1, std::atoi(argv[++i])) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            return runCalibration(*tableSpec, tracksPath, outPath, threads);
+        } else if (arg == "--serve-shots") {
+            unsigned short port = hasValue ? static_cast<unsigned short>(std::atoi(argv[++i])) : shotServerDefaultPort;
+            bool hasThreads = i + 1 < argc && argv[i + 1][0] != '-';
+            int threads = hasThreads ? std::max(1, std::atoi(argv[++i])) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            return runShotServer(*tableSpec, port, threads);
+        } else if (arg == "--bench-serve") {
+            int threads = hasValue ? std::max(1, std::atoi(argv[++i])) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            return runShotServerBenchmark(*tableSpec, threads);
+        } else if (arg == "--bench-rewind") {
+            return runRewindBenchmark(hasValue ? std::max(1, std::atoi(argv[++i])) : 20);
+        } else if (arg == "--rewind") {
+            rewind = true;
+            if (hasValue) rewindSettings.memoryBytes = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i]))) << 20;
+        } else if (arg == "--physics" && hasValue) {
+            physicsPath = argv[++i];
+        } else if (arg == "--break-info" && hasValue) {
+            return runBreakInfo(argv[++i]);
+        } else if (arg == "--bench-scalar") {
+            return runScalarBenchmark();
+        } else if (arg == "--compare-scalar") {
+            return runScalarCrossCheck(hasValue ? std::max(1, std::atoi(argv[++i])) : 8);
+        } else if (arg == "--record" && hasValue) {
+            recordPath = argv[++i];
+        } else if (arg == "--render" && hasValue) {
+            renderPath = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            renderSettings.output = argv[++i];
+        } else if (arg == "--size" && hasValue) {
+            unsigned int width = 0, height = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                std::cerr << "Expected the size as WxH, for example 1920x1080" << std::endl;
+                return 1;
+            }
+            renderSettings.width = width;
+            renderSettings.height = height;
+        } else if (arg == "--fps" && hasValue) {
+            renderSettings.frameRate = std::max(1.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--serve") {
+            serve = true;
+            if (hasValue) servePort = std::atoi(argv[++i]);
+        } else if (arg == "--rate" && hasValue) {
+            broadcastRate = std::atof(argv[++i]);
+        } else if (arg == "--keyframe" && hasValue) {
+            keyframeInterval = std::atoi(argv[++i]);
+        } else if (arg == "--threshold" && hasValue) {
+            quantThreshold = std::atoi(argv[++i]);
+        }
+    }
+
+    if (!renderPath.empty()) {
+        return runReplayRender(renderPath, renderSettings);
+    }
 
     std::cout << "Program start" << std::endl;
+
     // Initialize Game
-    Game game;
+    Game game(*tableSpec, rackOptions);
+    game.setContactSolverSettings(solverSettings);
+
+    if (!physicsPath.empty()) {
+        PhysicsParameters physics = tableSpec->physics();
+        if (!PhysicsCalibration::loadParameters(physicsPath, physics)) {
+            return 1;
+        }
+        game.setPhysics(physics);
+    }
+
+    if (!recordPath.empty()) {
+        game.enableMatchRecorder(recordPath, keyframeInterval);
+    }
+
+    if (analyticEngine) {
+        game.enableAnalyticEngine();
+    }
+
+    if (rewind) {
+        game.enableRewind(rewindSettings);
+    }
+
+    if (pacing.frameRate == 0) pacing.frameRate = tableSpec->frLimit;
+    game.setFramePacing(pacing);
+
+    if (dynamicResolution) {
+        game.enableDynamicResolution(resolutionSettings);
+    }
+
+    if (latencyReport) {
+        game.enableLatencyReport();
+    }
+
+    if (serve) {
+        game.enableSpectatorServer(servePort, broadcastRate, keyframeInterval, quantThreshold);
+    }
     
     std::cout << "Game Calling start" << std::endl;
 
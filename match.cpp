@@ -0,0 +1,338 @@
+#include "match.h"
+#include "simulation.h"
+#include "event_engine.h"
+#include "break_database.h"
+#include "heatmap.h"
+#include "state_history.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* === Match Class Definition STARTS HERE === */
+
+Match::Match(int objectBalls) {
+    this->reset(objectBalls);
+}
+
+void Match::reset(int objectBalls) {
+    objectBallsLeft = std::max(0, objectBalls);
+    phase = objectBallsLeft > 0 ? MatchPhase::AwaitingShot : MatchPhase::Over;
+    playerTurn = 1;
+    playerScores[0] = playerScores[1] = 0;
+    playerFouls[0] = playerFouls[1] = 0;
+    ballInHand = false;
+    shots = 0;
+    currentShot = ShotOutcome();
+}
+
+bool Match::beginShot() {
+    if (phase != MatchPhase::AwaitingShot) return false;
+
+    phase = MatchPhase::ShotInProgress;
+    ballInHand = false; // Wherever the cue ball is now, it is played from there
+    currentShot = ShotOutcome();
+    currentShot.shooter = playerTurn;
+    ++shots;
+    return true;
+}
+
+void Match::objectBallPocketed() {
+    if (objectBallsLeft == 0) return;
+
+    --objectBallsLeft;
+    ++playerScores[playerTurn - 1];
+    ++currentShot.pocketed;
+}
+
+void Match::cueBallPocketed() {
+    currentShot.foul = true;
+}
+
+ShotOutcome Match::endShot() {
+    if (phase != MatchPhase::ShotInProgress) return ShotOutcome();
+
+    ShotOutcome outcome = currentShot;
+    if (outcome.foul) {
+        ++playerFouls[playerTurn - 1];
+        ballInHand = true;
+    }
+
+    // Scoring keeps the table, a foul or a miss hands it over
+    outcome.turnKept = !outcome.foul && outcome.pocketed > 0;
+    if (!outcome.turnKept) {
+        playerTurn = (playerTurn % 2) + 1;
+    }
+
+    phase = objectBallsLeft > 0 ? MatchPhase::AwaitingShot : MatchPhase::Over;
+    return outcome;
+}
+
+bool Match::operator==(const Match& other) const {
+    return phase == other.phase && playerTurn == other.playerTurn &&
+           playerScores[0] == other.playerScores[0] && playerScores[1] == other.playerScores[1] &&
+           playerFouls[0] == other.playerFouls[0] && playerFouls[1] == other.playerFouls[1] &&
+           objectBallsLeft == other.objectBallsLeft && ballInHand == other.ballInHand && shots == other.shots &&
+           currentShot.shooter == other.currentShot.shooter && currentShot.pocketed == other.currentShot.pocketed &&
+           currentShot.foul == other.currentShot.foul && currentShot.turnKept == other.currentShot.turnKept;
+}
+
+// Getter Functions
+
+MatchPhase Match::getPhase() const {
+    return phase;
+}
+
+bool Match::isOver() const {
+    return phase == MatchPhase::Over;
+}
+
+int Match::getPlayerTurn() const {
+    return playerTurn;
+}
+
+int Match::getScore(int player) const {
+    return playerScores[player - 1];
+}
+
+int Match::getFouls(int player) const {
+    return playerFouls[player - 1];
+}
+
+int Match::getObjectBallsLeft() const {
+    return objectBallsLeft;
+}
+
+int Match::getWinner() const {
+    if (phase != MatchPhase::Over || playerScores[0] == playerScores[1]) return 0;
+    return playerScores[0] > playerScores[1] ? 1 : 2;
+}
+
+bool Match::hasBallInHand() const {
+    return ballInHand;
+}
+
+int Match::getShotCount() const {
+    return shots;
+}
+
+
+/* === HeadlessMatch Class Definition STARTS HERE === */
+
+HeadlessMatch::HeadlessMatch(const TableSpec& spec, const RackOptions& rackOptions, unsigned int seed, bool analytic)
+    : spec(spec), simulation(new Simulation(spec)), eventEngine(nullptr), breaks(nullptr), heatmap(nullptr), history(nullptr), random(seed), maxShots(1000), maxShotFrames(5000) {
+    rackPositions = generateRack(spec, rackOptions);
+
+    // Aiming at a corner hole itself runs the ball into the jaw, aim at the mouth in front of it instead
+    const float captureRadius = (spec.hole_radius + spec.ball_radius) * spec.hole_capture_factor;
+    const sf::Vector2f low = spec.table_offset() + sf::Vector2f(1.f, 1.f);
+    const sf::Vector2f high = spec.table_offset() + spec.table_dimension() - sf::Vector2f(1.f, 1.f);
+    for (sf::Vector2f hole : simulation->getHolePositions()) {
+        sf::Vector2f inward(std::max(low.x, std::min(high.x, hole.x)) - hole.x, std::max(low.y, std::min(high.y, hole.y)) - hole.y);
+        float length = std::sqrt(inward.x * inward.x + inward.y * inward.y);
+        if (length > 0.0f) hole += inward / length * (captureRadius + spec.ball_radius * 0.5f);
+        pocketTargets.push_back(hole);
+    }
+
+    if (analytic) {
+        eventEngine = new EventEngine(spec, simulation->getTable(), simulation->getHolePositions());
+    }
+}
+
+HeadlessMatch::~HeadlessMatch() {
+    delete eventEngine;
+    delete simulation;
+}
+
+bool HeadlessMatch::isPathClear(sf::Vector2f from, sf::Vector2f to, int ignoredFirst, int ignoredSecond) const {
+    const BallPool& ballPool = simulation->getBallPool();
+    sf::Vector2f path = to - from;
+    float lengthSquared = path.x * path.x + path.y * path.y;
+    const float clearance = spec.ball_radius * 2;
+
+    for (int id : ballPool.getOnTable()) {
+        if (id == ignoredFirst || id == ignoredSecond) continue;
+        sf::Vector2f offset = ballPool.get(id).getPosition() - from;
+        float t = lengthSquared > 0.0f ? std::max(0.0f, std::min(1.0f, (offset.x * path.x + offset.y * path.y) / lengthSquared)) : 0.0f;
+        sf::Vector2f gap = offset - path * t;
+        if (gap.x * gap.x + gap.y * gap.y < clearance * clearance) return false;
+    }
+    return true;
+}
+
+sf::Vector2f HeadlessMatch::chooseShot(const ScriptedPlayer& player) {
+    const BallPool& ballPool = simulation->getBallPool();
+    const int cueId = simulation->getCueBallId();
+    const sf::Vector2f cue = ballPool.get(cueId).getPosition();
+
+    // Ghost ball aiming: the cue ball has to arrive one diameter behind the object ball, on
+    // the line to the pocket. The smaller the cut angle, the more likely the pot.
+    float bestCut = -4.0f; // Cosine of the cut angle, 2 lower for blocked shots
+    sf::Vector2f bestAim(1.f, 0.f);
+    float bestDistance = 0.0f;
+    for (int id : ballPool.getOnTable()) {
+        if (id == cueId) continue;
+        sf::Vector2f ball = ballPool.get(id).getPosition();
+
+        for (sf::Vector2f pocket : pocketTargets) {
+            sf::Vector2f toPocket = pocket - ball;
+            float pocketDistance = std::sqrt(toPocket.x * toPocket.x + toPocket.y * toPocket.y);
+            if (pocketDistance < 1e-3f) continue;
+            sf::Vector2f line = toPocket / pocketDistance;
+
+            sf::Vector2f aim = ball - line * (spec.ball_radius * 2) - cue;
+            float aimDistance = std::sqrt(aim.x * aim.x + aim.y * aim.y);
+            if (aimDistance < 1e-3f) continue;
+
+            // A blocked path only counts when nothing else is open
+            float cut = (aim.x * line.x + aim.y * line.y) / aimDistance;
+            if (!this->isPathClear(cue, cue + aim, cueId, id) || !this->isPathClear(ball, pocket, cueId, id)) {
+                cut -= 2.0f;
+            }
+            if (cut > bestCut) {
+                bestCut = cut;
+                bestAim = aim;
+                bestDistance = aimDistance + pocketDistance;
+            }
+        }
+    }
+
+    std::normal_distribution<float> aimError(0.0f, player.aimError);
+    float angle = std::atan2(bestAim.y, bestAim.x) + aimError(random);
+
+    sf::Vector2f diagonal = spec.table_dimension();
+    float reach = std::min(1.0f, bestDistance / std::sqrt(diagonal.x * diagonal.x + diagonal.y * diagonal.y));
+    float power = player.minPower + (player.maxPower - player.minPower) * reach;
+    return sf::Vector2f(std::cos(angle), std::sin(angle)) * power;
+}
+
+sf::Vector2f HeadlessMatch::chooseBreak(const ScriptedPlayer& player) {
+    const BreakShot& best = breaks->getBestBreak();
+    BallPool& ballPool = simulation->getBallPool();
+    Ball& cueBall = ballPool.get(simulation->getCueBallId());
+    cueBall.setPosition(best.placement);
+    ballPool.rebin(cueBall.id);
+
+    // The player still misses the line by as much as on any other shot
+    std::normal_distribution<float> aimError(0.0f, player.aimError);
+    float angle = best.angle + aimError(random);
+    return sf::Vector2f(std::cos(angle), std::sin(angle)) * best.power;
+}
+
+long long HeadlessMatch::playShot(sf::Vector2f strike) {
+    simulation->strike(strike);
+
+    long long frames = 0;
+    while (simulation->isMoving()) {
+        simulation->step();
+        ++frames;
+        if (heatmap) heatmap->step(*simulation);
+
+        for (const PocketEvent& event : simulation->getPocketEvents()) {
+            if (event.ballId == simulation->getCueBallId()) {
+                match.cueBallPocketed();
+            } else {
+                match.objectBallPocketed();
+            }
+        }
+
+        // A shot that never settles (balls trapped against each other) is called off
+        if (frames >= maxShotFrames) simulation->callOff();
+        if (history) history->record(*simulation, match);
+    }
+    return frames;
+}
+
+long long HeadlessMatch::playAnalyticShot(sf::Vector2f strike) {
+    BallPool& ballPool = simulation->getBallPool();
+    const int cueId = simulation->getCueBallId();
+
+    eventEngine->clear();
+    engineBallIds.clear();
+    int cueIndex = -1;
+    for (int id : ballPool.getOnTable()) {
+        if (id == cueId) cueIndex = static_cast<int>(engineBallIds.size());
+        eventEngine->addBall(ballPool.get(id).getPosition());
+        engineBallIds.push_back(id);
+    }
+    if (cueIndex < 0) return 0;
+
+    eventEngine->strike(cueIndex, strike * static_cast<float>(spec.frLimit), sf::Vector2f(0.f, 0.f)); // px/frame to px/s
+    double end = eventEngine->simulate();
+
+    const std::vector<EngineEvent>& events = eventEngine->getEvents();
+    for (const EngineEvent& event : events) {
+        if (event.type != EngineEventType::Pocket) continue;
+
+        int id = engineBallIds[event.ball];
+        if (heatmap) heatmap->ballPocketed(id, event.other);
+        if (id == cueId) {
+            match.cueBallPocketed();
+        } else {
+            match.objectBallPocketed();
+        }
+        simulation->pocket(id);
+    }
+
+    // Only where the balls came to rest matters, the frames in between are never drawn
+    for (std::size_t i = 0; i < engineBallIds.size(); ++i) {
+        Ball& ball = ballPool.get(engineBallIds[i]);
+        if (ball.pocketed || eventEngine->isPocketedAt(static_cast<int>(i), end)) continue;
+
+        ball.setPosition(eventEngine->samplePosition(static_cast<int>(i), end));
+        ballPool.rebin(ball.id);
+    }
+    return static_cast<long long>(events.size());
+}
+
+MatchOutcome HeadlessMatch::play(const ScriptedPlayer& first, const ScriptedPlayer& second) {
+    simulation->rack(rackPositions);
+    match.reset(static_cast<int>(rackPositions.size()) - 1);
+
+    MatchOutcome outcome;
+    const ScriptedPlayer* players[2] = { &first, &second };
+    while (!match.isOver() && match.getShotCount() < maxShots) {
+        const ScriptedPlayer& player = *players[match.getPlayerTurn() - 1];
+        bool openingBreak = match.getShotCount() == 0 && breaks && breaks->isOpen() && breaks->getTableName() == spec.name;
+        sf::Vector2f strike = openingBreak ? this->chooseBreak(player) : this->chooseShot(player);
+        match.beginShot();
+        if (heatmap) heatmap->beginShot(*simulation);
+        outcome.work += eventEngine ? this->playAnalyticShot(strike) : this->playShot(strike);
+        if (heatmap) heatmap->endShot(*simulation);
+        match.endShot();
+        if (history) history->record(*simulation, match);
+    }
+
+    outcome.finished = match.isOver();
+    outcome.winner = match.getWinner();
+    for (int player = 1; player <= 2; ++player) {
+        outcome.scores[player - 1] = match.getScore(player);
+        outcome.fouls[player - 1] = match.getFouls(player);
+    }
+    outcome.shots = match.getShotCount();
+    return outcome;
+}
+
+// Getter Functions
+
+const Match& HeadlessMatch::getMatch() const {
+    return match;
+}
+
+// Setter Functions
+
+void HeadlessMatch::setLimits(int maxShots, int maxShotFrames) {
+    this->maxShots = std::max(1, maxShots);
+    this->maxShotFrames = std::max(1, maxShotFrames);
+}
+
+void HeadlessMatch::setBreakDatabase(const BreakDatabase* breaks) {
+    this->breaks = breaks;
+}
+
+void HeadlessMatch::setHeatmap(HeatmapAccumulator* heatmap) {
+    this->heatmap = heatmap;
+}
+
+void HeadlessMatch::setStateHistory(StateHistory* history) {
+    this->history = history;
+}
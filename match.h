@@ -0,0 +1,139 @@
+#pragma once
+
+#include <SFML\System.hpp>
+#include <random>
+#include <vector>
+
+#include "table_spec.h"
+#include "rack.h"
+
+class Simulation;
+class EventEngine;
+class BreakDatabase;
+class HeatmapAccumulator;
+class StateHistory;
+
+
+/*
+    Match Rules
+
+    The turn and scoring rules of a two player match as a state machine of its own, driven
+    only by shots and pocketings. Every Game holds one and feeds it from the window, and
+    HeadlessMatch plays whole matches between scripted players on a Simulation without any
+    window, so any number of matches can run in one process.
+
+    The rules are the ones the game has always played:
+      - every object ball pocketed scores a point for the shooter, the black one included
+      - a shooter who scores keeps the table, otherwise the turn passes
+      - pocketing the cue ball is a foul: the turn passes whatever else went down and the
+        next player has ball in hand (the cue ball is back on its spot and may be moved)
+      - the match is over once every object ball is off the table, the higher score wins
+
+    A shot runs from beginShot() to endShot(), which the caller makes once every ball rests.
+*/
+
+enum class MatchPhase {
+    AwaitingShot,
+    ShotInProgress,
+    Over
+};
+
+struct ShotOutcome {
+    int shooter = 0;  // 1 or 2
+    int pocketed = 0; // Object balls
+    bool foul = false;
+    bool turnKept = false;
+};
+
+class Match {
+private:
+    MatchPhase phase;
+    int playerTurn; // 1 or 2
+    int playerScores[2];
+    int playerFouls[2];
+    int objectBallsLeft;
+    bool ballInHand;
+    int shots;
+    ShotOutcome currentShot;
+
+public:
+    explicit Match(int objectBalls = 15);
+
+    void reset(int objectBalls);
+    bool beginShot(); // False while a shot runs or after the match is over
+    void objectBallPocketed();
+    void cueBallPocketed();
+    ShotOutcome endShot(); // Applies the turn rules to the shot that just came to rest
+    bool operator==(const Match& other) const;
+
+    // Getter Functions
+    MatchPhase getPhase() const;
+    bool isOver() const;
+    int getPlayerTurn() const;
+    int getScore(int player) const; // Players are 1 and 2
+    int getFouls(int player) const;
+    int getObjectBallsLeft() const;
+    int getWinner() const; // 1 or 2 once the match is over, 0 for a draw or while it runs
+    bool hasBallInHand() const;
+    int getShotCount() const;
+};
+
+
+/* ------ Headless Matches Between Scripted Players ------ */
+
+// Aims at the object ball with the straightest cut into a pocket, power grows with the distance
+struct ScriptedPlayer {
+    float minPower = 25.0f; // 0 - 100, like the cue stick
+    float maxPower = 45.0f;
+    float aimError = 0.01f; // Standard deviation of the aim, radians
+};
+
+struct MatchOutcome {
+    int winner = 0; // 1 or 2, 0 for a draw or an unfinished match
+    int scores[2] = { 0, 0 };
+    int fouls[2] = { 0, 0 };
+    int shots = 0;
+    long long work = 0;    // Physics frames, or engine events with the analytic engine
+    bool finished = false; // False when maxShots ran out first
+};
+
+class HeadlessMatch {
+private:
+    const TableSpec& spec;
+    Simulation* simulation;
+    EventEngine* eventEngine; // Optional, shots are solved analytically instead of frame by frame
+    const BreakDatabase* breaks; // Optional, the opening shot is the best break it knows for the table
+    HeatmapAccumulator* heatmap; // Optional, fed every step of every shot
+    StateHistory* history;       // Optional, records every step of the fixed-step shots
+    Match match;
+    std::vector<sf::Vector2f> rackPositions;
+    std::vector<sf::Vector2f> pocketTargets; // Where the scripted players aim, just in front of each hole
+    std::vector<int> engineBallIds; // Pool id of every engine ball
+    std::mt19937 random;
+    int maxShots;
+    int maxShotFrames;
+
+    bool isPathClear(sf::Vector2f from, sf::Vector2f to, int ignoredFirst, int ignoredSecond) const;
+    sf::Vector2f chooseShot(const ScriptedPlayer& player); // Strike in Simulation::strike units
+    sf::Vector2f chooseBreak(const ScriptedPlayer& player); // Also places the cue ball
+    long long playShot(sf::Vector2f strike);
+    long long playAnalyticShot(sf::Vector2f strike);
+
+public:
+    HeadlessMatch(const TableSpec& spec, const RackOptions& rackOptions, unsigned int seed, bool analytic = false);
+    ~HeadlessMatch();
+    HeadlessMatch(const HeadlessMatch&) = delete;
+    HeadlessMatch& operator=(const HeadlessMatch&) = delete;
+
+    // Racks again and plays to the end, the first player breaks
+    MatchOutcome play(const ScriptedPlayer& first, const ScriptedPlayer& second);
+
+    // Getter Functions
+    const Match& getMatch() const;
+
+    // Setter Functions
+    void setLimits(int maxShots, int maxShotFrames);
+    void setBreakDatabase(const BreakDatabase* breaks); // Not owned, nullptr breaks from the cue spot
+    void setHeatmap(HeatmapAccumulator* heatmap);       // Not owned, nullptr stops accumulating
+    void setStateHistory(StateHistory* history);        // Not owned, nullptr stops recording
+};
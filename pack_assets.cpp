@@ -0,0 +1,27 @@
+#include <iostream>
+#include <string>
+#include "asset_bundle.h"
+
+/*
+    Usage:
+        pack_assets [output] [root]    pack the game assets under root (default .) into output (default assets.pack)
+*/
+
+int main(int argc, char* argv[]) {
+    std::string output = argc > 1 ? argv[1] : GameAssets::bundlePath;
+    std::string root = argc > 2 ? argv[2] : ".";
+
+    if (!AssetBundle::pack(root, GameAssets::getAssetNames(), output)) {
+        return 1;
+    }
+
+    AssetBundle bundle;
+    if (!bundle.open(output)) {
+        std::cerr << "The written bundle does not read back" << std::endl;
+        return 1;
+    }
+    for (const std::string& name : GameAssets::getAssetNames()) {
+        std::cout << "  " << name << ": " << bundle.find(name).size << " bytes" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include "rack.h"
+#include "logger.h"
+#include "spatial_grid.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+
+/* === Rack Generator Definition STARTS HERE === */
+
+namespace {
+
+struct PlayArea {
+    float left, top, right, bottom;
+    sf::Vector2f footSpot;
+    sf::Vector2f headSpot;
+};
+
+// Where ball centers may go without starting inside a cushion or a pocket's capture region
+PlayArea getPlayArea(const TableSpec& spec) {
+    float inset = spec.hole_radius + spec.ball_radius;
+    sf::Vector2f offset = spec.table_offset();
+
+    PlayArea area;
+    area.left = offset.x + inset;
+    area.top = offset.y + inset;
+    area.right = offset.x + spec.table_width - inset;
+    area.bottom = offset.y + spec.table_height - inset;
+    area.footSpot = sf::Vector2f(offset.x + spec.table_width * 3 / 4, offset.y + spec.table_height / 2);
+    area.headSpot = sf::Vector2f(offset.x + spec.table_width / 4, offset.y + spec.table_height / 2);
+    return area;
+}
+
+// Rows of balls growing away from the apex, each row centered on the long axis
+std::vector<sf::Vector2f> layoutRows(const std::vector<int>& rowSizes, float ballRadius, const PlayArea& area) {
+    std::vector<sf::Vector2f> positions;
+    if (rowSizes.empty()) return positions;
+
+    int widestRow = *std::max_element(rowSizes.begin(), rowSizes.end());
+    float depth = 2 * ballRadius * (rowSizes.size() - 1);
+    float span = 2 * ballRadius * (widestRow - 1);
+
+    // Keep the apex on the foot spot unless the last row would cross the foot cushion
+    float apexX = std::min(area.footSpot.x, area.right - depth);
+    if (apexX < area.headSpot.x + 4 * ballRadius || span > area.bottom - area.top) {
+        BILLIARD_LOG(Warning, Setup) << "Rack with " << rowSizes.size() << " rows does not fit the table.";
+        return positions;
+    }
+
+    for (std::size_t i = 0; i < rowSizes.size(); ++i) {
+        float rowX = apexX + 2 * ballRadius * i;
+        for (int j = 0; j < rowSizes[i]; ++j) {
+            float verticalOffset = (j - (rowSizes[i] - 1) / 2.0f) * 2 * ballRadius; // Center the balls in the row
+            positions.emplace_back(rowX, area.footSpot.y + verticalOffset);
+        }
+    }
+    return positions;
+}
+
+std::vector<sf::Vector2f> generateTriangle(int objectCount, float ballRadius, const PlayArea& area) {
+    std::vector<int> rowSizes;
+    for (int placed = 0, row = 1; placed < objectCount; placed += row, ++row) {
+        rowSizes.push_back(std::min(row, objectCount - placed));
+    }
+    return layoutRows(rowSizes, ballRadius, area);
+}
+
+std::vector<sf::Vector2f> generateDiamond(int objectCount, float ballRadius, const PlayArea& area) {
+    int widest = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(objectCount))));
+    std::vector<int> rowSizes;
+    int placed = 0;
+    for (int row = 1; row < 2 * widest && placed < objectCount; ++row) {
+        int size = row <= widest ? row : 2 * widest - row;
+        size = std::min(size, objectCount - placed);
+        rowSizes.push_back(size);
+        placed += size;
+    }
+    return layoutRows(rowSizes, ballRadius, area);
+}
+
+std::vector<sf::Vector2f> generateHexagonal(int objectCount, float ballRadius, const PlayArea& area) {
+    float spacing = 2 * ballRadius;
+    float rowHeight = std::sqrt(3.0f) * ballRadius;
+    float cueClearance = 2 * spacing;
+
+    // Every lattice site of the bed, then the ones closest to the foot spot win
+    std::vector<sf::Vector2f> sites;
+    int row = 0;
+    for (float y = area.top; y <= area.bottom; y += rowHeight, ++row) {
+        float startX = area.left + (row % 2 == 0 ? 0.0f : ballRadius);
+        for (float x = startX; x <= area.right; x += spacing) {
+            float dx = x - area.headSpot.x;
+            float dy = y - area.headSpot.y;
+            if (dx * dx + dy * dy >= cueClearance * cueClearance) {
+                sites.emplace_back(x, y);
+            }
+        }
+    }
+
+    std::size_t count = std::min<std::size_t>(objectCount, sites.size());
+    auto closerToFootSpot = [&area](const sf::Vector2f& a, const sf::Vector2f& b) {
+        float da = (a.x - area.footSpot.x) * (a.x - area.footSpot.x) + (a.y - area.footSpot.y) * (a.y - area.footSpot.y);
+        float db = (b.x - area.footSpot.x) * (b.x - area.footSpot.x) + (b.y - area.footSpot.y) * (b.y - area.footSpot.y);
+        return da < db;
+    };
+    std::nth_element(sites.begin(), sites.begin() + count, sites.end(), closerToFootSpot);
+    sites.resize(count);
+
+    // Row-major order keeps neighbouring balls close in memory
+    std::sort(sites.begin(), sites.end(), [](const sf::Vector2f& a, const sf::Vector2f& b) {
+        return a.y < b.y || (a.y == b.y && a.x < b.x);
+    });
+    return sites;
+}
+
+std::vector<sf::Vector2f> generateRandom(int objectCount, float ballRadius, const PlayArea& area, unsigned int seed) {
+    float minDistance = 2 * ballRadius * 1.01f;
+    float minDistanceSquared = minDistance * minDistance;
+
+    std::vector<sf::Vector2f> positions;
+    positions.reserve(objectCount + 1);
+
+    SpatialGrid grid;
+    grid.configure(sf::Vector2f(area.left, area.top), sf::Vector2f(area.right - area.left, area.bottom - area.top), minDistance);
+    grid.reserveIds(objectCount + 1);
+
+    // The cue ball spot takes part in the overlap test but is not returned here
+    positions.push_back(area.headSpot);
+    grid.insert(0, area.headSpot);
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> randomX(area.left, area.right);
+    std::uniform_real_distribution<float> randomY(area.top, area.bottom);
+
+    long long attempts = 0;
+    const long long maxAttempts = 50LL * objectCount + 1000;
+    while (static_cast<int>(positions.size()) <= objectCount && attempts < maxAttempts) {
+        ++attempts;
+        sf::Vector2f candidate(randomX(random), randomY(random));
+
+        bool overlaps = false;
+        grid.forEachNear(candidate, minDistance, [&](int id) {
+            float dx = positions[id].x - candidate.x;
+            float dy = positions[id].y - candidate.y;
+            overlaps = overlaps || dx * dx + dy * dy < minDistanceSquared;
+        });
+
+        if (!overlaps) {
+            grid.insert(static_cast<int>(positions.size()), candidate);
+            positions.push_back(candidate);
+        }
+    }
+
+    if (static_cast<int>(positions.size()) <= objectCount) {
+        BILLIARD_LOG(Warning, Setup) << "Random rack placed " << positions.size() - 1 << " of " << objectCount
+                                     << " balls before the table filled up.";
+    }
+
+    positions.erase(positions.begin());
+    return positions;
+}
+
+} // namespace
+
+
+std::vector<sf::Vector2f> generateRack(const TableSpec& spec, const RackOptions& options) {
+    std::vector<sf::Vector2f> positions;
+    if (options.ballCount < 1) return positions;
+
+    PlayArea area = getPlayArea(spec);
+    int objectCount = options.ballCount - 1;
+
+    switch (options.pattern) {
+        case RackPattern::Triangle:
+            positions = generateTriangle(objectCount, spec.ball_radius, area);
+            break;
+        case RackPattern::Diamond:
+            positions = generateDiamond(objectCount, spec.ball_radius, area);
+            break;
+        case RackPattern::Hexagonal:
+            positions = generateHexagonal(objectCount, spec.ball_radius, area);
+            break;
+        case RackPattern::Random:
+            positions = generateRandom(objectCount, spec.ball_radius, area, options.seed);
+            break;
+    }
+
+    positions.push_back(area.headSpot); // Position for the cue ball
+    return positions;
+}
+
+bool parseRackPattern(const std::string& name, RackPattern& pattern) {
+    for (RackPattern candidate : { RackPattern::Triangle, RackPattern::Diamond, RackPattern::Hexagonal, RackPattern::Random }) {
+        if (name == getRackPatternName(candidate)) {
+            pattern = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* getRackPatternName(RackPattern pattern) {
+    switch (pattern) {
+        case RackPattern::Triangle: return "triangle";
+        case RackPattern::Diamond: return "diamond";
+        case RackPattern::Hexagonal: return "hex";
+        case RackPattern::Random: return "random";
+    }
+    return "triangle";
+}
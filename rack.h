@@ -0,0 +1,40 @@
+#pragma once
+
+#include "table_spec.h"
+#include <string>
+#include <vector>
+
+
+/*
+    Rack Generator
+
+    Lays out any number of balls on a TableSpec. The last position is always the cue ball
+    on the head spot, the object balls are placed around the foot spot (3/4 of the table)
+    unless the pattern fills the whole bed.
+
+      Triangle   rows of 1, 2, 3, ... balls, the classic rack for ballCount == 16
+      Diamond    rows of 1, 2, ..., m, ..., 2, 1 balls
+      Hexagonal  tight hexagonal lattice, the balls closest to the foot spot
+      Random     non-overlapping uniform fill of the bed, reproducible from the seed
+
+    Triangle and diamond racks are shifted towards the head spot when they would cross the
+    foot cushion. A pattern that cannot hold ballCount balls returns fewer positions.
+*/
+
+enum class RackPattern {
+    Triangle,
+    Diamond,
+    Hexagonal,
+    Random
+};
+
+struct RackOptions {
+    int ballCount = 16; // Including the cue ball
+    RackPattern pattern = RackPattern::Triangle;
+    unsigned int seed = 0;
+};
+
+std::vector<sf::Vector2f> generateRack(const TableSpec& spec, const RackOptions& options);
+
+bool parseRackPattern(const std::string& name, RackPattern& pattern);
+const char* getRackPatternName(RackPattern pattern);
@@ -0,0 +1,367 @@
+#include "replay_render.h"
+#include "logger.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+
+/* === SoftwareCanvas Class Definition STARTS HERE === */
+
+SoftwareCanvas::SoftwareCanvas(unsigned int width, unsigned int height)
+    : width(width), height(height), pixels(static_cast<std::size_t>(width) * height * 4, 255), coverage(width + 1, 0.0f),
+      scale(1.0f), offset(0.0f, 0.0f) {}
+
+void SoftwareCanvas::setView(float scale, sf::Vector2f offset) {
+    this->scale = scale;
+    this->offset = offset;
+}
+
+void SoftwareCanvas::clear(const sf::Color& color) {
+    for (std::size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i] = color.r;
+        pixels[i + 1] = color.g;
+        pixels[i + 2] = color.b;
+        pixels[i + 3] = 255;
+    }
+}
+
+void SoftwareCanvas::copyFrom(const SoftwareCanvas& other) {
+    std::copy(other.pixels.begin(), other.pixels.end(), pixels.begin());
+}
+
+void SoftwareCanvas::blend(unsigned int x, unsigned int y, const sf::Color& color, float alpha) {
+    alpha *= color.a / 255.0f;
+    if (alpha <= 0.0f) return;
+
+    sf::Uint8* pixel = &pixels[(static_cast<std::size_t>(y) * width + x) * 4];
+    pixel[0] = static_cast<sf::Uint8>(pixel[0] + (color.r - pixel[0]) * alpha + 0.5f);
+    pixel[1] = static_cast<sf::Uint8>(pixel[1] + (color.g - pixel[1]) * alpha + 0.5f);
+    pixel[2] = static_cast<sf::Uint8>(pixel[2] + (color.b - pixel[2]) * alpha + 0.5f);
+}
+
+void SoftwareCanvas::fillCircle(sf::Vector2f center, float radius, const sf::Color& color) {
+    const float cx = offset.x + center.x * scale;
+    const float cy = offset.y + center.y * scale;
+    const float r = radius * scale;
+
+    int minY = std::max(0, static_cast<int>(std::floor(cy - r - 1.0f)));
+    int maxY = std::min(static_cast<int>(height) - 1, static_cast<int>(std::ceil(cy + r + 1.0f)));
+    int minX = std::max(0, static_cast<int>(std::floor(cx - r - 1.0f)));
+    int maxX = std::min(static_cast<int>(width) - 1, static_cast<int>(std::ceil(cx + r + 1.0f)));
+
+    // Coverage falls off over one pixel across the edge
+    for (int y = minY; y <= maxY; ++y) {
+        float dy = y + 0.5f - cy;
+        for (int x = minX; x <= maxX; ++x) {
+            float dx = x + 0.5f - cx;
+            float alpha = r + 0.5f - std::sqrt(dx * dx + dy * dy);
+            if (alpha > 0.0f) {
+                blend(x, y, color, std::min(1.0f, alpha));
+            }
+        }
+    }
+}
+
+void SoftwareCanvas::fillConvex(const std::vector<sf::Vector2f>& points, const sf::Color& color) {
+    const int subScanlines = 4;
+    if (points.size() < 3) return;
+
+    std::vector<sf::Vector2f> mapped;
+    mapped.reserve(points.size());
+    float top = static_cast<float>(height);
+    float bottom = 0.0f;
+    for (const sf::Vector2f& point : points) {
+        mapped.push_back(offset + point * scale);
+        top = std::min(top, mapped.back().y);
+        bottom = std::max(bottom, mapped.back().y);
+    }
+
+    int minY = std::max(0, static_cast<int>(std::floor(top)));
+    int maxY = std::min(static_cast<int>(height) - 1, static_cast<int>(std::ceil(bottom)));
+    for (int y = minY; y <= maxY; ++y) {
+        int rowMin = static_cast<int>(width);
+        int rowMax = -1;
+
+        for (int sub = 0; sub < subScanlines; ++sub) {
+            float sampleY = y + (sub + 0.5f) / subScanlines;
+
+            // A convex outline crosses a scanline at most twice, the extremes bound the span
+            float left = static_cast<float>(width);
+            float right = 0.0f;
+            for (std::size_t i = 0; i < mapped.size(); ++i) {
+                const sf::Vector2f& a = mapped[i];
+                const sf::Vector2f& b = mapped[(i + 1) % mapped.size()];
+                if ((a.y <= sampleY) == (b.y <= sampleY)) continue;
+
+                float x = a.x + (sampleY - a.y) * (b.x - a.x) / (b.y - a.y);
+                left = std::min(left, x);
+                right = std::max(right, x);
+            }
+            left = std::max(0.0f, left);
+            right = std::min(static_cast<float>(width), right);
+            if (left >= right) continue;
+
+            // Full pixels get the whole sub-scanline weight, the two ends their covered fraction
+            const float weight = 1.0f / subScanlines;
+            int first = static_cast<int>(left);
+            int last = std::min(static_cast<int>(width) - 1, static_cast<int>(right));
+            if (first == last) {
+                coverage[first] += (right - left) * weight;
+            } else {
+                coverage[first] += (first + 1 - left) * weight;
+                for (int x = first + 1; x < last; ++x) {
+                    coverage[x] += weight;
+                }
+                coverage[last] += (right - last) * weight;
+            }
+            rowMin = std::min(rowMin, first);
+            rowMax = std::max(rowMax, last);
+        }
+
+        for (int x = rowMin; x <= rowMax; ++x) {
+            blend(x, y, color, std::min(1.0f, coverage[x]));
+            coverage[x] = 0.0f;
+        }
+    }
+}
+
+void SoftwareCanvas::drawShape(const sf::Shape& shape) {
+    const sf::Transform& transform = shape.getTransform();
+
+    // Circles are filled exactly instead of through their point approximation
+    if (const sf::CircleShape* circle = dynamic_cast<const sf::CircleShape*>(&shape)) {
+        float radius = circle->getRadius();
+        sf::Vector2f center = transform.transformPoint(sf::Vector2f(radius, radius));
+        radius *= shape.getScale().x;
+
+        // The outline lies outside the fill, like SFML draws it
+        if (shape.getOutlineThickness() > 0.0f) {
+            fillCircle(center, radius + shape.getOutlineThickness(), shape.getOutlineColor());
+        }
+        fillCircle(center, radius, shape.getFillColor());
+        return;
+    }
+
+    std::vector<sf::Vector2f> points;
+    points.reserve(shape.getPointCount());
+    for (std::size_t i = 0; i < shape.getPointCount(); ++i) {
+        points.push_back(transform.transformPoint(shape.getPoint(i)));
+    }
+    fillConvex(points, shape.getFillColor());
+}
+
+// Getter Functions
+
+unsigned int SoftwareCanvas::getWidth() const {
+    return width;
+}
+
+unsigned int SoftwareCanvas::getHeight() const {
+    return height;
+}
+
+const std::vector<sf::Uint8>& SoftwareCanvas::getPixels() const {
+    return pixels;
+}
+
+
+namespace {
+
+// The output name goes to snprintf as its format, it must take the frame number and nothing else
+bool isFramePattern(const std::string& pattern) {
+    int conversions = 0;
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] != '%') continue;
+        if (i + 1 < pattern.size() && pattern[i + 1] == '%') {
+            ++i; // A literal percent sign
+            continue;
+        }
+
+        std::size_t j = i + 1;
+        while (j < pattern.size() && (pattern[j] == '-' || pattern[j] == '+' || pattern[j] == ' ' || pattern[j] == '#' || pattern[j] == '0')) ++j;
+        while (j < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[j]))) ++j;
+        if (j == pattern.size() || (pattern[j] != 'd' && pattern[j] != 'i')) return false;
+        ++conversions;
+        i = j;
+    }
+    return conversions == 1;
+}
+
+} // namespace
+
+
+/* === ReplayRenderer Class Definition STARTS HERE === */
+
+ReplayRenderer::ReplayRenderer() : spec(&pool9ftTable) {}
+
+bool ReplayRenderer::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        BILLIARD_LOG(Error, Render) << "Failed to open recording " << path;
+        return false;
+    }
+    std::vector<sf::Uint8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Decode frame by frame and keep the table after every tick
+    SpectatorDecoder decoder;
+    ticks.clear();
+    std::size_t offset = 0;
+    while (data.size() - offset >= 4) {
+        sf::Uint32 length = data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | (static_cast<sf::Uint32>(data[offset + 3]) << 24);
+        if (data.size() - offset - 4 < length) break;
+
+        const sf::Uint8* frame = data.data() + offset + 4;
+        offset += 4 + length;
+        if (!decoder.apply(frame, length)) {
+            BILLIARD_LOG(Error, Render) << "Recording is damaged after " << ticks.size() << " ticks";
+            break;
+        }
+        if (length == 0 || frame[0] == SpectatorTable || !decoder.isSynced()) continue;
+
+        std::vector<SpectatorBall> balls;
+        const std::vector<SpectatorBall>& states = decoder.getBalls();
+        for (std::size_t id = 0; id < states.size(); ++id) {
+            if (decoder.isOnTable(id)) balls.push_back(states[id]);
+        }
+        ticks.push_back(std::move(balls));
+    }
+
+    spec = &decoder.getSpec();
+    BILLIARD_LOG(Info, Render) << "Loaded " << ticks.size() << " ticks on the " << spec->name << " table from " << path;
+    return !ticks.empty();
+}
+
+void ReplayRenderer::renderFrame(SoftwareCanvas& canvas, const SoftwareCanvas& background, Ball& styleBall, double tick) const {
+    canvas.copyFrom(background);
+
+    std::size_t first = std::min(static_cast<std::size_t>(tick), ticks.size() - 1);
+    std::size_t second = std::min(first + 1, ticks.size() - 1);
+    float blend = static_cast<float>(tick - first);
+    const std::vector<SpectatorBall>& from = ticks[first];
+    const std::vector<SpectatorBall>& to = ticks[second];
+
+    // Both snapshots are sorted by id, a ball still on the table next tick is interpolated
+    std::size_t next = 0;
+    for (const SpectatorBall& ball : from) {
+        while (next < to.size() && to[next].id < ball.id) ++next;
+        sf::Vector2f position = ball.position;
+        if (next < to.size() && to[next].id == ball.id) {
+            position += (to[next].position - ball.position) * blend;
+        }
+
+        styleBall.reset(position, ball.color, static_cast<BallType>(ball.kind), *spec);
+        canvas.drawShape(styleBall.shape);
+    }
+}
+
+int ReplayRenderer::render(const ReplayRenderSettings& settings) {
+    if (ticks.empty() || settings.width == 0 || settings.height == 0 || settings.frameRate <= 0.0f) return -1;
+
+    const bool rawOutput = settings.output == "-";
+    if (!rawOutput && !isFramePattern(settings.output)) {
+        BILLIARD_LOG(Error, Render) << "The output name " << settings.output << " needs exactly one frame number like %05d and no other %";
+        return -1;
+    }
+    const double tickRate = settings.tickRate > 0.0f ? settings.tickRate : spec->frLimit;
+    const double ticksPerFrame = tickRate / settings.frameRate;
+    const int frameCount = static_cast<int>((ticks.size() - 1) / ticksPerFrame) + 1;
+    const int threadCount = std::max(1, settings.threads);
+
+    // The table never changes, every frame starts from this copy
+    SoftwareCanvas background(settings.width, settings.height);
+    float scale = std::min(settings.width / static_cast<float>(spec->window_width), settings.height / static_cast<float>(spec->window_height));
+    background.setView(scale, sf::Vector2f((settings.width - spec->window_width * scale) / 2, (settings.height - spec->window_height * scale) / 2));
+    background.clear(sf::Color(spec->window_color));
+    Table table(*spec);
+    for (const sf::Shape* shape : table.getShapes()) {
+        background.drawShape(*shape);
+    }
+    for (const sf::Vector2f& position : generateHolesPositions(*spec)) {
+        background.drawShape(Hole(position, *spec).getShape());
+    }
+
+    std::vector<SoftwareCanvas> canvases(threadCount * 2, background);
+    std::vector<Ball> styleBalls(threadCount, Ball(sf::Vector2f(0.f, 0.f), sf::Color::White, BallType::Solid, *spec));
+    WorkerPool* workers = threadCount > 1 ? new WorkerPool(threadCount) : nullptr;
+    std::atomic<int> nextFrame(0);
+    std::atomic<bool> failed(false);
+
+#ifdef _WIN32
+    if (rawOutput) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    BILLIARD_LOG(Info, Render) << "Rendering " << frameCount << " frames at " << settings.width << "x" << settings.height
+                               << ", " << settings.frameRate << " fps on " << threadCount << " threads";
+    sf::Clock clock;
+
+    // Frames go out in blocks of one canvas per slot, raw output writes each block in order
+    const int blockSize = static_cast<int>(canvases.size());
+    std::vector<sf::Uint8> rgb;
+    for (int blockStart = 0; blockStart < frameCount && !failed; blockStart += blockSize) {
+        int blockEnd = std::min(frameCount, blockStart + blockSize);
+        nextFrame = blockStart;
+
+        auto work = [&](int thread) {
+            for (int frame = nextFrame++; frame < blockEnd; frame = nextFrame++) {
+                SoftwareCanvas& canvas = canvases[frame - blockStart];
+                renderFrame(canvas, background, styleBalls[thread], frame * ticksPerFrame);
+                if (rawOutput) continue;
+
+                char name[1024];
+                std::snprintf(name, sizeof(name), settings.output.c_str(), frame);
+                sf::Image image;
+                image.create(canvas.getWidth(), canvas.getHeight(), canvas.getPixels().data());
+                if (!image.saveToFile(name)) failed = true;
+            }
+        };
+        if (workers) {
+            workers->run(work);
+        } else {
+            work(0);
+        }
+
+        if (rawOutput) {
+            for (int frame = blockStart; frame < blockEnd; ++frame) {
+                const std::vector<sf::Uint8>& pixels = canvases[frame - blockStart].getPixels();
+                rgb.resize(pixels.size() / 4 * 3);
+                for (std::size_t i = 0, j = 0; i < pixels.size(); i += 4, j += 3) {
+                    rgb[j] = pixels[i];
+                    rgb[j + 1] = pixels[i + 1];
+                    rgb[j + 2] = pixels[i + 2];
+                }
+                if (std::fwrite(rgb.data(), 1, rgb.size(), stdout) != rgb.size()) failed = true;
+            }
+        }
+    }
+    if (rawOutput) std::fflush(stdout);
+    delete workers;
+
+    if (failed) {
+        BILLIARD_LOG(Error, Render) << "Failed to write the rendered frames";
+        return -1;
+    }
+    double seconds = clock.getElapsedTime().asSeconds();
+    double footage = frameCount / settings.frameRate;
+    BILLIARD_LOG(Info, Render) << "Rendered " << frameCount << " frames (" << footage << " s of footage) in " << seconds << " s, "
+                               << footage / std::max(seconds, 1e-6) << "x real time";
+    return frameCount;
+}
+
+// Getter Functions
+
+const TableSpec& ReplayRenderer::getSpec() const {
+    return *spec;
+}
+
+std::size_t ReplayRenderer::getTickCount() const {
+    return ticks.size();
+}
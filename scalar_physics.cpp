@@ -0,0 +1,260 @@
+#include "scalar_physics.h"
+#include "game.h"
+#include <algorithm>
+
+
+/* === Fixed Class Definition STARTS HERE === */
+
+Fixed sqrt(Fixed value) {
+    if (value.raw <= 0) return Fixed();
+
+    // sqrt(raw / 2^16) * 2^16 = sqrt(raw * 2^16). Newton's method on integers, started above
+    // the root from the bit length, only moves down and stops at the floor of the root.
+    sf::Uint64 square = static_cast<sf::Uint64>(value.raw) << Fixed::fractionBits;
+    int bits = 0;
+    for (int step = 32; step > 0; step /= 2) {
+        if (square >> (bits + step)) bits += step;
+    }
+    sf::Uint64 root = sf::Uint64(1) << (bits / 2 + 1);
+    while (true) {
+        sf::Uint64 next = (root + square / root) >> 1;
+        if (next >= root) break;
+        root = next;
+    }
+    return Fixed::fromRaw(static_cast<sf::Int64>(root));
+}
+
+
+/* === CushionPolygon Definition STARTS HERE === */
+
+template <typename Scalar>
+CushionPolygon<Scalar> CushionPolygon<Scalar>::fromShape(const sf::ConvexShape& shape) {
+    CushionPolygon cushion;
+    for (std::size_t i = 0; i < shape.getPointCount(); ++i) {
+        cushion.points.push_back(Vec2<Scalar>(shape.getTransform().transformPoint(shape.getPoint(i))));
+    }
+    return cushion;
+}
+
+
+/* === Scalar Kernels Definition STARTS HERE === */
+
+template <typename Scalar, const TableSpec& Spec>
+bool touchesBall(const PhysicsBall<Scalar>& ball, const PhysicsBall<Scalar>& other) {
+    using std::sqrt;
+    Vec2<Scalar> delta = other.position - ball.position;
+    constexpr Scalar reach(Spec.ball_radius * 2 + 0.1f);
+    return sqrt(delta.x * delta.x + delta.y * delta.y) <= reach;
+}
+
+template <typename Scalar, const TableSpec& Spec>
+void resolveBallCollision(PhysicsBall<Scalar>& ball, PhysicsBall<Scalar>& other, const PhysicsParameters& physics) {
+    using std::sqrt;
+    constexpr Scalar ballRadius(Spec.ball_radius);
+    const Scalar restitution(physics.restitution);
+
+    Vec2<Scalar> delta = other.position - ball.position;
+    Scalar distance = sqrt(delta.x * delta.x + delta.y * delta.y);
+
+    // Smallest distance threshold to avoid excessive collision calculations, fixed point rounds 1e-6 to zero
+    if (distance < Scalar(1e-6f) || distance <= Scalar(0)) return;
+
+    // Normalized direction vector along the collision normal
+    Vec2<Scalar> normal = delta / distance;
+    Scalar overlap = (Scalar(2) * ballRadius - distance) / Scalar(2);
+
+    // Adjust overlap to avoid excessive separation
+    Scalar separationFactor(0.5f);
+    ball.position += -normal * overlap * separationFactor;
+    other.position += normal * overlap * separationFactor;
+
+    // Tangent vector, perpendicular to normal
+    Vec2<Scalar> tangent(-normal.y, normal.x);
+
+    // Normal and tangential components of each ball's velocity
+    Scalar v1n = ball.velocity.x * normal.x + ball.velocity.y * normal.y;
+    Scalar v2n = other.velocity.x * normal.x + other.velocity.y * normal.y;
+    Scalar v1t = ball.velocity.x * tangent.x + ball.velocity.y * tangent.y;
+    Scalar v2t = other.velocity.x * tangent.x + other.velocity.y * tangent.y;
+
+    // Conservation of momentum in the normal direction with restitution
+    Scalar newV1n = (v1n * (Scalar(1) - restitution) + v2n * (Scalar(1) + restitution)) / Scalar(2);
+    Scalar newV2n = (v2n * (Scalar(1) - restitution) + v1n * (Scalar(1) + restitution)) / Scalar(2);
+
+    // The tangential components are kept unchanged
+    ball.velocity = newV1n * normal + v1t * tangent;
+    other.velocity = newV2n * normal + v2t * tangent;
+}
+
+template <typename Scalar, const TableSpec& Spec>
+bool resolveCushionCollision(PhysicsBall<Scalar>& ball, const CushionPolygon<Scalar>& cushion, const PhysicsParameters& physics) {
+    using std::sqrt;
+    constexpr Scalar ballRadius(Spec.ball_radius);
+    const Scalar restitution(physics.cushionRestitution);
+    const std::size_t count = cushion.points.size();
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const Vec2<Scalar>& p1 = cushion.points[i];
+        const Vec2<Scalar>& p2 = cushion.points[(i + 1) % count];
+
+        // Closest point of the edge to the ball
+        Vec2<Scalar> edge = p2 - p1;
+        Scalar edgeLengthSquared = edge.x * edge.x + edge.y * edge.y;
+        Vec2<Scalar> ballToEdgeStart = ball.position - p1;
+
+        Scalar t = std::max(Scalar(0), std::min(Scalar(1), (ballToEdgeStart.x * edge.x + ballToEdgeStart.y * edge.y) / edgeLengthSquared));
+        Vec2<Scalar> closestPoint = p1 + t * edge;
+
+        Vec2<Scalar> ballToClosest = ball.position - closestPoint;
+        Scalar distance = sqrt(ballToClosest.x * ballToClosest.x + ballToClosest.y * ballToClosest.y);
+
+        if (distance <= ballRadius && distance > Scalar(0)) {
+            Vec2<Scalar> normal = ballToClosest / distance;
+
+            // Reflect the velocity about the normal, then apply restitution
+            ball.velocity -= Scalar(2) * (ball.velocity.x * normal.x + ball.velocity.y * normal.y) * normal;
+            ball.velocity *= restitution;
+
+            // Push the ball out of the cushion
+            ball.position += normal * (ballRadius - distance);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Scalar, const TableSpec& Spec>
+void integrateBall(PhysicsBall<Scalar>& ball, const std::vector<CushionPolygon<Scalar>>& cushions, const PhysicsParameters& physics) {
+    using std::abs;
+    ball.position += ball.velocity;
+
+    for (const CushionPolygon<Scalar>& cushion : cushions) {
+        resolveCushionCollision<Scalar, Spec>(ball, cushion, physics);
+    }
+
+    // Friction gradually slows the ball down, small movements stop
+    const Scalar friction(physics.friction);
+    const Scalar minVelocity(physics.minVelocityThreshold);
+    ball.velocity *= friction;
+    if (abs(ball.velocity.x) < minVelocity) ball.velocity.x = Scalar(0);
+    if (abs(ball.velocity.y) < minVelocity) ball.velocity.y = Scalar(0);
+}
+
+#define BILLIARD_INSTANTIATE_SCALAR_KERNELS(SCALAR, SPEC) \
+    template bool touchesBall<SCALAR, SPEC>(const PhysicsBall<SCALAR>&, const PhysicsBall<SCALAR>&); \
+    template void resolveBallCollision<SCALAR, SPEC>(PhysicsBall<SCALAR>&, PhysicsBall<SCALAR>&, const PhysicsParameters&); \
+    template bool resolveCushionCollision<SCALAR, SPEC>(PhysicsBall<SCALAR>&, const CushionPolygon<SCALAR>&, const PhysicsParameters&); \
+    template void integrateBall<SCALAR, SPEC>(PhysicsBall<SCALAR>&, const std::vector<CushionPolygon<SCALAR>>&, const PhysicsParameters&);
+
+#define BILLIARD_INSTANTIATE_SCALAR(SCALAR) \
+    template struct CushionPolygon<SCALAR>; \
+    BILLIARD_INSTANTIATE_SCALAR_KERNELS(SCALAR, pool9ftTable) \
+    BILLIARD_INSTANTIATE_SCALAR_KERNELS(SCALAR, snookerTable) \
+    BILLIARD_INSTANTIATE_SCALAR_KERNELS(SCALAR, sandboxTable)
+
+BILLIARD_INSTANTIATE_SCALAR(float)
+BILLIARD_INSTANTIATE_SCALAR(double)
+BILLIARD_INSTANTIATE_SCALAR(Fixed)
+
+
+/* === ScalarTable Class Definition STARTS HERE === */
+
+template <typename Scalar>
+ScalarTable<Scalar>::ScalarTable(const TableSpec& spec) : spec(spec), physics(spec.physics()), steps(0) {
+    // The cushion corners come from the same shapes the game bounces off
+    Table table(spec);
+    for (const sf::ConvexShape* shape : table.getCushions()) {
+        cushions.push_back(CushionPolygon<Scalar>::fromShape(*shape));
+    }
+    for (sf::Vector2f position : generateHolesPositions(spec)) {
+        holes.push_back(Vec2<Scalar>(position));
+    }
+}
+
+template <typename Scalar>
+void ScalarTable<Scalar>::rack(const std::vector<sf::Vector2f>& positions) {
+    balls.clear();
+    for (sf::Vector2f position : positions) {
+        PhysicsBall<Scalar> ball;
+        ball.position = Vec2<Scalar>(position);
+        balls.push_back(ball);
+    }
+    pocketed.assign(balls.size(), false);
+    steps = 0;
+}
+
+template <typename Scalar>
+void ScalarTable<Scalar>::strike(sf::Vector2f velocity) {
+    if (!balls.empty()) balls.back().velocity = Vec2<Scalar>(velocity);
+}
+
+template <typename Scalar>
+template <const TableSpec& Spec>
+void ScalarTable<Scalar>::step() {
+    const int count = static_cast<int>(balls.size());
+    for (int i = 0; i < count; ++i) {
+        if (!pocketed[i]) integrateBall<Scalar, Spec>(balls[i], cushions, physics);
+    }
+
+    // Every pair in index order, the way the game resolved contacts before the contact solver
+    for (int i = 0; i < count; ++i) {
+        for (int j = i + 1; j < count && !pocketed[i]; ++j) {
+            if (!pocketed[j] && touchesBall<Scalar, Spec>(balls[i], balls[j])) {
+                resolveBallCollision<Scalar, Spec>(balls[i], balls[j], physics);
+            }
+        }
+    }
+
+    constexpr Scalar captureRadius((Spec.hole_radius + Spec.ball_radius) * Spec.hole_capture_factor);
+    for (int i = 0; i < count; ++i) {
+        for (const Vec2<Scalar>& hole : holes) {
+            Vec2<Scalar> delta = hole - balls[i].position;
+            if (!pocketed[i] && delta.x * delta.x + delta.y * delta.y <= captureRadius * captureRadius) {
+                pocketed[i] = true;
+                balls[i].velocity = Vec2<Scalar>();
+            }
+        }
+    }
+    ++steps;
+}
+
+template <typename Scalar>
+void ScalarTable<Scalar>::step() {
+    visitTableSpec(spec, [&](auto tag) {
+        this->template step<decltype(tag)::spec>();
+    });
+}
+
+template <typename Scalar>
+bool ScalarTable<Scalar>::isMoving() const {
+    for (std::size_t i = 0; i < balls.size(); ++i) {
+        if (!pocketed[i] && (balls[i].velocity.x != Scalar(0) || balls[i].velocity.y != Scalar(0))) return true;
+    }
+    return false;
+}
+
+// Getter Functions
+
+template <typename Scalar>
+int ScalarTable<Scalar>::getBallCount() const {
+    return static_cast<int>(balls.size());
+}
+
+template <typename Scalar>
+bool ScalarTable<Scalar>::isPocketed(int ball) const {
+    return pocketed[ball];
+}
+
+template <typename Scalar>
+const PhysicsBall<Scalar>& ScalarTable<Scalar>::getBall(int ball) const {
+    return balls[ball];
+}
+
+template <typename Scalar>
+long long ScalarTable<Scalar>::getSteps() const {
+    return steps;
+}
+
+template class ScalarTable<float>;
+template class ScalarTable<double>;
+template class ScalarTable<Fixed>;
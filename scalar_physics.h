@@ -0,0 +1,140 @@
+#pragma once
+
+#include <SFML\Graphics.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "table_spec.h"
+
+
+/*
+    Scalar-templated Physics Kernels
+
+    The ball, cushion and integration routines of the fixed-step physics written once for
+    any scalar type and instantiated three times:
+
+        float   what the game runs, Ball forwards its kernels to these
+        double  for accuracy studies of long runs
+        Fixed   signed 47.16 fixed point on 64-bit integers, every operation is integer
+                arithmetic so a shot replays bit for bit on any compiler or CPU
+
+    The kernels keep the operation order of the original float code, so the float
+    instantiation gives the same results as before. ScalarTable runs a whole table with one
+    scalar type (integration, cushions, pairwise ball collisions and pocket capture) for
+    the throughput benchmark and the cross-check of how far the types drift apart.
+*/
+
+class Fixed {
+private:
+    sf::Int64 raw; // value * 2^fractionBits
+
+    constexpr Fixed(sf::Int64 raw, int) : raw(raw) {}
+    // product / 2^fractionBits rounded towards minus infinity, spelled out because shifting a negative value right is implementation-defined
+    static constexpr sf::Int64 floorScale(sf::Int64 product) { return product / one - (product % one < 0 ? 1 : 0); }
+
+public:
+    static const int fractionBits = 16;
+    static const sf::Int64 one = sf::Int64(1) << fractionBits;
+
+    constexpr Fixed() : raw(0) {}
+    constexpr explicit Fixed(int value) : raw(static_cast<sf::Int64>(value) * one) {}
+    // Exact scaling, then rounded half away from zero, so the TableSpec constants convert at compile time
+    constexpr explicit Fixed(double value) : raw(static_cast<sf::Int64>(value * one + (value < 0 ? -0.5 : 0.5))) {}
+    static constexpr Fixed fromRaw(sf::Int64 raw) { return Fixed(raw, 0); }
+
+    constexpr sf::Int64 getRaw() const { return raw; }
+    constexpr explicit operator double() const { return static_cast<double>(raw) / one; }
+
+    constexpr Fixed operator-() const { return fromRaw(-raw); }
+    constexpr Fixed operator+(Fixed other) const { return fromRaw(raw + other.raw); }
+    constexpr Fixed operator-(Fixed other) const { return fromRaw(raw - other.raw); }
+    constexpr Fixed operator*(Fixed other) const { return fromRaw(floorScale(raw * other.raw)); } // Table values stay far from overflow
+    constexpr Fixed operator/(Fixed other) const { return fromRaw(raw * one / other.raw); }
+    Fixed& operator+=(Fixed other) { raw += other.raw; return *this; }
+    Fixed& operator-=(Fixed other) { raw -= other.raw; return *this; }
+    Fixed& operator*=(Fixed other) { return *this = *this * other; }
+    Fixed& operator/=(Fixed other) { return *this = *this / other; }
+
+    constexpr bool operator<(Fixed other) const { return raw < other.raw; }
+    constexpr bool operator>(Fixed other) const { return raw > other.raw; }
+    constexpr bool operator<=(Fixed other) const { return raw <= other.raw; }
+    constexpr bool operator>=(Fixed other) const { return raw >= other.raw; }
+    constexpr bool operator==(Fixed other) const { return raw == other.raw; }
+    constexpr bool operator!=(Fixed other) const { return raw != other.raw; }
+
+    friend constexpr Fixed abs(Fixed value) { return value.raw < 0 ? -value : value; }
+    friend Fixed sqrt(Fixed value); // Integer square root, floors
+};
+
+template <typename Scalar>
+struct Vec2 {
+    Scalar x, y;
+
+    Vec2() : x(0), y(0) {}
+    Vec2(Scalar x, Scalar y) : x(x), y(y) {}
+    explicit Vec2(sf::Vector2f vector) : x(vector.x), y(vector.y) {}
+
+    sf::Vector2f toVector2f() const { return sf::Vector2f(static_cast<float>(static_cast<double>(x)), static_cast<float>(static_cast<double>(y))); }
+
+    Vec2 operator-() const { return Vec2(-x, -y); }
+    Vec2 operator+(const Vec2& other) const { return Vec2(x + other.x, y + other.y); }
+    Vec2 operator-(const Vec2& other) const { return Vec2(x - other.x, y - other.y); }
+    Vec2 operator*(Scalar factor) const { return Vec2(x * factor, y * factor); }
+    Vec2 operator/(Scalar divisor) const { return Vec2(x / divisor, y / divisor); }
+    Vec2& operator+=(const Vec2& other) { x += other.x; y += other.y; return *this; }
+    Vec2& operator-=(const Vec2& other) { x -= other.x; y -= other.y; return *this; }
+    Vec2& operator*=(Scalar factor) { x *= factor; y *= factor; return *this; }
+    friend Vec2 operator*(Scalar factor, const Vec2& vector) { return Vec2(factor * vector.x, factor * vector.y); }
+};
+
+template <typename Scalar>
+struct PhysicsBall {
+    Vec2<Scalar> position;
+    Vec2<Scalar> velocity; // px per frame
+};
+
+// One cushion, the corners of its convex outline in table coordinates
+template <typename Scalar>
+struct CushionPolygon {
+    std::vector<Vec2<Scalar>> points;
+
+    static CushionPolygon fromShape(const sf::ConvexShape& shape);
+};
+
+// Kernels, one instantiation per scalar type and table
+template <typename Scalar, const TableSpec& Spec> bool touchesBall(const PhysicsBall<Scalar>& ball, const PhysicsBall<Scalar>& other);
+// Friction and restitution are runtime values, Spec.physics() unless calibrated ones are set
+template <typename Scalar, const TableSpec& Spec> void resolveBallCollision(PhysicsBall<Scalar>& ball, PhysicsBall<Scalar>& other, const PhysicsParameters& physics);
+template <typename Scalar, const TableSpec& Spec> bool resolveCushionCollision(PhysicsBall<Scalar>& ball, const CushionPolygon<Scalar>& cushion, const PhysicsParameters& physics);
+// Moves the ball by its velocity, bounces it off the cushions in order, then applies rolling friction
+template <typename Scalar, const TableSpec& Spec> void integrateBall(PhysicsBall<Scalar>& ball, const std::vector<CushionPolygon<Scalar>>& cushions, const PhysicsParameters& physics);
+
+// A whole table with one scalar type, without the contact solver or sleeping of the game
+template <typename Scalar>
+class ScalarTable {
+private:
+    const TableSpec& spec;
+    PhysicsParameters physics;
+    std::vector<PhysicsBall<Scalar>> balls;
+    std::vector<bool> pocketed;
+    std::vector<CushionPolygon<Scalar>> cushions;
+    std::vector<Vec2<Scalar>> holes;
+    long long steps;
+
+    template <const TableSpec& Spec> void step();
+
+public:
+    explicit ScalarTable(const TableSpec& spec = pool9ftTable);
+
+    void rack(const std::vector<sf::Vector2f>& positions); // The last position is the cue ball
+    void strike(sf::Vector2f velocity);                     // Cue ball, px per frame
+    void step();
+    bool isMoving() const;
+
+    // Getter Functions
+    int getBallCount() const;
+    bool isPocketed(int ball) const;
+    const PhysicsBall<Scalar>& getBall(int ball) const;
+    long long getSteps() const;
+};
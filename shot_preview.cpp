@@ -0,0 +1,166 @@
+#include "shot_preview.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+/* === ShotPreview Class Definition STARTS HERE === */
+
+ShotPreview::ShotPreview(const TableSpec& spec, const Table& table, const std::vector<sf::Vector2f>& pocketPositions)
+    : engine(spec, table, pocketPositions), hasPending(false), hasFinished(false), stopping(false), generation(0) {
+    worker = std::thread(&ShotPreview::run, this);
+}
+
+ShotPreview::~ShotPreview() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        ++generation; // Abandons a solve in progress
+    }
+    wakeUp.notify_one();
+    worker.join();
+}
+
+void ShotPreview::request(const ShotPreviewRequest& request) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = request;
+        hasPending = true;
+        ++generation;
+    }
+    wakeUp.notify_one();
+}
+
+void ShotPreview::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    hasPending = false;
+    hasFinished = false;
+    ++generation;
+}
+
+bool ShotPreview::poll(ShotPreviewResult& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hasFinished) return false;
+
+    std::swap(result, finished);
+    hasFinished = false;
+    return true;
+}
+
+void ShotPreview::run() {
+    // Kept across solves, swapped with the hand-off slots so no buffer is freed
+    ShotPreviewRequest request;
+    ShotPreviewResult result;
+    while (true) {
+        unsigned int requestGeneration;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&]() { return stopping || hasPending; });
+            if (stopping) return;
+
+            std::swap(request, pending);
+            hasPending = false;
+            requestGeneration = generation;
+        }
+
+        if (!solve(request, requestGeneration, result)) continue;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (generation == requestGeneration) {
+            std::swap(finished, result);
+            hasFinished = true;
+        }
+    }
+}
+
+bool ShotPreview::solve(const ShotPreviewRequest& request, unsigned int requestGeneration, ShotPreviewResult& result) {
+    const double infiniteTime = std::numeric_limits<double>::infinity();
+    sf::Clock clock;
+
+    // The result comes back from an earlier solve, only its buffers are worth keeping
+    result.cuePath.clear();
+    result.objectPath.clear();
+    result.objectIndex = -1;
+    result.contactPosition = sf::Vector2f(0.f, 0.f);
+    result.cuePocketed = false;
+    result.objectPocketed = false;
+
+    // The table does not change while the player aims, only the first request pays for loading it
+    if (request.positions != loaded) {
+        engine.clear();
+        for (const sf::Vector2f& position : request.positions) {
+            engine.addBall(position);
+        }
+        loaded = request.positions;
+    } else {
+        engine.restart();
+    }
+    if (request.cueIndex < 0 || request.cueIndex >= static_cast<int>(request.positions.size())) return false;
+
+    const int cue = request.cueIndex;
+    int object = -1;
+    double cueEnd = infiniteTime;
+    double objectEnd = infiniteTime;
+    engine.strike(cue, request.velocity, request.tipOffset);
+
+    for (std::size_t applied = 0; applied < maxEvents && clock.getElapsedTime().asMicroseconds() < maxSolveMicroseconds; ++applied) {
+        if (generation != requestGeneration) return false; // The player moved on
+
+        if (!engine.step()) break;
+        const EngineEvent& event = engine.getEvents().back();
+        auto ended = [&](int ball) { return ball == cue ? cueEnd < infiniteTime : objectEnd < infiniteTime; };
+        auto end = [&](int ball) {
+            if (ball == cue && cueEnd == infiniteTime) cueEnd = event.time;
+            if (ball == object && objectEnd == infiniteTime) objectEnd = event.time;
+        };
+
+        if (event.type == EngineEventType::BallBall) {
+            bool cueInvolved = event.ball == cue || event.other == cue;
+            if (object < 0 && cueInvolved && !ended(cue)) {
+                object = event.ball == cue ? event.other : event.ball;
+                result.objectIndex = object;
+                result.contactPosition = engine.samplePosition(cue, event.time);
+            } else {
+                end(event.ball);
+                end(event.other);
+            }
+        } else if (event.type == EngineEventType::Pocket) {
+            if (event.ball == cue && !ended(cue)) result.cuePocketed = true;
+            if (event.ball == object && !ended(object)) result.objectPocketed = true;
+            end(event.ball);
+        } else if (event.state == MotionState::Stationary || event.state == MotionState::Spinning) {
+            end(event.ball);
+        }
+
+        if (ended(cue) && (object < 0 || ended(object))) break;
+    }
+
+    tracePath(cue, std::min(cueEnd, engine.getTime()), result.cuePath);
+    if (object >= 0) {
+        tracePath(object, std::min(objectEnd, engine.getTime()), result.objectPath);
+    }
+    result.events = engine.getEvents().size();
+    result.solveMicroseconds = clock.getElapsedTime().asMicroseconds();
+    return generation == requestGeneration;
+}
+
+void ShotPreview::tracePath(int ball, double endTime, std::vector<sf::Vector2f>& path) const {
+    const int slidingSamples = 12; // Sliding bends the path, rolling runs straight
+
+    path.clear();
+    const std::vector<MotionSegment>& segments = engine.getTrajectory(ball);
+    path.push_back(engine.samplePosition(ball, 0.0));
+
+    for (const MotionSegment& segment : segments) {
+        if (segment.startTime >= endTime) break;
+        if (segment.state != MotionState::Sliding && segment.state != MotionState::Rolling) continue;
+
+        double segmentEnd = std::min(segment.endTime(), endTime);
+        int samples = segment.state == MotionState::Sliding ? slidingSamples : 1;
+        for (int k = 1; k <= samples; ++k) {
+            double time = segment.startTime + (segmentEnd - segment.startTime) * k / samples;
+            Vector2d position = segment.positionAt(time);
+            path.push_back(sf::Vector2f(static_cast<float>(position.x), static_cast<float>(position.y)));
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <SFML\System.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "event_engine.h"
+
+
+/*
+    Shot Preview
+
+    While the player aims, a worker thread solves the shot with its own EventEngine on a
+    snapshot of the table and hands back the path of the cue ball and of the first ball it
+    hits. A path follows the cushion bounces and ends at a pocket, at the next contact with
+    a ball (past the first one the outcome depends on the whole cluster), or at rest.
+
+    Every request supersedes the previous one: the worker checks between two events whether
+    a newer aim came in and drops the stale solve, and a finished result is only kept when
+    it still belongs to the latest request. The game polls once per frame and never waits
+    on the worker, it keeps drawing the last finished path until a newer one is ready.
+
+    Requests and results change hands by swapping, so their buffers go round between the
+    game, the worker and the hand-off slots and aiming stops allocating once they have grown.
+*/
+
+struct ShotPreviewRequest {
+    std::vector<sf::Vector2f> positions; // Every ball on the table
+    int cueIndex = -1;
+    sf::Vector2f velocity;               // px/s
+    sf::Vector2f tipOffset;              // In ball radii, see EventEngine::strike
+};
+
+struct ShotPreviewResult {
+    std::vector<sf::Vector2f> cuePath;
+    std::vector<sf::Vector2f> objectPath; // Empty when the cue ball hits nothing
+    int objectIndex = -1;                 // Index of the first ball hit inside the request positions
+    sf::Vector2f contactPosition;         // Cue ball center at the first contact
+    bool cuePocketed = false;
+    bool objectPocketed = false;
+    std::size_t events = 0;
+    sf::Int64 solveMicroseconds = 0;
+};
+
+class ShotPreview {
+private:
+    EventEngine engine;                 // Only used by the worker once it runs
+    std::vector<sf::Vector2f> loaded;   // Positions the engine holds, aiming again only restarts it
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    ShotPreviewRequest pending;
+    bool hasPending;
+    ShotPreviewResult finished;
+    bool hasFinished;
+    bool stopping;
+    std::atomic<unsigned int> generation; // Bumped by every request and cancel, older solves give up
+
+    void run();
+    bool solve(const ShotPreviewRequest& request, unsigned int requestGeneration, ShotPreviewResult& result);
+    void tracePath(int ball, double endTime, std::vector<sf::Vector2f>& path) const;
+
+public:
+    static const std::size_t maxEvents = 512;
+    static const sf::Int64 maxSolveMicroseconds = 8000; // Paths are cut at the engine time reached by then
+
+    ShotPreview(const TableSpec& spec, const Table& table, const std::vector<sf::Vector2f>& pocketPositions);
+    ~ShotPreview();
+
+    void request(const ShotPreviewRequest& request); // Supersedes any request not finished yet
+    void cancel();                                   // Drops pending work and any unread result
+    bool poll(ShotPreviewResult& result);            // Latest finished preview, false when there is nothing new,
+                                                     // result is overwritten in place, keep it to reuse its buffers
+};
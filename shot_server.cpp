@@ -0,0 +1,772 @@
+#include "shot_server.h"
+#include "simulation.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+/* === Wire Helper Functions === */
+
+namespace {
+
+void writeU8(std::vector<sf::Uint8>& out, sf::Uint8 value) {
+    out.push_back(value);
+}
+
+void writeU16(std::vector<sf::Uint8>& out, sf::Uint16 value) {
+    out.push_back(static_cast<sf::Uint8>(value & 0xFF));
+    out.push_back(static_cast<sf::Uint8>(value >> 8));
+}
+
+void writeU32(std::vector<sf::Uint8>& out, sf::Uint32 value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<sf::Uint8>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void writeU64(std::vector<sf::Uint8>& out, sf::Uint64 value) {
+    writeU32(out, static_cast<sf::Uint32>(value & 0xFFFFFFFFu));
+    writeU32(out, static_cast<sf::Uint32>(value >> 32));
+}
+
+void writeF32(std::vector<sf::Uint8>& out, float value) {
+    sf::Uint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeU32(out, bits);
+}
+
+void patchU32(std::vector<sf::Uint8>& out, std::size_t offset, sf::Uint32 value) {
+    for (int i = 0; i < 4; ++i) {
+        out[offset + i] = static_cast<sf::Uint8>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+sf::Uint16 readU16(const sf::Uint8* data) {
+    return static_cast<sf::Uint16>(data[0] | (data[1] << 8));
+}
+
+sf::Uint32 readU32(const sf::Uint8* data) {
+    return static_cast<sf::Uint32>(data[0]) | (static_cast<sf::Uint32>(data[1]) << 8) |
+           (static_cast<sf::Uint32>(data[2]) << 16) | (static_cast<sf::Uint32>(data[3]) << 24);
+}
+
+sf::Uint64 readU64(const sf::Uint8* data) {
+    return static_cast<sf::Uint64>(readU32(data)) | (static_cast<sf::Uint64>(readU32(data + 4)) << 32);
+}
+
+float readF32(const sf::Uint8* data) {
+    sf::Uint32 bits = readU32(data);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Frame header layout: [u32 length][u8 type][u32 requestId], the offsets below leave out the length
+const std::size_t frameHeaderSize = 1 + 4;
+const std::size_t tableBallSize = 4 + 4 + 1;
+const std::size_t strikeSize = 4 + 4;
+const std::size_t pocketingSize = 2 + 1;
+const std::size_t statsSize = 3 * 4 + 3 * 8 + 5 * 4;
+
+void beginFrame(std::vector<sf::Uint8>& out, sf::Uint8 type, sf::Uint32 requestId) {
+    out.clear();
+    writeU32(out, 0); // Patched once the frame is complete
+    writeU8(out, type);
+    writeU32(out, requestId);
+}
+
+void endFrame(std::vector<sf::Uint8>& out) {
+    patchU32(out, 0, static_cast<sf::Uint32>(out.size() - 4));
+}
+
+void writeTableBall(std::vector<sf::Uint8>& out, const ShotTableBall& ball) {
+    writeF32(out, ball.position.x);
+    writeF32(out, ball.position.y);
+    writeU8(out, ball.onTable ? 1 : 0);
+}
+
+bool readTableBall(const sf::Uint8* data, ShotTableBall& ball) {
+    ball.position = sf::Vector2f(readF32(data), readF32(data + 4));
+    ball.onTable = data[8] != 0;
+    return std::isfinite(ball.position.x) && std::isfinite(ball.position.y);
+}
+
+sf::Uint32 percentile(std::vector<sf::Uint32>& samples, double fraction) {
+    if (samples.empty()) return 0;
+    std::size_t index = std::min(samples.size() - 1, static_cast<std::size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+} // namespace
+
+
+/* === Shot Wire Functions === */
+
+void encodeShotQuery(const ShotQuery& query, std::vector<sf::Uint8>& out) {
+    beginFrame(out, ShotQueryFrame, query.requestId);
+    writeU16(out, static_cast<sf::Uint16>(query.balls.size()));
+    writeU16(out, static_cast<sf::Uint16>(query.strikes.size()));
+    for (const ShotTableBall& ball : query.balls) {
+        writeTableBall(out, ball);
+    }
+    for (const sf::Vector2f& strike : query.strikes) {
+        writeF32(out, strike.x);
+        writeF32(out, strike.y);
+    }
+    endFrame(out);
+}
+
+void encodeShotStatsQuery(sf::Uint32 requestId, std::vector<sf::Uint8>& out) {
+    beginFrame(out, ShotStatsQueryFrame, requestId);
+    endFrame(out);
+}
+
+void encodeShotEvaluation(const ShotEvaluation& outcome, std::vector<sf::Uint8>& out) {
+    beginFrame(out, ShotResultFrame, outcome.requestId);
+    writeU16(out, outcome.shotIndex);
+    writeU8(out, outcome.flags);
+    writeU32(out, outcome.frames);
+    writeU32(out, outcome.serviceMicroseconds);
+    writeU16(out, static_cast<sf::Uint16>(outcome.pocketed.size()));
+    for (const ShotPocketing& pocketing : outcome.pocketed) {
+        writeU16(out, pocketing.ball);
+        writeU8(out, pocketing.hole);
+    }
+    for (const ShotTableBall& ball : outcome.balls) {
+        writeTableBall(out, ball);
+    }
+    endFrame(out);
+}
+
+void encodeShotStats(sf::Uint32 requestId, const ShotServerStats& stats, std::vector<sf::Uint8>& out) {
+    beginFrame(out, ShotStatsFrame, requestId);
+    writeU32(out, stats.queueDepth);
+    writeU32(out, stats.maxQueueDepth);
+    writeU32(out, stats.connections);
+    writeU64(out, stats.requests);
+    writeU64(out, stats.shots);
+    writeU64(out, stats.rejected);
+    writeU32(out, stats.latencyP50);
+    writeU32(out, stats.latencyP99);
+    writeU32(out, stats.latencyMax);
+    writeU32(out, stats.serviceP50);
+    writeU32(out, stats.serviceP99);
+    endFrame(out);
+}
+
+void encodeShotError(sf::Uint32 requestId, ShotErrorCode error, std::vector<sf::Uint8>& out) {
+    beginFrame(out, ShotErrorFrame, requestId);
+    writeU8(out, error);
+    endFrame(out);
+}
+
+bool decodeShotQuery(const sf::Uint8* data, std::size_t size, ShotQuery& query) {
+    if (size < frameHeaderSize + 4 || data[0] != ShotQueryFrame) return false;
+
+    query.requestId = readU32(data + 1);
+    const std::size_t ballCount = readU16(data + frameHeaderSize);
+    const std::size_t shotCount = readU16(data + frameHeaderSize + 2);
+    if (ballCount == 0 || shotCount == 0) return false;
+    if (size != frameHeaderSize + 4 + ballCount * tableBallSize + shotCount * strikeSize) return false;
+
+    const sf::Uint8* cursor = data + frameHeaderSize + 4;
+    query.balls.resize(ballCount);
+    for (ShotTableBall& ball : query.balls) {
+        if (!readTableBall(cursor, ball)) return false;
+        cursor += tableBallSize;
+    }
+    query.strikes.resize(shotCount);
+    for (sf::Vector2f& strike : query.strikes) {
+        strike = sf::Vector2f(readF32(cursor), readF32(cursor + 4));
+        if (!std::isfinite(strike.x) || !std::isfinite(strike.y)) return false;
+        cursor += strikeSize;
+    }
+    return true;
+}
+
+bool decodeShotReply(const sf::Uint8* data, std::size_t size, ShotReply& reply) {
+    if (size < frameHeaderSize) return false;
+
+    reply.type = data[0];
+    reply.requestId = readU32(data + 1);
+    const sf::Uint8* body = data + frameHeaderSize;
+    const std::size_t bodySize = size - frameHeaderSize;
+
+    if (reply.type == ShotErrorFrame) {
+        if (bodySize != 1) return false;
+        reply.error = body[0];
+        return true;
+    }
+
+    if (reply.type == ShotStatsFrame) {
+        if (bodySize != statsSize) return false;
+        ShotServerStats& stats = reply.stats;
+        stats.queueDepth = readU32(body);
+        stats.maxQueueDepth = readU32(body + 4);
+        stats.connections = readU32(body + 8);
+        stats.requests = readU64(body + 12);
+        stats.shots = readU64(body + 20);
+        stats.rejected = readU64(body + 28);
+        stats.latencyP50 = readU32(body + 36);
+        stats.latencyP99 = readU32(body + 40);
+        stats.latencyMax = readU32(body + 44);
+        stats.serviceP50 = readU32(body + 48);
+        stats.serviceP99 = readU32(body + 52);
+        return true;
+    }
+
+    if (reply.type == ShotResultFrame) {
+        const std::size_t fixedSize = 2 + 1 + 4 + 4 + 2;
+        if (bodySize < fixedSize) return false;
+        ShotEvaluation& outcome = reply.outcome;
+        outcome.requestId = reply.requestId;
+        outcome.shotIndex = readU16(body);
+        outcome.flags = body[2];
+        outcome.frames = readU32(body + 3);
+        outcome.serviceMicroseconds = readU32(body + 7);
+        const std::size_t pocketCount = readU16(body + 11);
+        if (bodySize < fixedSize + pocketCount * pocketingSize) return false;
+
+        const sf::Uint8* cursor = body + fixedSize;
+        outcome.pocketed.resize(pocketCount);
+        for (ShotPocketing& pocketing : outcome.pocketed) {
+            pocketing.ball = readU16(cursor);
+            pocketing.hole = cursor[2];
+            cursor += pocketingSize;
+        }
+
+        // The rest of the frame is the balls at rest
+        const std::size_t ballBytes = bodySize - fixedSize - pocketCount * pocketingSize;
+        if (ballBytes % tableBallSize != 0) return false;
+        outcome.balls.resize(ballBytes / tableBallSize);
+        for (ShotTableBall& ball : outcome.balls) {
+            readTableBall(cursor, ball);
+            cursor += tableBallSize;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+
+/* === ShotServer Class Definition STARTS HERE === */
+
+ShotServer::Connection::Connection() : pendingOutput(false), closed(false) {}
+
+ShotServer::ShotServer(const TableSpec& spec, const ShotServerSettings& settings)
+    : spec(spec),
+      settings(settings),
+      batchWorkers(0),
+      maxBatchWorkers(1),
+      queuedShots(0),
+      maxQueuedShots(0),
+      isRunning(false),
+      sampleCount(0),
+      requestCount(0),
+      shotCount(0),
+      rejectedCount(0),
+      connectionCount(0) {
+    this->settings.threads = std::max(1, settings.threads);
+    // Batch shots leave a worker and a core to the singles, the last one would be time sliced otherwise
+    const int cores = static_cast<int>(std::thread::hardware_concurrency());
+    maxBatchWorkers = std::max(1, std::min(this->settings.threads, cores > 0 ? cores : this->settings.threads) - 1);
+    this->settings.sampleWindow = std::max(1, settings.sampleWindow);
+    latencySamples.resize(this->settings.sampleWindow);
+    serviceSamples.resize(this->settings.sampleWindow);
+}
+
+ShotServer::~ShotServer() {
+    stop();
+}
+
+bool ShotServer::start() {
+    // Front-ends run on the same machine, nothing else may reach the simulator
+    if (listener.listen(settings.port, sf::IpAddress::LocalHost) != sf::Socket::Done) {
+        BILLIARD_LOG(Error, Network) << "Failed to listen for shot queries on port " << settings.port;
+        return false;
+    }
+    listener.setBlocking(false);
+    selector.add(listener);
+
+    for (int thread = 0; thread < settings.threads; ++thread) {
+        simulations.push_back(new Simulation(spec));
+    }
+
+    isRunning = true;
+    for (int thread = 0; thread < settings.threads; ++thread) {
+        workers.push_back(std::thread(&ShotServer::work, this, thread));
+    }
+    network = std::thread(&ShotServer::run, this);
+    BILLIARD_LOG(Info, Network) << "Shot server listening on 127.0.0.1:" << settings.port << " with " << settings.threads
+                                << " workers on the " << spec.name << " table";
+    return true;
+}
+
+void ShotServer::stop() {
+    if (!isRunning) return;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        isRunning = false;
+    }
+    workReady.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    if (network.joinable()) {
+        network.join();
+    }
+
+    selector.clear();
+    listener.close();
+    connections.clear();
+    connectionCount = 0;
+    for (const auto& connection : ready) {
+        connection->requests.clear(); // They point back at the connection
+        connection->scheduled = false;
+    }
+    ready.clear();
+    singles.clear();
+    queuedShots = 0;
+    for (Simulation* simulation : simulations) {
+        delete simulation;
+    }
+    simulations.clear();
+
+    BILLIARD_LOG(Info, Network) << "Shot server stopped after " << requestCount << " requests and " << shotCount << " shots";
+}
+
+void ShotServer::run() {
+    while (isRunning) {
+        // Sends that would have blocked are retried soon, otherwise the wait only bounds how late stop() is noticed
+        bool pendingOutput = false;
+        for (const auto& connection : connections) {
+            pendingOutput = pendingOutput || connection->pendingOutput;
+        }
+
+        if (selector.wait(sf::milliseconds(pendingOutput ? 1 : 20))) {
+            if (selector.isReady(listener)) {
+                acceptConnections();
+            }
+            for (const auto& connection : connections) {
+                if (!connection->closed && selector.isReady(connection->socket) && !receive(connection)) {
+                    connection->closed = true;
+                }
+            }
+        }
+
+        dispatchBatch();
+
+        for (const auto& connection : connections) {
+            if (!connection->pendingOutput || connection->closed) continue;
+            std::lock_guard<std::mutex> lock(connection->sendMutex);
+            flush(*connection);
+        }
+
+        std::size_t before = connections.size();
+        for (const auto& connection : connections) {
+            if (!connection->closed) continue;
+            std::lock_guard<std::mutex> lock(connection->sendMutex); // Workers still holding it only see closed
+            selector.remove(connection->socket);
+            connection->socket.disconnect();
+        }
+        connections.erase(std::remove_if(connections.begin(), connections.end(), [](const std::shared_ptr<Connection>& connection) {
+            return connection->closed.load();
+        }), connections.end());
+        if (connections.size() != before) {
+            BILLIARD_LOG(Info, Network) << "Shot client disconnected, " << connections.size() << " connected";
+        }
+        connectionCount = connections.size();
+    }
+}
+
+void ShotServer::acceptConnections() {
+    while (true) {
+        std::shared_ptr<Connection> connection(new Connection());
+        if (listener.accept(connection->socket) != sf::Socket::Done) {
+            break;
+        }
+        connection->socket.setBlocking(false);
+        selector.add(connection->socket);
+        connections.push_back(connection);
+        BILLIARD_LOG(Info, Network) << "Shot client connected, " << connections.size() << " connected";
+    }
+}
+
+bool ShotServer::receive(const std::shared_ptr<Connection>& connection) {
+    std::vector<sf::Uint8>& inbox = connection->inbox;
+    const std::size_t chunk = 64 * 1024;
+    while (true) {
+        const std::size_t used = inbox.size();
+        inbox.resize(used + chunk);
+        std::size_t received = 0;
+        sf::Socket::Status status = connection->socket.receive(inbox.data() + used, chunk, received);
+        inbox.resize(used + received);
+        if (status == sf::Socket::NotReady) break;
+        if (status != sf::Socket::Done) return false;
+        if (received < chunk) break;
+    }
+
+    std::size_t offset = 0;
+    while (inbox.size() - offset >= 4) {
+        const std::size_t length = readU32(inbox.data() + offset);
+        if (length == 0 || length > settings.maxFrameBytes) {
+            ++rejectedCount;
+            encodeShotError(0, ShotErrorTooLarge, networkFrame);
+            deliver(*connection, networkFrame);
+            return false;
+        }
+        if (inbox.size() - offset - 4 < length) break;
+        if (!handleFrame(connection, inbox.data() + offset + 4, length)) return false;
+        offset += 4 + length;
+    }
+    inbox.erase(inbox.begin(), inbox.begin() + offset);
+    return true;
+}
+
+bool ShotServer::handleFrame(const std::shared_ptr<Connection>& connection, const sf::Uint8* data, std::size_t size) {
+    const sf::Uint8 type = data[0];
+    const sf::Uint32 requestId = size >= frameHeaderSize ? readU32(data + 1) : 0;
+
+    if (type == ShotStatsQueryFrame && size == frameHeaderSize) {
+        encodeShotStats(requestId, getStats(), networkFrame);
+        deliver(*connection, networkFrame);
+        return true;
+    }
+
+    std::shared_ptr<PendingRequest> request(new PendingRequest());
+    if (type != ShotQueryFrame || !decodeShotQuery(data, size, request->query)) {
+        // The stream cannot be trusted past a bad frame
+        ++rejectedCount;
+        encodeShotError(requestId, ShotErrorMalformed, networkFrame);
+        deliver(*connection, networkFrame);
+        return false;
+    }
+    if (request->query.balls.size() > static_cast<std::size_t>(settings.maxBalls)) {
+        ++rejectedCount;
+        encodeShotError(requestId, ShotErrorTooLarge, networkFrame);
+        deliver(*connection, networkFrame);
+        return true;
+    }
+
+    request->connection = connection;
+    request->receivedMicroseconds = clock.getElapsedTime().asMicroseconds();
+    ++requestCount;
+    batch.push_back(request);
+    return true;
+}
+
+void ShotServer::dispatchBatch() {
+    if (batch.empty()) return;
+
+    std::size_t added = 0;
+    std::size_t refused = batch.size();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (std::shared_ptr<PendingRequest>& request : batch) {
+            const std::size_t shots = request->query.strikes.size();
+            if (queuedShots + shots > settings.maxQueuedShots) continue;
+            queuedShots += shots;
+            added += shots;
+            if (shots == 1) {
+                singles.push_back(request);
+                request.reset();
+                continue;
+            }
+            Connection& connection = *request->connection;
+            connection.requests.push_back(request);
+            if (!connection.scheduled) {
+                connection.scheduled = true;
+                ready.push_back(request->connection);
+            }
+            request.reset(); // Left set only for the refused ones
+        }
+        maxQueuedShots = std::max(maxQueuedShots, queuedShots);
+    }
+    if (added == 1) {
+        workReady.notify_one();
+    } else if (added > 1) {
+        workReady.notify_all();
+    }
+
+    for (const std::shared_ptr<PendingRequest>& request : batch) {
+        if (!request) {
+            --refused;
+            continue;
+        }
+        encodeShotError(request->query.requestId, ShotErrorBusy, networkFrame);
+        deliver(*request->connection, networkFrame);
+    }
+    rejectedCount += refused;
+    batch.clear();
+}
+
+void ShotServer::work(int index) {
+    Simulation& simulation = *simulations[index];
+    std::vector<sf::Vector2f> positions;
+    ShotEvaluation outcome;
+    std::vector<sf::Uint8> frame;
+    bool isBatch = true; // What the last shot was, after a single a waiting batch goes first so singles cannot starve it
+
+    while (true) {
+        std::shared_ptr<PendingRequest> request;
+        int shot = 0;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            workReady.wait(lock, [this] { return !singles.empty() || (!ready.empty() && batchWorkers < maxBatchWorkers) || !isRunning; });
+            if (!isRunning) return;
+
+            const bool canBatch = !ready.empty() && batchWorkers < maxBatchWorkers;
+            isBatch = canBatch && (singles.empty() || !isBatch);
+            if (!isBatch) {
+                request = singles.front();
+                singles.pop_front();
+                --queuedShots;
+                if (request->connection->closed) continue; // Nobody reads the result any more
+            } else {
+                std::shared_ptr<Connection> connection = ready.front();
+                ready.pop_front();
+                if (connection->closed) {
+                    // Nobody reads the results any more, drop everything it still had queued
+                    for (const std::shared_ptr<PendingRequest>& dropped : connection->requests) {
+                        queuedShots -= dropped->query.strikes.size() - dropped->nextShot;
+                    }
+                    connection->requests.clear();
+                    connection->scheduled = false;
+                    continue;
+                }
+
+                // One shot per turn, the connection goes to the back while it has more
+                request = connection->requests.front();
+                shot = request->nextShot++;
+                if (request->nextShot == static_cast<int>(request->query.strikes.size())) {
+                    connection->requests.pop_front();
+                }
+                if (connection->requests.empty()) {
+                    connection->scheduled = false;
+                } else {
+                    ready.push_back(connection);
+                }
+                --queuedShots;
+                ++batchWorkers;
+            }
+        }
+
+        const sf::Int64 start = clock.getElapsedTime().asMicroseconds();
+        evaluate(simulation, request->query, shot, positions, outcome);
+        const sf::Int64 solved = clock.getElapsedTime().asMicroseconds();
+        outcome.serviceMicroseconds = static_cast<sf::Uint32>(solved - start);
+
+        encodeShotEvaluation(outcome, frame);
+        ++shotCount; // Before the client can see the result and ask for the stats
+        deliver(*request->connection, frame);
+        const sf::Int64 latency = clock.getElapsedTime().asMicroseconds() - request->receivedMicroseconds;
+        addSample(static_cast<sf::Uint32>(latency), outcome.serviceMicroseconds);
+
+        if (isBatch) {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                --batchWorkers;
+            }
+            workReady.notify_one(); // A worker may be waiting for the batch slot
+        }
+    }
+}
+
+void ShotServer::evaluate(Simulation& simulation, const ShotQuery& query, int shot, std::vector<sf::Vector2f>& positions, ShotEvaluation& outcome) const {
+    const int ballCount = static_cast<int>(query.balls.size());
+    positions.resize(ballCount);
+    for (int id = 0; id < ballCount; ++id) {
+        positions[id] = query.balls[id].position;
+    }
+    simulation.rack(positions);
+    for (int id = 0; id < ballCount; ++id) {
+        if (!query.balls[id].onTable) simulation.pocket(id);
+    }
+    simulation.strike(query.strikes[shot]);
+
+    outcome.requestId = query.requestId;
+    outcome.shotIndex = static_cast<sf::Uint16>(shot);
+    outcome.flags = 0;
+    outcome.pocketed.clear();
+
+    sf::Uint32 frames = 0;
+    while (simulation.isMoving()) {
+        simulation.step();
+        ++frames;
+
+        for (const PocketEvent& event : simulation.getPocketEvents()) {
+            ShotPocketing pocketing;
+            pocketing.ball = static_cast<sf::Uint16>(event.ballId);
+            pocketing.hole = static_cast<sf::Uint8>(event.holeIndex);
+            outcome.pocketed.push_back(pocketing);
+            if (event.ballId == simulation.getCueBallId()) outcome.flags |= ShotScratched;
+        }
+
+        if (static_cast<int>(frames) >= settings.maxShotFrames) {
+            simulation.callOff();
+            outcome.flags |= ShotCalledOff;
+        }
+    }
+    outcome.frames = frames;
+
+    const BallPool& ballPool = simulation.getBallPool();
+    outcome.balls.resize(ballCount);
+    for (int id = 0; id < ballCount; ++id) {
+        const Ball& ball = ballPool.get(id);
+        outcome.balls[id].position = ball.getPosition();
+        outcome.balls[id].onTable = !ball.pocketed;
+    }
+}
+
+void ShotServer::deliver(Connection& connection, const std::vector<sf::Uint8>& frame) {
+    std::lock_guard<std::mutex> lock(connection.sendMutex);
+    if (connection.closed) return;
+
+    // Nothing queued ahead of it, the frame goes out from this thread right away
+    if (connection.sentBytes == connection.outbox.size()) {
+        std::size_t sent = 0;
+        sf::Socket::Status status = connection.socket.send(frame.data(), frame.size(), sent);
+        if (status == sf::Socket::Disconnected || status == sf::Socket::Error) {
+            connection.closed = true;
+            return;
+        }
+        if (sent == frame.size()) return;
+
+        connection.outbox.assign(frame.begin() + sent, frame.end());
+        connection.sentBytes = 0;
+        connection.pendingOutput = true;
+        return;
+    }
+
+    if (connection.outbox.size() - connection.sentBytes + frame.size() > settings.maxOutboxBytes) {
+        BILLIARD_LOG(Info, Network) << "Shot client stopped reading its results, dropping it";
+        connection.closed = true;
+        return;
+    }
+    connection.outbox.insert(connection.outbox.end(), frame.begin(), frame.end());
+    connection.pendingOutput = true;
+}
+
+void ShotServer::flush(Connection& connection) {
+    if (connection.sentBytes == connection.outbox.size()) return;
+
+    std::size_t sent = 0;
+    sf::Socket::Status status = connection.socket.send(connection.outbox.data() + connection.sentBytes,
+                                                       connection.outbox.size() - connection.sentBytes, sent);
+    if (status == sf::Socket::Disconnected || status == sf::Socket::Error) {
+        connection.closed = true;
+        return;
+    }
+
+    connection.sentBytes += sent;
+    if (connection.sentBytes == connection.outbox.size()) {
+        connection.outbox.clear();
+        connection.sentBytes = 0;
+        connection.pendingOutput = false;
+    }
+}
+
+void ShotServer::addSample(sf::Uint32 latency, sf::Uint32 service) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    const std::size_t slot = sampleCount % latencySamples.size();
+    latencySamples[slot] = latency;
+    serviceSamples[slot] = service;
+    ++sampleCount;
+}
+
+// Getter Functions
+
+ShotServerStats ShotServer::getStats() {
+    ShotServerStats stats;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stats.queueDepth = static_cast<sf::Uint32>(queuedShots);
+        stats.maxQueueDepth = static_cast<sf::Uint32>(maxQueuedShots);
+    }
+    stats.connections = static_cast<sf::Uint32>(connectionCount.load());
+    stats.requests = requestCount;
+    stats.shots = shotCount;
+    stats.rejected = rejectedCount;
+
+    std::vector<sf::Uint32> latencies;
+    std::vector<sf::Uint32> services;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        const std::size_t count = std::min(sampleCount, latencySamples.size());
+        latencies.assign(latencySamples.begin(), latencySamples.begin() + count);
+        services.assign(serviceSamples.begin(), serviceSamples.begin() + count);
+    }
+    stats.latencyP50 = percentile(latencies, 0.5);
+    stats.latencyP99 = percentile(latencies, 0.99);
+    stats.latencyMax = latencies.empty() ? 0 : *std::max_element(latencies.begin(), latencies.end());
+    stats.serviceP50 = percentile(services, 0.5);
+    stats.serviceP99 = percentile(services, 0.99);
+    return stats;
+}
+
+unsigned short ShotServer::getPort() const {
+    return settings.port;
+}
+
+
+/* === ShotClient Class Definition STARTS HERE === */
+
+ShotClient::ShotClient() : receiveOffset(0) {}
+
+bool ShotClient::connect(unsigned short port) {
+    receiveBuffer.clear();
+    receiveOffset = 0;
+    if (socket.connect(sf::IpAddress::LocalHost, port, sf::seconds(2.0f)) != sf::Socket::Done) {
+        BILLIARD_LOG(Error, Network) << "Failed to connect to the shot server on port " << port;
+        return false;
+    }
+    return true;
+}
+
+void ShotClient::disconnect() {
+    socket.disconnect();
+}
+
+bool ShotClient::send(const ShotQuery& query) {
+    encodeShotQuery(query, sendBuffer);
+    return socket.send(sendBuffer.data(), sendBuffer.size()) == sf::Socket::Done;
+}
+
+bool ShotClient::requestStats(sf::Uint32 requestId) {
+    encodeShotStatsQuery(requestId, sendBuffer);
+    return socket.send(sendBuffer.data(), sendBuffer.size()) == sf::Socket::Done;
+}
+
+bool ShotClient::receive(ShotReply& reply) {
+    while (true) {
+        const std::size_t available = receiveBuffer.size() - receiveOffset;
+        if (available >= 4) {
+            const std::size_t length = readU32(receiveBuffer.data() + receiveOffset);
+            if (available - 4 >= length) {
+                bool decoded = decodeShotReply(receiveBuffer.data() + receiveOffset + 4, length, reply);
+                receiveOffset += 4 + length;
+                if (!decoded) {
+                    BILLIARD_LOG(Warning, Network) << "Malformed frame from the shot server";
+                    return false;
+                }
+                return true;
+            }
+        }
+
+        // Keep only the partial frame before reading more
+        receiveBuffer.erase(receiveBuffer.begin(), receiveBuffer.begin() + receiveOffset);
+        receiveOffset = 0;
+        const std::size_t used = receiveBuffer.size();
+        const std::size_t chunk = 64 * 1024;
+        receiveBuffer.resize(used + chunk);
+        std::size_t received = 0;
+        sf::Socket::Status status = socket.receive(receiveBuffer.data() + used, chunk, received);
+        receiveBuffer.resize(used + received);
+        if (status != sf::Socket::Done) return false;
+    }
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <SFML\Network.hpp>
+#include <SFML\System.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "table_spec.h"
+
+class Simulation;
+
+
+/*
+    Shot Evaluation Server
+
+    A long-running process that holds one Simulation per worker thread and answers "what
+    happens if I play this" for coaching front-ends on the same machine. It listens on
+    loopback TCP only. Every frame on the wire is length-prefixed and little endian, like
+    the spectator stream:
+
+        [u32 length][u8 frameType][u32 requestId][body...]
+
+    Client to server:
+        ShotQueryFrame   [u16 ballCount][u16 shotCount], ballCount x [f32 x][f32 y][u8 onTable],
+                         shotCount x [f32 forceX][f32 forceY]
+                         The balls are in Simulation::rack order, the last one is the cue ball, and
+                         every shot is played from that same table state. Forces are in
+                         Simulation::strike units (direction times a power of 0 - 100).
+        ShotStatsQueryFrame  no body
+
+    Server to client:
+        ShotResultFrame  [u16 shotIndex][u8 flags][u32 frames][u32 serviceMicroseconds]
+                         [u16 pocketCount], pocketCount x [u16 ball][u8 hole],
+                         ballCount x [f32 x][f32 y][u8 onTable] as the table came to rest
+        ShotErrorFrame   [u8 ShotErrorCode]
+        ShotStatsFrame   ShotServerStats, see encodeShotStats
+
+    A client may pipeline any number of requests without waiting. Results are streamed one
+    frame per shot as soon as that shot is solved, so they arrive out of order across and
+    within requests; requestId and shotIndex say which shot a result belongs to.
+
+    The network thread reads every connection that has data, decodes all complete frames
+    and hands them to the workers in one batch under a single lock. Single-shot queries
+    have their own lane, oldest first, that a worker serves before any batch shot unless
+    its last shot was a single too, so a stream of singles cannot starve the batches. With
+    several workers, batch shots never hold all of them or every core, so a single-shot
+    query waits for at most the shots already being played. Workers take batch shots one at a time,
+    round robin over the connections with batches queued; a connection's batches are
+    played in the order they came. A worker writes its
+    result straight to the socket when nothing is queued for that connection, and the
+    network thread only finishes sends that would have blocked.
+*/
+
+enum ShotFrameType : sf::Uint8 {
+    ShotQueryFrame = 1,
+    ShotStatsQueryFrame = 2,
+    ShotResultFrame = 3,
+    ShotErrorFrame = 4,
+    ShotStatsFrame = 5
+};
+
+enum ShotResultFlags : sf::Uint8 {
+    ShotScratched = 1 << 0, // The cue ball was pocketed, it rests on its spot
+    ShotCalledOff = 1 << 1  // Still moving after maxShotFrames, stopped where the balls were
+};
+
+enum ShotErrorCode : sf::Uint8 {
+    ShotErrorMalformed = 1, // The frame did not decode, the connection is closed after the error
+    ShotErrorTooLarge = 2,  // More balls or a longer frame than the server accepts
+    ShotErrorBusy = 3       // The queue is full, nothing of the request was played
+};
+
+const unsigned short shotServerDefaultPort = 53100;
+
+
+struct ShotTableBall {
+    sf::Vector2f position;
+    bool onTable = true;
+};
+
+struct ShotQuery {
+    sf::Uint32 requestId = 0;
+    std::vector<ShotTableBall> balls;  // Rack order, the last is the cue ball
+    std::vector<sf::Vector2f> strikes; // Simulation::strike units, one shot each
+};
+
+struct ShotPocketing {
+    sf::Uint16 ball;
+    sf::Uint8 hole;
+};
+
+struct ShotEvaluation {
+    sf::Uint32 requestId = 0;
+    sf::Uint16 shotIndex = 0;
+    sf::Uint8 flags = 0;
+    sf::Uint32 frames = 0;
+    sf::Uint32 serviceMicroseconds = 0; // Simulation time of this shot alone
+    std::vector<ShotPocketing> pocketed; // In the order the balls dropped
+    std::vector<ShotTableBall> balls;    // Where every ball came to rest
+};
+
+struct ShotServerStats {
+    sf::Uint32 queueDepth = 0;    // Shots waiting for a worker
+    sf::Uint32 maxQueueDepth = 0; // Since the server started
+    sf::Uint32 connections = 0;
+    sf::Uint64 requests = 0;
+    sf::Uint64 shots = 0;         // Solved and sent
+    sf::Uint64 rejected = 0;      // Requests answered with an error
+    // Over the last sampleWindow shots, in microseconds. Latency runs from the request being
+    // decoded to its result being handed to the socket, service is the simulation alone.
+    sf::Uint32 latencyP50 = 0;
+    sf::Uint32 latencyP99 = 0;
+    sf::Uint32 latencyMax = 0;
+    sf::Uint32 serviceP50 = 0;
+    sf::Uint32 serviceP99 = 0;
+};
+
+// Everything a client reads back, type says which part is filled
+struct ShotReply {
+    sf::Uint8 type = 0;
+    sf::Uint32 requestId = 0;
+    ShotEvaluation outcome;
+    ShotServerStats stats;
+    sf::Uint8 error = 0;
+};
+
+// Wire encoding, out holds one whole frame with its length prefix
+void encodeShotQuery(const ShotQuery& query, std::vector<sf::Uint8>& out);
+void encodeShotStatsQuery(sf::Uint32 requestId, std::vector<sf::Uint8>& out);
+void encodeShotEvaluation(const ShotEvaluation& outcome, std::vector<sf::Uint8>& out);
+void encodeShotStats(sf::Uint32 requestId, const ShotServerStats& stats, std::vector<sf::Uint8>& out);
+void encodeShotError(sf::Uint32 requestId, ShotErrorCode error, std::vector<sf::Uint8>& out);
+// One frame without its length prefix, false when it was malformed
+bool decodeShotQuery(const sf::Uint8* data, std::size_t size, ShotQuery& query);
+bool decodeShotReply(const sf::Uint8* data, std::size_t size, ShotReply& reply);
+
+struct ShotServerSettings {
+    unsigned short port = shotServerDefaultPort;
+    int threads = 1;
+    int maxShotFrames = 5000;
+    int maxBalls = 256;
+    std::size_t maxFrameBytes = 1 << 20;
+    std::size_t maxOutboxBytes = 8 << 20; // Per connection, a client that stops reading is dropped
+    std::size_t maxQueuedShots = 1 << 16;
+    int sampleWindow = 4096;              // Shots the latency percentiles are taken over
+};
+
+class ShotServer {
+private:
+    struct PendingRequest;
+
+    struct Connection {
+        sf::TcpSocket socket;
+        std::vector<sf::Uint8> inbox;   // Network thread only
+        std::mutex sendMutex;           // Guards the outbox and every send
+        std::vector<sf::Uint8> outbox;  // Bytes a send would have blocked on
+        std::size_t sentBytes = 0;
+        std::atomic<bool> pendingOutput;
+        std::atomic<bool> closed;
+
+        // Under queueMutex
+        std::deque<std::shared_ptr<PendingRequest>> requests; // Batches, oldest first
+        bool scheduled = false;                               // Inside ready
+
+        Connection();
+    };
+
+    struct PendingRequest {
+        std::shared_ptr<Connection> connection;
+        ShotQuery query;
+        int nextShot = 0;                 // Under queueMutex
+        sf::Int64 receivedMicroseconds = 0;
+    };
+
+    const TableSpec& spec;
+    ShotServerSettings settings;
+    sf::Clock clock; // Read by every thread, the timestamps of the latency samples
+
+    // Network thread
+    std::thread network;
+    sf::TcpListener listener;
+    sf::SocketSelector selector;
+    std::vector<std::shared_ptr<Connection>> connections;
+    std::vector<std::shared_ptr<PendingRequest>> batch; // Decoded since the last hand-off
+    std::vector<sf::Uint8> networkFrame;
+
+    // Workers
+    std::vector<std::thread> workers;
+    std::vector<Simulation*> simulations; // One per worker, racked again for every shot
+    std::mutex queueMutex;
+    std::condition_variable workReady;
+    std::deque<std::shared_ptr<PendingRequest>> singles; // One-strike requests, oldest first, ahead of any batch shot
+    std::deque<std::shared_ptr<Connection>> ready; // Round robin, a connection goes to the back after each shot
+    int batchWorkers;    // Workers playing a batch shot right now
+    int maxBatchWorkers; // One below the workers and the cores, at least one
+    std::size_t queuedShots;
+    std::size_t maxQueuedShots;
+    std::atomic<bool> isRunning;
+
+    // Metrics
+    std::mutex statsMutex;
+    std::vector<sf::Uint32> latencySamples; // Rings of settings.sampleWindow
+    std::vector<sf::Uint32> serviceSamples;
+    std::size_t sampleCount;
+    std::atomic<sf::Uint64> requestCount;
+    std::atomic<sf::Uint64> shotCount;
+    std::atomic<sf::Uint64> rejectedCount;
+    std::atomic<std::size_t> connectionCount;
+
+    void run();
+    void acceptConnections();
+    bool receive(const std::shared_ptr<Connection>& connection); // False once the connection is gone
+    bool handleFrame(const std::shared_ptr<Connection>& connection, const sf::Uint8* data, std::size_t size);
+    void dispatchBatch();
+    void work(int index);
+    void evaluate(Simulation& simulation, const ShotQuery& query, int shot, std::vector<sf::Vector2f>& positions, ShotEvaluation& outcome) const;
+    void deliver(Connection& connection, const std::vector<sf::Uint8>& frame);
+    void flush(Connection& connection); // sendMutex held
+    void addSample(sf::Uint32 latency, sf::Uint32 service);
+
+public:
+    ShotServer(const TableSpec& spec, const ShotServerSettings& settings = ShotServerSettings());
+    ~ShotServer();
+    ShotServer(const ShotServer&) = delete;
+    ShotServer& operator=(const ShotServer&) = delete;
+
+    bool start();
+    void stop();
+
+    // Getter Functions
+    ShotServerStats getStats();
+    unsigned short getPort() const;
+};
+
+// Blocking client for front-ends written in C++ and for the benchmark
+class ShotClient {
+private:
+    sf::TcpSocket socket;
+    std::vector<sf::Uint8> sendBuffer;
+    std::vector<sf::Uint8> receiveBuffer;
+    std::size_t receiveOffset; // Start of the first frame not returned yet
+
+public:
+    ShotClient();
+
+    bool connect(unsigned short port = shotServerDefaultPort);
+    void disconnect();
+    bool send(const ShotQuery& query);
+    bool requestStats(sf::Uint32 requestId);
+    bool receive(ShotReply& reply); // Waits for the next frame, false once the server is gone
+};
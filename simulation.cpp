@@ -0,0 +1,313 @@
+#include "simulation.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* === Simulation Class Definition STARTS HERE === */
+
+Simulation::Simulation(const TableSpec& spec)
+    : spec(spec), physics(spec.physics()), ballPool(spec), table(spec), physicsStep(0), rackCount(0), collisionIntensity(0.0f), cueBallId(-1), ghostBall(-1) {
+    this->initHoles();
+}
+
+Simulation::~Simulation() {
+    for (Hole*& hole : holes) {
+        delete hole;
+        hole = nullptr;
+    }
+}
+
+void Simulation::initHoles() {
+    for (const sf::Vector2f& position : generateHolesPositions(spec)) {
+        holes.push_back(new Hole(position, spec));
+    }
+    this->initPocketCells();
+}
+
+void Simulation::initPocketCells() {
+    // Cells as wide as the capture radius, grown by one radius so pockets on the rails are covered
+    const float captureRadius = (spec.hole_radius + spec.ball_radius) * spec.hole_capture_factor;
+    const sf::Vector2f margin(captureRadius, captureRadius);
+    pocketGrid.configure(spec.table_offset() - margin, spec.table_dimension() + 2.0f * margin, captureRadius);
+    pocketCellMask.assign(static_cast<std::size_t>(pocketGrid.getColumns()) * pocketGrid.getRows(), 0);
+
+    for (size_t i = 0; i < holes.size() && i < 32; ++i) {
+        sf::Vector2f center = holes[i]->getPosition();
+        for (int row = pocketGrid.getRow(center.y - captureRadius); row <= pocketGrid.getRow(center.y + captureRadius); ++row) {
+            for (int column = pocketGrid.getColumn(center.x - captureRadius); column <= pocketGrid.getColumn(center.x + captureRadius); ++column) {
+                pocketCellMask[row * pocketGrid.getColumns() + column] |= sf::Uint32(1) << i;
+            }
+        }
+    }
+}
+
+void Simulation::rack(const std::vector<sf::Vector2f>& positions) {
+    const int ballCount = static_cast<int>(positions.size());
+    const int objectColorCount = spec.ballColorCount - 1; // The last palette entry is the cue ball
+
+    ballPool.reset(ballCount);
+    pocketEvents.clear();
+    pocketEvents.reserve(ballCount); // Every ball drops at most once a step, the step never allocates
+    physicsStep = 0;
+    ++rackCount;
+    collisionIntensity = 0.0f;
+    contactSolver.clear();
+    contactSolver.reserve(ballCount);
+
+    for (int i = 0; i < ballCount; ++i) {
+        if (i == ballCount - 1) {  // Last ball is the cue ball
+            ballPool.spawn(positions[i], spec.getBallColor(objectColorCount), BallType::Cue);
+        } else if (i == 7) {  // The 8th ball is the BlackBall
+            ballPool.spawn(positions[i], sf::Color::Black, BallType::Black);
+        } else if (i % 2 == 0) {  // Even-indexed balls as SolidBall
+            ballPool.spawn(positions[i], spec.getBallColor(i % objectColorCount), BallType::Solid);
+        } else {  // Odd-indexed balls as StripedBall
+            ballPool.spawn(positions[i], spec.getBallColor(i % objectColorCount), BallType::Striped);
+        }
+    }
+
+    cueBallId = ballCount - 1;
+    cueBallSpot = ballCount > 0 ? positions.back() : sf::Vector2f(0.f, 0.f);
+    ghostBall = -1;
+}
+
+void Simulation::strike(sf::Vector2f force) {
+    if (cueBallId < 0) return;
+    ballPool.get(cueBallId).applyForce(force);
+    ballPool.wake(cueBallId);
+}
+
+void Simulation::pocket(int id) {
+    if (id == cueBallId) {
+        ballPool.get(id).setVelocity({0, 0});
+        ballPool.place(id, cueBallSpot);
+    } else {
+        ballPool.pocket(id);
+    }
+}
+
+void Simulation::restoreStep(long long physicsStep) {
+    this->physicsStep = physicsStep;
+    pocketEvents.clear();
+    collisionIntensity = 0.0f;
+}
+
+void Simulation::callOff() {
+    while (!ballPool.getAwake().empty()) {
+        ballPool.sleep(ballPool.getAwake().back());
+    }
+}
+
+sf::Uint32 Simulation::getNearbyPockets(sf::Vector2f from, sf::Vector2f to) const {
+    int minColumn = pocketGrid.getColumn(std::min(from.x, to.x));
+    int maxColumn = pocketGrid.getColumn(std::max(from.x, to.x));
+    int minRow = pocketGrid.getRow(std::min(from.y, to.y));
+    int maxRow = pocketGrid.getRow(std::max(from.y, to.y));
+
+    // Paths longer than a couple of cells are rare, test them against every pocket
+    if (maxColumn - minColumn > 2 || maxRow - minRow > 2) {
+        return ~sf::Uint32(0);
+    }
+
+    sf::Uint32 mask = 0;
+    for (int row = minRow; row <= maxRow; ++row) {
+        for (int column = minColumn; column <= maxColumn; ++column) {
+            mask |= pocketCellMask[row * pocketGrid.getColumns() + column];
+        }
+    }
+    return mask;
+}
+
+template <const TableSpec& Spec>
+void Simulation::step() {
+    const std::vector<int>& awake = ballPool.getAwake();
+
+    // Only awake balls move, the ones that rested long enough are put to sleep
+    for (size_t k = 0; k < awake.size();) {
+        Ball& ball = ballPool.get(awake[k]);
+        ball.update<Spec>(table, physics); // Pass the Table object
+        ballPool.rebin(ball.id);
+
+        if (ball.getVelocity() != sf::Vector2f(0.f, 0.f)) {
+            ball.restFrames = 0;
+        } else if (++ball.restFrames >= Spec.sleepFrames) {
+            ballPool.sleep(ball.id); // Swap-removes, slot k now holds the next awake ball
+            continue;
+        }
+        ++k;
+    }
+
+    // Awake balls against their grid neighbours. The contacts are solved together afterwards,
+    // so the order in which they are found does not matter.
+    const float reach = Spec.ball_radius * 2 + 0.1f;
+    const size_t awakeCount = awake.size();
+    for (size_t k = 0; k < awakeCount; ++k) {
+        Ball& first = ballPool.get(awake[k]);
+
+        ballPool.getGrid().forEachNear(first.getPosition(), reach, [&](int otherId) {
+            // A pair of awake balls is tested once, from the ball with the lower awake slot
+            if (otherId == first.id || (ballPool.isAwake(otherId) && ballPool.getAwakeSlot(otherId) < static_cast<int>(k))) {
+                return;
+            }
+            // The ghost ball (the cue ball while it is dragged) touches nothing
+            if (first.id == ghostBall || otherId == ghostBall) {
+                return;
+            }
+            Ball& second = ballPool.get(otherId);
+
+            if (first.checkCollision<Spec>(second)) {
+                contactSolver.addContact(first.id, otherId);
+            }
+        });
+    }
+    contactSolver.solve<Spec>(ballPool, physics);
+
+    collisionIntensity = 0.0f;
+    for (std::size_t c = 0; c < contactSolver.getContactCount(); ++c) {
+        Ball& first = ballPool.get(contactSolver.getContactBall(c, false));
+        Ball& second = ballPool.get(contactSolver.getContactBall(c, true));
+
+        // Resting contacts only nudge positions, they must not keep the pair awake forever
+        if (first.getVelocity() == sf::Vector2f(0.f, 0.f) && second.getVelocity() == sf::Vector2f(0.f, 0.f)) {
+            continue;
+        }
+        ballPool.wake(first.id);
+        ballPool.wake(second.id);
+
+        if (contactSolver.getContactImpulse(c) > 0.0f) {
+            collisionIntensity = std::max(collisionIntensity, static_cast<float>(
+                std::sqrt(std::pow(first.getVelocity().x, 2) + std::pow(first.getVelocity().y, 2)) +
+                std::sqrt(std::pow(second.getVelocity().x, 2) + std::pow(second.getVelocity().y, 2))));
+        }
+    }
+
+    // Contacts nudge positions, keep the grid in step before the next frame queries it
+    for (int id : awake) {
+        ballPool.rebin(id);
+    }
+
+    // A sleeping ball cannot roll into a pocket, only the paths swept by awake balls are tested
+    pocketEvents.clear();
+    for (int id : awake) {
+        const Ball& ball = ballPool.get(id);
+        sf::Vector2f from = ball.getPreviousPosition();
+        sf::Vector2f to = ball.getPosition();
+
+        int enteredHole = -1;
+        float firstEntry = 2.0f;
+        sf::Uint32 nearby = getNearbyPockets(from, to);
+        for (size_t h = 0; h < holes.size() && h < 32; ++h) {
+            float entryTime;
+            if ((nearby >> h & 1) && holes[h]->template sweptCapture<Spec>(from, to, entryTime) && entryTime < firstEntry) {
+                enteredHole = static_cast<int>(h);
+                firstEntry = entryTime;
+            }
+        }
+
+        if (enteredHole >= 0) {
+            pocketEvents.push_back({ id, enteredHole, physicsStep + firstEntry, from + (to - from) * firstEntry });
+        }
+    }
+    std::sort(pocketEvents.begin(), pocketEvents.end(), [](const PocketEvent& a, const PocketEvent& b) {
+        return a.time < b.time;
+    });
+
+    for (const PocketEvent& event : pocketEvents) {
+        this->pocket(event.ballId);
+    }
+
+    ++physicsStep;
+}
+
+void Simulation::step() {
+    // Runs the physics specialized for this table, its constants are folded into the loops
+    visitTableSpec(spec, [&](auto tag) {
+        this->step<decltype(tag)::spec>();
+    });
+}
+
+// One step per table, like the Ball kernels
+template void Simulation::step<pool9ftTable>();
+template void Simulation::step<snookerTable>();
+template void Simulation::step<sandboxTable>();
+
+bool Simulation::isMoving() const {
+    // A ball only falls asleep after resting for spec.sleepFrames, so any awake ball counts as moving
+    return !ballPool.getAwake().empty();
+}
+
+// Getter Functions
+
+const TableSpec& Simulation::getSpec() const {
+    return spec;
+}
+
+const PhysicsParameters& Simulation::getPhysics() const {
+    return physics;
+}
+
+BallPool& Simulation::getBallPool() {
+    return ballPool;
+}
+
+const BallPool& Simulation::getBallPool() const {
+    return ballPool;
+}
+
+Table& Simulation::getTable() {
+    return table;
+}
+
+const std::vector<Hole*>& Simulation::getHoles() const {
+    return holes;
+}
+
+std::vector<sf::Vector2f> Simulation::getHolePositions() const {
+    std::vector<sf::Vector2f> positions;
+    for (const Hole* hole : holes) {
+        positions.push_back(hole->getPosition());
+    }
+    return positions;
+}
+
+ContactSolver& Simulation::getContactSolver() {
+    return contactSolver;
+}
+
+const ContactSolver& Simulation::getContactSolver() const {
+    return contactSolver;
+}
+
+const std::vector<PocketEvent>& Simulation::getPocketEvents() const {
+    return pocketEvents;
+}
+
+long long Simulation::getPhysicsStep() const {
+    return physicsStep;
+}
+
+int Simulation::getRackCount() const {
+    return rackCount;
+}
+
+float Simulation::getCollisionIntensity() const {
+    return collisionIntensity;
+}
+
+int Simulation::getCueBallId() const {
+    return cueBallId;
+}
+
+sf::Vector2f Simulation::getCueBallSpot() const {
+    return cueBallSpot;
+}
+
+// Setter Functions
+
+void Simulation::setGhostBall(int id) {
+    ghostBall = id;
+}
+
+void Simulation::setPhysics(const PhysicsParameters& physics) {
+    this->physics = physics;
+}
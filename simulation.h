@@ -0,0 +1,79 @@
+#pragma once
+
+#include "game.h"
+
+
+/*
+    Headless Table Simulation
+
+    The fixed-step physics of one table without a window, sound or input: the BallPool, the
+    Table cushions, the holes with their pocket cells and the ContactSolver. Game drives one
+    while playing, and anything that needs many tables at once (training environments,
+    batch evaluation) runs its own.
+
+    A step integrates the awake balls, solves their contacts together, captures every ball
+    whose swept path enters a pocket and records it as a PocketEvent. Pocketed object balls
+    leave the table, a pocketed cue ball goes back to its spot at rest.
+*/
+
+class Simulation {
+private:
+    const TableSpec& spec;
+    PhysicsParameters physics; // spec.physics() unless calibrated values are set
+    BallPool ballPool;
+    Table table;
+    std::vector<Hole*> holes;
+
+    // Pocket capture, every cell of pocketGrid holds a bit mask of the holes whose capture region touches it
+    SpatialGrid pocketGrid;
+    std::vector<sf::Uint32> pocketCellMask;
+    ContactSolver contactSolver;           // Resolves every ball contact of a step together
+    std::vector<PocketEvent> pocketEvents; // Pocketings of the last step, ordered by entry time
+    long long physicsStep;
+    int rackCount;            // Racks so far, a change tells observers the ball ids were reused
+    float collisionIntensity; // Closing speed of the hardest contact in the last step, 0 without one
+
+    int cueBallId;            // -1 before the first rack
+    sf::Vector2f cueBallSpot; // Where a pocketed cue ball is put back
+    int ghostBall;            // Left out of ball contacts (the cue ball while it is dragged), -1 for none
+
+    void initHoles();
+    void initPocketCells();
+    sf::Uint32 getNearbyPockets(sf::Vector2f from, sf::Vector2f to) const;
+
+public:
+    explicit Simulation(const TableSpec& spec = pool9ftTable);
+    ~Simulation();
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    void rack(const std::vector<sf::Vector2f>& positions); // The last position is the cue ball
+    void strike(sf::Vector2f force);                        // Cue hit, same units as Ball::applyForce
+    void pocket(int id);
+    void restoreStep(long long physicsStep); // After the balls were put back into an earlier state, forgets the last step's events
+    void callOff(); // Puts every awake ball to sleep where it is, ends a shot that never settles
+    template <const TableSpec& Spec> void step();
+    void step(); // step<Spec>() for the spec of this table
+    bool isMoving() const;
+
+    // Getter Functions
+    const TableSpec& getSpec() const;
+    const PhysicsParameters& getPhysics() const;
+    BallPool& getBallPool();
+    const BallPool& getBallPool() const;
+    Table& getTable();
+    const std::vector<Hole*>& getHoles() const;
+    std::vector<sf::Vector2f> getHolePositions() const;
+    ContactSolver& getContactSolver();
+    const ContactSolver& getContactSolver() const;
+    const std::vector<PocketEvent>& getPocketEvents() const;
+    long long getPhysicsStep() const;
+    int getRackCount() const;
+    float getCollisionIntensity() const;
+    int getCueBallId() const;
+    sf::Vector2f getCueBallSpot() const;
+
+    // Setter Functions
+    void setGhostBall(int id);
+    void setPhysics(const PhysicsParameters& physics);
+};
@@ -0,0 +1,102 @@
+#include "spatial_grid.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* === SpatialGrid Class Definition STARTS HERE === */
+
+SpatialGrid::SpatialGrid() : cellSize(1.0f), inverseCellSize(1.0f), columns(1), rows(1), cellHead(1, -1) {}
+
+void SpatialGrid::configure(sf::Vector2f origin, sf::Vector2f size, float cellSize) {
+    this->origin = origin;
+    this->cellSize = cellSize;
+    this->inverseCellSize = 1.0f / cellSize;
+    this->columns = std::max(1, static_cast<int>(std::ceil(size.x / cellSize)));
+    this->rows = std::max(1, static_cast<int>(std::ceil(size.y / cellSize)));
+    cellHead.assign(static_cast<std::size_t>(columns) * rows, -1);
+    std::fill(cellOfId.begin(), cellOfId.end(), -1);
+}
+
+void SpatialGrid::reserveIds(std::size_t idCount) {
+    if (nextInCell.size() < idCount) {
+        nextInCell.resize(idCount, -1);
+        prevInCell.resize(idCount, -1);
+        cellOfId.resize(idCount, -1);
+    }
+}
+
+void SpatialGrid::clear() {
+    std::fill(cellHead.begin(), cellHead.end(), -1);
+    std::fill(cellOfId.begin(), cellOfId.end(), -1);
+}
+
+void SpatialGrid::insert(int id, sf::Vector2f position) {
+    if (static_cast<std::size_t>(id) >= nextInCell.size()) {
+        reserveIds(std::max<std::size_t>(id + 1, nextInCell.size() * 2));
+    }
+    int cell = cellOf(position);
+    nextInCell[id] = cellHead[cell];
+    prevInCell[id] = -1;
+    if (cellHead[cell] >= 0) prevInCell[cellHead[cell]] = id;
+    cellHead[cell] = id;
+    cellOfId[id] = cell;
+}
+
+void SpatialGrid::remove(int id) {
+    if (static_cast<std::size_t>(id) >= cellOfId.size() || cellOfId[id] < 0) return;
+
+    int next = nextInCell[id];
+    int prev = prevInCell[id];
+    if (prev >= 0) {
+        nextInCell[prev] = next;
+    } else {
+        cellHead[cellOfId[id]] = next;
+    }
+    if (next >= 0) prevInCell[next] = prev;
+
+    nextInCell[id] = -1;
+    prevInCell[id] = -1;
+    cellOfId[id] = -1;
+}
+
+void SpatialGrid::move(int id, sf::Vector2f position) {
+    if (static_cast<std::size_t>(id) < cellOfId.size() && cellOfId[id] == cellOf(position)) return;
+    remove(id);
+    insert(id, position);
+}
+
+// Getter Functions
+
+int SpatialGrid::cellOf(sf::Vector2f position) const {
+    return getRow(position.y) * columns + getColumn(position.x);
+}
+
+int SpatialGrid::getColumn(float x) const {
+    int column = static_cast<int>(std::floor((x - origin.x) * inverseCellSize));
+    return std::max(0, std::min(columns - 1, column)); // Balls outside the bounds share the border cells
+}
+
+int SpatialGrid::getRow(float y) const {
+    int row = static_cast<int>(std::floor((y - origin.y) * inverseCellSize));
+    return std::max(0, std::min(rows - 1, row));
+}
+
+int SpatialGrid::getColumns() const {
+    return columns;
+}
+
+int SpatialGrid::getRows() const {
+    return rows;
+}
+
+float SpatialGrid::getCellSize() const {
+    return cellSize;
+}
+
+int SpatialGrid::getCellHead(int cell) const {
+    return cellHead[cell];
+}
+
+int SpatialGrid::getNextInCell(int id) const {
+    return nextInCell[id];
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <SFML\System.hpp>
+#include <vector>
+
+
+/*
+    Uniform grid over a rectangle, used as the spatial index for rack generation and the
+    broadphase. Every cell keeps an intrusive doubly linked list of ids, so insert, remove
+    and move are O(1), clear() only resets the cell heads, and nothing is allocated once the
+    grid is configured and has seen its largest id.
+*/
+class SpatialGrid {
+private:
+    sf::Vector2f origin;
+    float cellSize;
+    float inverseCellSize;
+    int columns;
+    int rows;
+    std::vector<int> cellHead;   // First id in each cell, -1 when empty
+    std::vector<int> nextInCell; // Next id in the same cell, indexed by id
+    std::vector<int> prevInCell; // Previous id in the same cell, -1 for the cell head
+    std::vector<int> cellOfId;   // Cell each id is stored in, -1 when not in the grid
+
+public:
+    SpatialGrid();
+
+    void configure(sf::Vector2f origin, sf::Vector2f size, float cellSize);
+    void reserveIds(std::size_t idCount);
+    void clear();
+    void insert(int id, sf::Vector2f position);
+    void remove(int id);
+    void move(int id, sf::Vector2f position); // Only relinks when the id changes cell
+
+    // Calls callback(id) for every id stored in a cell touched by the square around position
+    template <class Callback>
+    void forEachNear(sf::Vector2f position, float radius, Callback&& callback) const;
+
+    // Getter Functions
+    int cellOf(sf::Vector2f position) const;
+    int getColumn(float x) const;
+    int getRow(float y) const;
+    int getColumns() const;
+    int getRows() const;
+    float getCellSize() const;
+    int getCellHead(int cell) const;
+    int getNextInCell(int id) const;
+};
+
+
+template <class Callback>
+void SpatialGrid::forEachNear(sf::Vector2f position, float radius, Callback&& callback) const {
+    int minColumn = getColumn(position.x - radius);
+    int maxColumn = getColumn(position.x + radius);
+    int minRow = getRow(position.y - radius);
+    int maxRow = getRow(position.y + radius);
+
+    for (int row = minRow; row <= maxRow; ++row) {
+        for (int column = minColumn; column <= maxColumn; ++column) {
+            for (int id = cellHead[row * columns + column]; id >= 0; id = nextInCell[id]) {
+                callback(id);
+            }
+        }
+    }
+}
@@ -0,0 +1,655 @@
+#include "spectator.h"
+#include "logger.h"
+
+
+/* === Wire Helper Functions === */
+
+namespace {
+
+void writeU8(std::vector<sf::Uint8>& out, sf::Uint8 value) {
+    out.push_back(value);
+}
+
+void writeU16(std::vector<sf::Uint8>& out, sf::Uint16 value) {
+    out.push_back(static_cast<sf::Uint8>(value & 0xFF));
+    out.push_back(static_cast<sf::Uint8>(value >> 8));
+}
+
+void writeU32(std::vector<sf::Uint8>& out, sf::Uint32 value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<sf::Uint8>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void patchU16(std::vector<sf::Uint8>& out, std::size_t offset, sf::Uint16 value) {
+    out[offset] = static_cast<sf::Uint8>(value & 0xFF);
+    out[offset + 1] = static_cast<sf::Uint8>(value >> 8);
+}
+
+void patchU32(std::vector<sf::Uint8>& out, std::size_t offset, sf::Uint32 value) {
+    for (int i = 0; i < 4; ++i) {
+        out[offset + i] = static_cast<sf::Uint8>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+sf::Uint16 readU16(const sf::Uint8* data) {
+    return static_cast<sf::Uint16>(data[0] | (data[1] << 8));
+}
+
+sf::Uint32 readU32(const sf::Uint8* data) {
+    return static_cast<sf::Uint32>(data[0]) | (static_cast<sf::Uint32>(data[1]) << 8) |
+           (static_cast<sf::Uint32>(data[2]) << 16) | (static_cast<sf::Uint32>(data[3]) << 24);
+}
+
+sf::Uint16 quantize(float value) {
+    float scaled = std::round(value * spectatorPositionScale);
+    return static_cast<sf::Uint16>(std::max(0.0f, std::min(65535.0f, scaled)));
+}
+
+float dequantize(sf::Uint16 value) {
+    return value / spectatorPositionScale;
+}
+
+// Frame header layout: [u32 length][u8 type][u32 tick][u16 count]
+const std::size_t frameHeaderSize = 4 + 1 + 4 + 2;
+const std::size_t frameCountOffset = 4 + 1 + 4;
+
+void beginFrame(std::vector<sf::Uint8>& out, sf::Uint8 type, sf::Uint32 tick) {
+    out.clear();
+    writeU32(out, 0); // Patched once the frame is complete
+    writeU8(out, type);
+    writeU32(out, tick);
+    writeU16(out, 0);
+}
+
+void endFrame(std::vector<sf::Uint8>& out, sf::Uint16 count) {
+    patchU32(out, 0, static_cast<sf::Uint32>(out.size() - 4));
+    patchU16(out, frameCountOffset, count);
+}
+
+void writeSpawn(std::vector<sf::Uint8>& out, sf::Uint16 id, sf::Uint8 kind, sf::Color color, sf::Uint16 qx, sf::Uint16 qy) {
+    writeU16(out, id);
+    writeU8(out, SpectatorSpawn);
+    writeU8(out, kind);
+    writeU8(out, color.r);
+    writeU8(out, color.g);
+    writeU8(out, color.b);
+    writeU16(out, qx);
+    writeU16(out, qy);
+}
+
+} // namespace
+
+
+/* === SpectatorEncoder Class Definition STARTS HERE === */
+
+SpectatorEncoder::SpectatorEncoder(const TableSpec& spec, int quantThreshold) : quantThreshold(std::max(1, quantThreshold)) {
+    // Tells every new viewer which table to draw
+    std::string name = spec.name;
+    beginFrame(tableFrame, SpectatorTable, 0);
+    writeU8(tableFrame, static_cast<sf::Uint8>(name.size()));
+    tableFrame.insert(tableFrame.end(), name.begin(), name.end());
+    endFrame(tableFrame, 0);
+}
+
+void SpectatorEncoder::encodeTick(const std::vector<SpectatorBall>& snapshot) {
+    ++tick;
+    ++ticksSinceKeyframe;
+
+    beginFrame(deltaFrame, SpectatorDelta, tick);
+    sf::Uint16 count = 0;
+
+    for (const SpectatorBall& ball : snapshot) {
+        if (ball.id >= sentState.size()) {
+            sentState.resize(ball.id + 1);
+        }
+        BallState& state = sentState[ball.id];
+        state.lastSeenTick = tick;
+
+        sf::Uint16 qx = quantize(ball.position.x);
+        sf::Uint16 qy = quantize(ball.position.y);
+
+        if (!state.known || !state.onTable || state.kind != ball.kind || state.color != ball.color) {
+            state.known = true;
+            state.onTable = true;
+            state.kind = ball.kind;
+            state.color = ball.color;
+            state.qx = qx;
+            state.qy = qy;
+            writeSpawn(deltaFrame, ball.id, state.kind, state.color, qx, qy);
+            ++count;
+        } else if (std::abs(qx - state.qx) >= quantThreshold || std::abs(qy - state.qy) >= quantThreshold) {
+            state.qx = qx;
+            state.qy = qy;
+            writeU16(deltaFrame, ball.id);
+            writeU8(deltaFrame, 0);
+            writeU16(deltaFrame, qx);
+            writeU16(deltaFrame, qy);
+            ++count;
+        }
+    }
+
+    // Balls missing from the snapshot left the table
+    for (std::size_t id = 0; id < sentState.size(); ++id) {
+        BallState& state = sentState[id];
+        if (state.known && state.onTable && state.lastSeenTick != tick) {
+            state.onTable = false;
+            writeU16(deltaFrame, static_cast<sf::Uint16>(id));
+            writeU8(deltaFrame, SpectatorRemoved);
+            ++count;
+        }
+    }
+
+    endFrame(deltaFrame, count);
+    changedSinceKeyframe = changedSinceKeyframe || count > 0;
+}
+
+void SpectatorEncoder::encodeKeyframe() {
+    beginFrame(keyframeFrame, SpectatorKeyframe, tick);
+    sf::Uint16 count = 0;
+    for (std::size_t id = 0; id < sentState.size(); ++id) {
+        const BallState& state = sentState[id];
+        if (state.known && state.onTable) {
+            writeSpawn(keyframeFrame, static_cast<sf::Uint16>(id), state.kind, state.color, state.qx, state.qy);
+            ++count;
+        }
+    }
+    endFrame(keyframeFrame, count);
+}
+
+bool SpectatorEncoder::isKeyframeDue(int keyframeInterval) const {
+    return ticksSinceKeyframe >= keyframeInterval && changedSinceKeyframe;
+}
+
+void SpectatorEncoder::markKeyframeSent() {
+    ticksSinceKeyframe = 0;
+    changedSinceKeyframe = false;
+}
+
+// Getter Functions
+
+const std::vector<sf::Uint8>& SpectatorEncoder::getDeltaFrame() const {
+    return deltaFrame;
+}
+
+const std::vector<sf::Uint8>& SpectatorEncoder::getKeyframeFrame() const {
+    return keyframeFrame;
+}
+
+const std::vector<sf::Uint8>& SpectatorEncoder::getTableFrame() const {
+    return tableFrame;
+}
+
+bool SpectatorEncoder::hasDelta() const {
+    return readU16(&deltaFrame[frameCountOffset]) > 0;
+}
+
+sf::Uint32 SpectatorEncoder::getTick() const {
+    return tick;
+}
+
+
+/* === SpectatorDecoder Class Definition STARTS HERE === */
+
+SpectatorDecoder::SpectatorDecoder() : spec(&pool9ftTable), lastTick(0), synced(false) {}
+
+bool SpectatorDecoder::apply(const sf::Uint8* data, std::size_t size) {
+    if (size < frameHeaderSize - 4) return false;
+
+    sf::Uint8 type = data[0];
+    sf::Uint32 tick = readU32(data + 1);
+    sf::Uint16 count = readU16(data + 5);
+
+    if (type == SpectatorTable) {
+        if (size < 8 || size < 8u + data[7]) return false;
+        std::string name(reinterpret_cast<const char*>(data + 8), data[7]);
+        const TableSpec* tableSpec = findTableSpec(name);
+        if (!tableSpec) {
+            BILLIARD_LOG(Error, Network) << "Spectator stream uses an unknown table: " << name;
+            return false;
+        }
+
+        // Ball styling depends on the spec, the next keyframe respawns them
+        spec = tableSpec;
+        std::fill(ballOnTable.begin(), ballOnTable.end(), false);
+        synced = false;
+        return true;
+    }
+
+    if (type == SpectatorKeyframe) {
+        std::fill(ballOnTable.begin(), ballOnTable.end(), false);
+        synced = true;
+    } else if (!synced) {
+        return true; // Deltas are meaningless until the first keyframe arrives
+    }
+    lastTick = tick;
+
+    std::size_t offset = 7;
+    for (sf::Uint16 i = 0; i < count; ++i) {
+        if (offset + 3 > size) return false;
+        sf::Uint16 id = readU16(data + offset);
+        sf::Uint8 flags = data[offset + 2];
+        offset += 3;
+
+        if (id >= balls.size()) {
+            balls.resize(id + 1);
+            ballOnTable.resize(id + 1, false);
+            balls[id].id = id;
+        }
+
+        if (flags & SpectatorSpawn) {
+            if (offset + 4 > size) return false;
+            balls[id].id = id;
+            balls[id].kind = data[offset] <= static_cast<sf::Uint8>(BallType::Black) ? data[offset] : static_cast<sf::Uint8>(BallType::Cue);
+            balls[id].color = sf::Color(data[offset + 1], data[offset + 2], data[offset + 3]);
+            offset += 4;
+        }
+
+        if (flags & SpectatorRemoved) {
+            ballOnTable[id] = false;
+            continue;
+        }
+
+        if (offset + 4 > size) return false;
+        balls[id].position = sf::Vector2f(dequantize(readU16(data + offset)), dequantize(readU16(data + offset + 2)));
+        ballOnTable[id] = true;
+        offset += 4;
+    }
+    return true;
+}
+
+std::size_t SpectatorDecoder::applyStream(const sf::Uint8* data, std::size_t size, bool& tableChanged) {
+    std::size_t offset = 0;
+    while (size - offset >= 4) {
+        sf::Uint32 length = readU32(data + offset);
+        if (size - offset - 4 < length) break;
+
+        if (apply(data + offset + 4, length) && length > 0 && data[offset + 4] == SpectatorTable) {
+            tableChanged = true;
+        }
+        offset += 4 + length;
+    }
+    return offset;
+}
+
+// Getter Functions
+
+const TableSpec& SpectatorDecoder::getSpec() const {
+    return *spec;
+}
+
+const std::vector<SpectatorBall>& SpectatorDecoder::getBalls() const {
+    return balls;
+}
+
+bool SpectatorDecoder::isOnTable(std::size_t id) const {
+    return id < ballOnTable.size() && ballOnTable[id];
+}
+
+sf::Uint32 SpectatorDecoder::getLastTick() const {
+    return lastTick;
+}
+
+bool SpectatorDecoder::isSynced() const {
+    return synced;
+}
+
+
+/* === SpectatorServer Class Definition STARTS HERE === */
+
+SpectatorServer::SpectatorServer(const TableSpec& spec, unsigned short port, float broadcastRate, int keyframeInterval, int quantThreshold)
+    : spec(spec),
+      port(port),
+      broadcastRate(std::max(1.0f, broadcastRate)),
+      keyframeInterval(std::max(1, keyframeInterval)),
+      maxOutboxBytes(1 << 20),
+      isRunning(false),
+      encoder(spec, quantThreshold),
+      viewerCount(0),
+      totalBytesSent(0) {}
+
+SpectatorServer::~SpectatorServer() {
+    stop();
+}
+
+bool SpectatorServer::start() {
+    if (listener.listen(port) != sf::Socket::Done) {
+        BILLIARD_LOG(Error, Network) << "Failed to listen for spectators on port " << port;
+        return false;
+    }
+    listener.setBlocking(false);
+
+    isRunning = true;
+    worker = std::thread(&SpectatorServer::run, this);
+    BILLIARD_LOG(Info, Network) << "Spectator server listening on port " << port << " at " << broadcastRate << " Hz";
+    return true;
+}
+
+void SpectatorServer::stop() {
+    if (!isRunning) return;
+
+    isRunning = false;
+    snapshotReady.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    listener.close();
+    viewers.clear();
+    viewerCount = 0;
+}
+
+void SpectatorServer::publish(const BallPool& ballPool) {
+    if (!isRunning) return;
+    if (broadcastClock.getElapsedTime().asSeconds() < 1.0f / broadcastRate) return;
+    broadcastClock.restart();
+
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        pendingSnapshot.clear();
+        for (int id : ballPool.getOnTable()) {
+            const Ball& ball = ballPool.get(id);
+            SpectatorBall snapshot;
+            snapshot.id = static_cast<sf::Uint16>(ball.id);
+            snapshot.kind = static_cast<sf::Uint8>(ball.type);
+            snapshot.color = ball.shape.getFillColor();
+            snapshot.position = ball.getPosition();
+            pendingSnapshot.push_back(snapshot);
+        }
+        hasPendingSnapshot = true;
+    }
+    snapshotReady.notify_one();
+}
+
+void SpectatorServer::run() {
+    while (isRunning) {
+        bool hasSnapshot = false;
+        {
+            std::unique_lock<std::mutex> lock(snapshotMutex);
+            snapshotReady.wait_for(lock, std::chrono::milliseconds(5), [this] {
+                return hasPendingSnapshot || !isRunning;
+            });
+            if (hasPendingSnapshot) {
+                workingSnapshot.swap(pendingSnapshot);
+                hasPendingSnapshot = false;
+                hasSnapshot = true;
+            }
+        }
+
+        acceptViewers();
+
+        if (hasSnapshot) {
+            encoder.encodeTick(workingSnapshot);
+
+            bool sendKeyframe = encoder.isKeyframeDue(keyframeInterval);
+            bool anyUnsynced = false;
+            for (const auto& viewer : viewers) {
+                anyUnsynced = anyUnsynced || !viewer->synced;
+            }
+
+            // The keyframe is encoded after this tick's delta was applied, so it is valid for everyone
+            if (sendKeyframe || anyUnsynced) {
+                encoder.encodeKeyframe();
+            }
+            if (sendKeyframe) {
+                encoder.markKeyframeSent();
+            }
+
+            bool hasDelta = encoder.hasDelta();
+            for (const auto& viewer : viewers) {
+                if (!viewer->synced) {
+                    queueFrame(*viewer, encoder.getTableFrame());
+                }
+                if (!viewer->synced || sendKeyframe) {
+                    queueFrame(*viewer, encoder.getKeyframeFrame());
+                    viewer->synced = true;
+                } else if (hasDelta) {
+                    queueFrame(*viewer, encoder.getDeltaFrame());
+                }
+            }
+        }
+
+        for (const auto& viewer : viewers) {
+            flushViewer(*viewer);
+        }
+
+        std::size_t before = viewers.size();
+        viewers.erase(std::remove_if(viewers.begin(), viewers.end(), [](const std::unique_ptr<Viewer>& viewer) {
+            return viewer->disconnected;
+        }), viewers.end());
+        if (viewers.size() != before) {
+            BILLIARD_LOG(Info, Network) << "Spectator disconnected, " << viewers.size() << " watching";
+        }
+        viewerCount = viewers.size();
+    }
+}
+
+void SpectatorServer::acceptViewers() {
+    while (true) {
+        std::unique_ptr<Viewer> viewer(new Viewer());
+        if (listener.accept(viewer->socket) != sf::Socket::Done) {
+            break;
+        }
+        viewer->socket.setBlocking(false);
+        BILLIARD_LOG(Info, Network) << "Spectator connected from " << viewer->socket.getRemoteAddress().toString();
+        viewers.push_back(std::move(viewer));
+    }
+}
+
+void SpectatorServer::queueFrame(Viewer& viewer, const std::vector<sf::Uint8>& frame) {
+    if (viewer.outbox.size() - viewer.sentBytes + frame.size() > maxOutboxBytes) {
+        // A viewer this far behind would only ever see stale state, let it reconnect
+        BILLIARD_LOG(Info, Network) << "Spectator fell too far behind, dropping it";
+        viewer.disconnected = true;
+        return;
+    }
+    viewer.outbox.insert(viewer.outbox.end(), frame.begin(), frame.end());
+}
+
+void SpectatorServer::flushViewer(Viewer& viewer) {
+    if (viewer.disconnected || viewer.sentBytes == viewer.outbox.size()) return;
+
+    std::size_t sent = 0;
+    sf::Socket::Status status = viewer.socket.send(viewer.outbox.data() + viewer.sentBytes,
+                                                   viewer.outbox.size() - viewer.sentBytes, sent);
+    if (status == sf::Socket::Disconnected || status == sf::Socket::Error) {
+        viewer.disconnected = true;
+        return;
+    }
+
+    viewer.sentBytes += sent;
+    totalBytesSent += sent;
+    if (viewer.sentBytes == viewer.outbox.size()) {
+        viewer.outbox.clear();
+        viewer.sentBytes = 0;
+    }
+}
+
+// Getter Functions
+
+std::size_t SpectatorServer::getViewerCount() const {
+    return viewerCount;
+}
+
+sf::Uint64 SpectatorServer::getBytesSent() const {
+    return totalBytesSent;
+}
+
+
+/* === MatchRecorder Class Definition STARTS HERE === */
+
+MatchRecorder::MatchRecorder(const TableSpec& spec, int keyframeInterval)
+    : encoder(spec, 1), keyframeInterval(std::max(1, keyframeInterval)), started(false) {}
+
+bool MatchRecorder::open(const std::string& path) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        BILLIARD_LOG(Error, Network) << "Failed to open " << path << " for recording";
+        return false;
+    }
+    started = false;
+    BILLIARD_LOG(Info, Network) << "Recording the match to " << path;
+    return true;
+}
+
+void MatchRecorder::write(const std::vector<sf::Uint8>& frame) {
+    file.write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(frame.size()));
+}
+
+void MatchRecorder::record(const BallPool& ballPool) {
+    if (!file.is_open()) return;
+
+    snapshot.clear();
+    for (int id : ballPool.getOnTable()) {
+        const Ball& ball = ballPool.get(id);
+        SpectatorBall state;
+        state.id = static_cast<sf::Uint16>(ball.id);
+        state.kind = static_cast<sf::Uint8>(ball.type);
+        state.color = ball.shape.getFillColor();
+        state.position = ball.getPosition();
+        snapshot.push_back(state);
+    }
+    encoder.encodeTick(snapshot);
+
+    // Every tick is written, an unchanged tick is an empty delta so the file keeps the timing
+    if (!started || encoder.isKeyframeDue(keyframeInterval)) {
+        if (!started) write(encoder.getTableFrame());
+        encoder.encodeKeyframe();
+        encoder.markKeyframeSent();
+        write(encoder.getKeyframeFrame());
+        started = true;
+    } else {
+        write(encoder.getDeltaFrame());
+    }
+}
+
+// Getter Functions
+
+sf::Uint32 MatchRecorder::getTick() const {
+    return encoder.getTick();
+}
+
+
+/* === SpectatorViewer Class Definition STARTS HERE === */
+
+SpectatorViewer::SpectatorViewer() : spec(&pool9ftTable), window(nullptr), connected(false) {
+    this->initWindow();
+    this->initTable(pool9ftTable);
+}
+
+SpectatorViewer::~SpectatorViewer() {
+    delete this->window;
+    for (auto& hole : holes) {
+        delete hole;
+        hole = nullptr;
+    }
+}
+
+void SpectatorViewer::initWindow() {
+    this->window = new sf::RenderWindow(sf::VideoMode(spec->window_width, spec->window_height), "Billiard Simulation - Spectator");
+    this->window->setFramerateLimit(spec->frLimit);
+}
+
+void SpectatorViewer::initTable(const TableSpec& tableSpec) {
+    spec = &tableSpec;
+    table = Table(tableSpec);
+
+    for (auto& hole : holes) {
+        delete hole;
+    }
+    holes.clear();
+    for (const sf::Vector2f& position : generateHolesPositions(tableSpec)) {
+        holes.push_back(new Hole(position, tableSpec));
+    }
+
+    // Ball styling depends on the spec, restyle every slot on its next draw
+    balls.clear();
+}
+
+bool SpectatorViewer::connect(const sf::IpAddress& address, unsigned short port) {
+    if (socket.connect(address, port, sf::seconds(5)) != sf::Socket::Done) {
+        BILLIARD_LOG(Error, Network) << "Failed to connect to spectator server " << address.toString() << ":" << port;
+        return false;
+    }
+    socket.setBlocking(false);
+    connected = true;
+    BILLIARD_LOG(Info, Network) << "Watching " << address.toString() << ":" << port;
+    return true;
+}
+
+void SpectatorViewer::syncBall(const SpectatorBall& state) {
+    BallType type = static_cast<BallType>(state.kind);
+
+    while (balls.size() <= state.id) {
+        balls.emplace_back(sf::Vector2f(0.0f, 0.0f), state.color, type, *spec);
+        balls.back().id = static_cast<int>(balls.size() - 1);
+    }
+
+    Ball& ball = balls[state.id];
+    if (ball.type != type || ball.shape.getFillColor() != state.color) {
+        ball.reset(state.position, state.color, type, *spec);
+    }
+    ball.setPosition(state.position);
+}
+
+void SpectatorViewer::receiveFrames() {
+    if (!connected) return;
+
+    sf::Uint8 chunk[4096];
+    while (true) {
+        std::size_t received = 0;
+        sf::Socket::Status status = socket.receive(chunk, sizeof(chunk), received);
+        if (status == sf::Socket::Disconnected || status == sf::Socket::Error) {
+            BILLIARD_LOG(Info, Network) << "Spectator server closed the stream";
+            connected = false;
+            break;
+        }
+        if (received == 0) break;
+        receiveBuffer.insert(receiveBuffer.end(), chunk, chunk + received);
+    }
+
+    bool tableChanged = false;
+    std::size_t offset = decoder.applyStream(receiveBuffer.data(), receiveBuffer.size(), tableChanged);
+    if (tableChanged) {
+        initTable(decoder.getSpec());
+    }
+    receiveBuffer.erase(receiveBuffer.begin(), receiveBuffer.begin() + offset);
+}
+
+// Getter Functions
+bool SpectatorViewer::running() const {
+    return this->window && this->window->isOpen();
+}
+
+// Functions
+void SpectatorViewer::pollEvents() {
+    while (this->window->pollEvent(this->ev)) {
+        if (this->ev.type == sf::Event::Closed) {
+            this->window->close();
+        }
+    }
+}
+
+void SpectatorViewer::update() {
+    this->pollEvents();
+    this->receiveFrames();
+}
+
+void SpectatorViewer::render() {
+    this->window->clear(sf::Color(spec->window_color));
+
+    table.draw(*this->window);
+
+    for (Hole* hole : holes) {
+        hole->draw(*this->window);
+    }
+
+    const std::vector<SpectatorBall>& states = decoder.getBalls();
+    for (std::size_t id = 0; id < states.size(); ++id) {
+        if (decoder.isOnTable(id)) {
+            this->syncBall(states[id]);
+            balls[id].draw(*this->window);
+        }
+    }
+
+    this->window->display();
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "game.h"
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+    Spectator Broadcast
+
+    One authoritative Game streams its ball state to any number of viewers over TCP.
+    Every frame on the wire is length-prefixed:
+
+        [u32 length][u8 frameType][u32 tick][u16 recordCount][records...]
+
+    A record is [u16 id][u8 flags] followed by [u8 BallType][u8 r][u8 g][u8 b] when the
+    Spawn flag is set and by [u16 x][u16 y] unless the Removed flag is set.
+    Positions are quantized to 1 / spectatorPositionScale of a pixel.
+
+    A recorded match (MatchRecorder) is this stream written to a file at one tick per frame
+    of the recording game.
+*/
+
+enum SpectatorFrameType : sf::Uint8 {
+    SpectatorKeyframe = 1, // Complete table state, replaces everything the viewer holds
+    SpectatorDelta = 2,    // Only the balls that moved, appeared or got pocketed since the last tick
+    SpectatorTable = 3     // Sent once on connect, the record count field carries no records and the name of the TableSpec follows
+};
+
+enum SpectatorRecordFlags : sf::Uint8 {
+    SpectatorRemoved = 1 << 0,
+    SpectatorSpawn = 1 << 1
+};
+
+const float spectatorPositionScale = 8.0f;
+const unsigned short spectatorDefaultPort = 53000;
+
+
+// One ball as the stream carries it
+struct SpectatorBall {
+    sf::Uint16 id = 0;
+    sf::Uint8 kind = static_cast<sf::Uint8>(BallType::Cue);
+    sf::Color color;
+    sf::Vector2f position;
+};
+
+// Turns ball snapshots into the frames above, tracking what the receiving side already holds
+class SpectatorEncoder {
+private:
+    // What the receiving side currently believes about a ball
+    struct BallState {
+        sf::Uint16 qx = 0, qy = 0;
+        sf::Uint8 kind = static_cast<sf::Uint8>(BallType::Cue);
+        sf::Color color;
+        bool known = false;
+        bool onTable = false;
+        sf::Uint32 lastSeenTick = 0;
+    };
+
+    int quantThreshold;
+    std::vector<BallState> sentState;
+    std::vector<sf::Uint8> deltaFrame;
+    std::vector<sf::Uint8> keyframeFrame;
+    std::vector<sf::Uint8> tableFrame;
+    sf::Uint32 tick = 0;
+    int ticksSinceKeyframe = 0;
+    bool changedSinceKeyframe = false;
+
+public:
+    SpectatorEncoder(const TableSpec& spec, int quantThreshold);
+
+    void encodeTick(const std::vector<SpectatorBall>& snapshot); // Advances the tick and builds its delta
+    void encodeKeyframe();                                        // Complete state as of the last tick
+    bool isKeyframeDue(int keyframeInterval) const;
+    void markKeyframeSent();
+
+    // Getter Functions
+    const std::vector<sf::Uint8>& getDeltaFrame() const;
+    const std::vector<sf::Uint8>& getKeyframeFrame() const;
+    const std::vector<sf::Uint8>& getTableFrame() const;
+    bool hasDelta() const;
+    sf::Uint32 getTick() const;
+};
+
+// Rebuilds the table state from frames, the inverse of SpectatorEncoder
+class SpectatorDecoder {
+private:
+    const TableSpec* spec;
+    std::vector<SpectatorBall> balls; // Indexed by ball id
+    std::vector<bool> ballOnTable;
+    sf::Uint32 lastTick;
+    bool synced;
+
+public:
+    SpectatorDecoder();
+
+    // One frame without its length prefix, false when it was malformed or names an unknown table
+    bool apply(const sf::Uint8* data, std::size_t size);
+    // Splits a byte stream into frames, returns how many bytes were consumed
+    std::size_t applyStream(const sf::Uint8* data, std::size_t size, bool& tableChanged);
+
+    // Getter Functions
+    const TableSpec& getSpec() const;
+    const std::vector<SpectatorBall>& getBalls() const;
+    bool isOnTable(std::size_t id) const;
+    sf::Uint32 getLastTick() const;
+    bool isSynced() const;
+};
+
+class SpectatorServer {
+private:
+    struct Viewer {
+        sf::TcpSocket socket;
+        std::vector<sf::Uint8> outbox;
+        std::size_t sentBytes = 0;
+        bool synced = false;
+        bool disconnected = false;
+    };
+
+    const TableSpec& spec;
+    unsigned short port;
+    float broadcastRate;
+    int keyframeInterval;
+    std::size_t maxOutboxBytes;
+
+    sf::TcpListener listener;
+    std::vector<std::unique_ptr<Viewer>> viewers;
+
+    // Hand-off between the simulation thread and the network thread
+    std::thread worker;
+    std::mutex snapshotMutex;
+    std::condition_variable snapshotReady;
+    std::vector<SpectatorBall> pendingSnapshot;
+    std::vector<SpectatorBall> workingSnapshot;
+    bool hasPendingSnapshot = false;
+    std::atomic<bool> isRunning;
+    sf::Clock broadcastClock;
+
+    // Network thread state
+    SpectatorEncoder encoder;
+
+    std::atomic<std::size_t> viewerCount;
+    std::atomic<sf::Uint64> totalBytesSent;
+
+    void run();
+    void acceptViewers();
+    void queueFrame(Viewer& viewer, const std::vector<sf::Uint8>& frame);
+    void flushViewer(Viewer& viewer);
+
+public:
+    SpectatorServer(const TableSpec& spec, unsigned short port, float broadcastRate, int keyframeInterval, int quantThreshold);
+    ~SpectatorServer();
+
+    bool start();
+    void stop();
+
+    // Called by the simulation once per frame, only copies the ball state when a broadcast tick is due
+    void publish(const BallPool& ballPool);
+
+    // Getter Functions
+    std::size_t getViewerCount() const;
+    sf::Uint64 getBytesSent() const;
+};
+
+/*
+    Writes the same stream a viewer receives to a file, one tick per game frame, so a match
+    can be replayed or rendered later. The file starts with the table frame and a keyframe,
+    and repeats a keyframe every keyframeInterval ticks so a reader can seek.
+*/
+class MatchRecorder {
+private:
+    std::ofstream file;
+    SpectatorEncoder encoder;
+    std::vector<SpectatorBall> snapshot;
+    int keyframeInterval;
+    bool started;
+
+    void write(const std::vector<sf::Uint8>& frame);
+
+public:
+    MatchRecorder(const TableSpec& spec, int keyframeInterval);
+
+    bool open(const std::string& path);
+    void record(const BallPool& ballPool);
+
+    // Getter Functions
+    sf::Uint32 getTick() const;
+};
+
+class SpectatorViewer {
+private:
+    const TableSpec* spec;
+    sf::RenderWindow* window;
+    sf::Event ev;
+    sf::TcpSocket socket;
+    bool connected;
+
+    Table table;
+    std::vector<Hole*> holes;
+    std::vector<Ball> balls; // Indexed by ball id, slots are restyled when the server respawns them
+
+    std::vector<sf::Uint8> receiveBuffer;
+    SpectatorDecoder decoder;
+
+    void initWindow();
+    void initTable(const TableSpec& tableSpec);
+    void receiveFrames();
+    void syncBall(const SpectatorBall& state);
+
+public:
+    SpectatorViewer();
+    virtual ~SpectatorViewer();
+
+    bool connect(const sf::IpAddress& address, unsigned short port);
+
+    // Getter Functions
+    bool running() const;
+
+    // Functions
+    void pollEvents();
+    void update();
+    void render();
+};
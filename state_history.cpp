@@ -0,0 +1,360 @@
+#include "state_history.h"
+#include "simulation.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+
+namespace {
+
+enum RecordType : sf::Uint32 {
+    KeyframeRecord = 1,
+    DeltaRecord = 2,
+    WrapRecord = 3 // The rest of the ring is unused, the next record is at offset 0
+};
+
+const std::size_t noRoom = static_cast<std::size_t>(-1);
+
+// Records are copied in and out with memcpy
+static_assert(std::is_trivially_copyable<Match>::value, "Match is stored as raw bytes");
+
+} // namespace
+
+
+/* === StateHistory Class Definition STARTS HERE === */
+
+StateHistory::StateHistory(const StateHistorySettings& settings)
+    : settings(settings), ring(std::max<std::size_t>(settings.memoryBytes, 4096)), head(0), nextTick(0), overflowLogged(false),
+      lastRackCount(-1), lastBallCount(0), resumePending(false),
+      cursorTick(-1), cursorSegment(-1), cursorOffset(0), cursorPhysicsStep(0), cursorRackCount(-1) {
+    this->settings.keyframeInterval = std::max(1, settings.keyframeInterval);
+    segments.reserve(256);
+}
+
+void StateHistory::record(const Simulation& simulation, const Match& match) {
+    if (resumePending) this->resume();
+
+    const BallPool& ballPool = simulation.getBallPool();
+    const int ballCount = static_cast<int>(ballPool.size());
+    const bool racked = simulation.getRackCount() != lastRackCount || ballCount != lastBallCount;
+
+    if (racked) {
+        // Scratch sized once per rack, steady play records without allocating
+        inDelta.assign(ballCount, 0);
+        recordBalls.reserve(ballCount);
+        lastAwake.reserve(ballCount);
+        recordContacts.reserve(4 * static_cast<std::size_t>(ballCount));
+    }
+
+    // A delta carries every ball that was awake before or after the step, the ones that just stopped or dropped included
+    recordBalls.clear();
+    if (!racked) {
+        if (inDelta.size() < static_cast<std::size_t>(ballCount)) inDelta.resize(ballCount, 0);
+        for (int id : lastAwake) {
+            inDelta[id] = 1;
+            recordBalls.push_back(BallState());
+            this->capture(simulation, id, recordBalls.back());
+        }
+        for (int id : ballPool.getAwake()) {
+            if (inDelta[id]) continue;
+            recordBalls.push_back(BallState());
+            this->capture(simulation, id, recordBalls.back());
+        }
+        for (int id : lastAwake) {
+            inDelta[id] = 0;
+        }
+    }
+
+    const bool matchChanged = !(match == lastMatch);
+    if (!racked && recordBalls.empty() && !matchChanged) {
+        return; // Nothing moved, no tick
+    }
+
+    const ContactSolver& contactSolver = simulation.getContactSolver();
+    recordContacts.clear();
+    for (std::size_t c = 0; c < contactSolver.getContactCount(); ++c) {
+        ContactState contact;
+        contact.a = contactSolver.getContactBall(c, false);
+        contact.b = contactSolver.getContactBall(c, true);
+        contact.impulse = contactSolver.getContactImpulse(c);
+        recordContacts.push_back(contact);
+    }
+
+    bool keyframe = racked || segments.empty() || nextTick - segments.back().firstTick >= settings.keyframeInterval;
+    if (!keyframe && !this->write(false, simulation.getPhysicsStep(), match, matchChanged)) {
+        keyframe = true; // The segment filled the whole ring, start over from a keyframe
+    }
+    if (keyframe) {
+        recordBalls.resize(ballCount);
+        for (int id = 0; id < ballCount; ++id) {
+            this->capture(simulation, id, recordBalls[id]);
+        }
+        if (!this->write(true, simulation.getPhysicsStep(), match, true)) {
+            if (!overflowLogged) {
+                BILLIARD_LOG(Warning, Physics) << "A keyframe of " << ballCount << " balls does not fit the " << ring.size()
+                                               << " byte rewind history, nothing is recorded";
+                overflowLogged = true;
+            }
+            this->clear();
+            return;
+        }
+    }
+
+    this->syncLast(simulation, match);
+}
+
+bool StateHistory::seek(long long tick, Simulation& simulation, Match& match) {
+    if (segments.empty() || tick < segments.front().firstTick || tick > segments.back().lastTick) {
+        return false;
+    }
+
+    // Ticks only ever grow, the segment is the last one starting at or before the tick
+    auto found = std::upper_bound(segments.begin(), segments.end(), tick,
+                                  [](long long value, const Segment& segment) { return value < segment.firstTick; });
+    const int segment = static_cast<int>(found - segments.begin()) - 1;
+
+    // Scrubbing forward inside a segment carries on from the last seek, anything else starts at the keyframe
+    if (segment != cursorSegment || cursorTick < 0 || cursorTick > tick) {
+        cursorSegment = segment;
+        cursorOffset = segments[segment].offset;
+        cursorTick = -1;
+    }
+    while (cursorTick < tick) {
+        this->applyRecord(cursorOffset);
+    }
+
+    // The ball count of that tick, a rack reuses the slots of the current one
+    BallPool& ballPool = simulation.getBallPool();
+    if (ballPool.size() != cursorBalls.size()) {
+        std::vector<sf::Vector2f> positions(cursorBalls.size());
+        for (std::size_t id = 0; id < cursorBalls.size(); ++id) positions[id] = cursorBalls[id].position;
+        simulation.rack(positions);
+    }
+
+    for (const BallState& state : cursorBalls) {
+        ballPool.restore(state.id, state.position, (state.flags & OnTable) != 0, (state.flags & Awake) != 0);
+        Ball& ball = ballPool.get(state.id);
+        ball.setVelocity(state.velocity);
+        ball.restFrames = state.restFrames;
+    }
+
+    ContactSolver& contactSolver = simulation.getContactSolver();
+    contactSolver.clear();
+    for (const ContactState& contact : cursorContacts) {
+        contactSolver.restoreContact(contact.a, contact.b, contact.impulse);
+    }
+    simulation.restoreStep(cursorPhysicsStep);
+    match = cursorMatch;
+
+    cursorRackCount = simulation.getRackCount();
+    resumePending = true;
+    return true;
+}
+
+void StateHistory::resume() {
+    resumePending = false;
+    if (cursorTick < 0 || cursorSegment < 0) return;
+
+    // Everything after the cursor goes, its segment now ends with the record it stopped at
+    segments.resize(cursorSegment + 1);
+    Segment& segment = segments.back();
+    segment.lastTick = cursorTick;
+    head = cursorOffset;
+    nextTick = cursorTick + 1;
+
+    lastAwake.clear();
+    for (const BallState& state : cursorBalls) {
+        if (state.flags & Awake) lastAwake.push_back(state.id);
+    }
+    lastMatch = cursorMatch;
+    lastBallCount = static_cast<int>(cursorBalls.size());
+    lastRackCount = cursorRackCount;
+}
+
+void StateHistory::clear() {
+    segments.clear();
+    head = 0;
+    lastRackCount = -1;
+    lastAwake.clear();
+    resumePending = false;
+    cursorTick = -1;
+    cursorSegment = -1;
+}
+
+std::size_t StateHistory::allocate(std::size_t size, bool keyframe) {
+    if (size > ring.size()) return noRoom;
+
+    for (;;) {
+        if (segments.empty()) {
+            head = 0;
+            return 0;
+        }
+
+        const std::size_t tail = segments.front().offset;
+        if (tail < head) {
+            // Live bytes in [tail, head), free at the end and in front of the tail
+            if (head + size <= ring.size()) return head;
+            if (size <= tail) {
+                if (ring.size() - head >= sizeof(RecordHeader)) {
+                    RecordHeader marker = RecordHeader();
+                    marker.size = static_cast<sf::Uint32>(ring.size() - head);
+                    marker.type = WrapRecord;
+                    std::memcpy(&ring[head], &marker, sizeof(marker));
+                }
+                head = 0;
+                return 0;
+            }
+        } else if (head + size <= tail) {
+            // Wrapped, free bytes only in [head, tail)
+            return head;
+        }
+
+        // A delta needs the keyframe of its own segment, that segment is never dropped for it
+        if (!keyframe && segments.size() == 1) return noRoom;
+        this->evictOldest();
+    }
+}
+
+std::size_t StateHistory::wrapped(std::size_t offset) const {
+    if (ring.size() - offset < sizeof(RecordHeader)) return 0;
+
+    RecordHeader header;
+    std::memcpy(&header, &ring[offset], sizeof(header));
+    return header.type == WrapRecord ? 0 : offset;
+}
+
+void StateHistory::evictOldest() {
+    segments.erase(segments.begin());
+    if (cursorSegment >= 0) {
+        --cursorSegment;
+        if (cursorSegment < 0) cursorTick = -1;
+    }
+}
+
+bool StateHistory::write(bool keyframe, long long physicsStep, const Match& match, bool withMatch) {
+    std::size_t size = sizeof(RecordHeader) + recordBalls.size() * sizeof(BallState) + recordContacts.size() * sizeof(ContactState);
+    if (withMatch) size += sizeof(Match);
+    size = (size + 7) & ~static_cast<std::size_t>(7);
+
+    const std::size_t offset = this->allocate(size, keyframe);
+    if (offset == noRoom) return false;
+
+    RecordHeader header = RecordHeader();
+    header.size = static_cast<sf::Uint32>(size);
+    header.type = keyframe ? KeyframeRecord : DeltaRecord;
+    header.tick = nextTick;
+    header.physicsStep = physicsStep;
+    header.ballCount = static_cast<sf::Uint32>(recordBalls.size());
+    header.contactCount = static_cast<sf::Uint32>(recordContacts.size());
+    header.hasMatch = withMatch ? 1 : 0;
+
+    sf::Uint8* out = &ring[offset];
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    if (!recordBalls.empty()) {
+        std::memcpy(out, recordBalls.data(), recordBalls.size() * sizeof(BallState));
+        out += recordBalls.size() * sizeof(BallState);
+    }
+    if (!recordContacts.empty()) {
+        std::memcpy(out, recordContacts.data(), recordContacts.size() * sizeof(ContactState));
+        out += recordContacts.size() * sizeof(ContactState);
+    }
+    if (withMatch) {
+        std::memcpy(out, &match, sizeof(Match));
+    }
+
+    head = offset + size;
+    if (keyframe) {
+        Segment segment;
+        segment.firstTick = nextTick;
+        segment.lastTick = nextTick;
+        segment.offset = offset;
+        segments.push_back(segment);
+    } else {
+        Segment& segment = segments.back();
+        segment.lastTick = nextTick;
+    }
+    ++nextTick;
+    return true;
+}
+
+void StateHistory::applyRecord(std::size_t offset) {
+    offset = this->wrapped(offset);
+    RecordHeader header;
+    std::memcpy(&header, &ring[offset], sizeof(header));
+    const sf::Uint8* in = &ring[offset] + sizeof(header);
+
+    if (header.type == KeyframeRecord) {
+        cursorBalls.resize(header.ballCount);
+        std::memcpy(cursorBalls.data(), in, header.ballCount * sizeof(BallState));
+    } else {
+        for (sf::Uint32 i = 0; i < header.ballCount; ++i) {
+            BallState state;
+            std::memcpy(&state, in + i * sizeof(BallState), sizeof(state));
+            cursorBalls[state.id] = state;
+        }
+    }
+    in += header.ballCount * sizeof(BallState);
+
+    cursorContacts.resize(header.contactCount);
+    if (header.contactCount > 0) {
+        std::memcpy(cursorContacts.data(), in, header.contactCount * sizeof(ContactState));
+    }
+    in += header.contactCount * sizeof(ContactState);
+
+    if (header.hasMatch) {
+        std::memcpy(&cursorMatch, in, sizeof(Match));
+    }
+
+    cursorTick = header.tick;
+    cursorPhysicsStep = header.physicsStep;
+    cursorOffset = offset + header.size;
+}
+
+void StateHistory::capture(const Simulation& simulation, int id, BallState& state) const {
+    const BallPool& ballPool = simulation.getBallPool();
+    const Ball& ball = ballPool.get(id);
+    state = BallState();
+    state.id = id;
+    state.position = ball.getPosition();
+    state.velocity = ball.getVelocity();
+    state.restFrames = ball.restFrames;
+    state.flags = (ball.pocketed ? 0 : OnTable) | (ballPool.isAwake(id) ? Awake : 0);
+}
+
+void StateHistory::syncLast(const Simulation& simulation, const Match& match) {
+    const BallPool& ballPool = simulation.getBallPool();
+    lastAwake.assign(ballPool.getAwake().begin(), ballPool.getAwake().end());
+    lastMatch = match;
+    lastBallCount = static_cast<int>(ballPool.size());
+    lastRackCount = simulation.getRackCount();
+}
+
+// Getter Functions
+
+long long StateHistory::getFirstTick() const {
+    return segments.empty() ? -1 : segments.front().firstTick;
+}
+
+long long StateHistory::getLastTick() const {
+    return segments.empty() ? -1 : segments.back().lastTick;
+}
+
+bool StateHistory::isEmpty() const {
+    return segments.empty();
+}
+
+std::size_t StateHistory::getUsedBytes() const {
+    if (segments.empty()) return 0;
+    const std::size_t tail = segments.front().offset;
+    return tail < head ? head - tail : ring.size() - tail + head;
+}
+
+std::size_t StateHistory::getCapacity() const {
+    return ring.size();
+}
+
+int StateHistory::getSegmentCount() const {
+    return static_cast<int>(segments.size());
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <SFML\System.hpp>
+#include <vector>
+
+#include "match.h"
+
+class Simulation;
+
+
+/*
+    Rewind History
+
+    A bounded in-memory history of the table that can be scrubbed and resumed from. After
+    every physics step record() adds what changed since the previous one:
+
+        keyframe  every ball, the contact solver's warm start cache and the match
+        delta     only the balls that were awake before or after the step, the warm start
+                  cache and the match when its rules state changed
+
+    A step in which no ball was awake and the match stood still adds nothing, so memory
+    follows the motion on the table rather than the time played. Each recorded step is one
+    tick; resting periods take no ticks either.
+
+    Records live in one byte ring of memoryBytes allocated up front, grouped into segments
+    that each start with a keyframe. The oldest segment is dropped whole when the ring is
+    full, a delta is useless without the keyframe before it. A new segment starts every
+    keyframeInterval ticks, which bounds a seek to one keyframe and that many deltas.
+
+    seek() puts the Simulation and the Match back into the state they had after a tick,
+    bit for bit including the warm start, so stepping on from there plays exactly as it did
+    the first time. resume() then drops every tick after it and recording carries on.
+
+    Edits between steps must go through BallPool (place, wake, pocket), which wakes or
+    pockets the ball and so puts it into the next delta. A rack is noticed through
+    Simulation::getRackCount() and starts a new segment.
+*/
+
+struct StateHistorySettings {
+    std::size_t memoryBytes = 8u << 20;
+    int keyframeInterval = 120; // Ticks per segment
+};
+
+class StateHistory {
+private:
+    // Exact state of one ball, as records store it
+    struct BallState {
+        sf::Int32 id;
+        sf::Vector2f position;
+        sf::Vector2f velocity;
+        sf::Int32 restFrames;
+        sf::Uint8 flags; // OnTable and Awake below
+        sf::Uint8 padding[3];
+    };
+
+    struct ContactState {
+        sf::Int32 a;
+        sf::Int32 b;
+        float impulse;
+    };
+
+    struct RecordHeader {
+        sf::Uint32 size;   // Header included
+        sf::Uint32 type;
+        sf::Int64 tick;
+        sf::Int64 physicsStep;
+        sf::Uint32 ballCount;
+        sf::Uint32 contactCount;
+        sf::Uint32 hasMatch;
+        sf::Uint32 padding;
+    };
+
+    struct Segment {
+        long long firstTick;
+        long long lastTick;
+        std::size_t offset; // Of the keyframe
+    };
+
+    static const sf::Uint8 OnTable = 1 << 0;
+    static const sf::Uint8 Awake = 1 << 1;
+
+    StateHistorySettings settings;
+    std::vector<sf::Uint8> ring;
+    std::vector<Segment> segments; // Oldest first
+    std::size_t head;              // Next write offset
+    long long nextTick;
+    bool overflowLogged;
+
+    // What the last record saw, the next delta is taken against it
+    int lastRackCount;
+    int lastBallCount;
+    std::vector<int> lastAwake;
+    Match lastMatch;
+    std::vector<sf::Uint8> inDelta;     // Scratch, by ball id
+    std::vector<BallState> recordBalls; // Scratch, the balls of the record being written
+    std::vector<ContactState> recordContacts;
+    bool resumePending;                 // A seek happened, the next record() resumes from it
+
+    // Seek cursor, the state after cursorTick rebuilt from its segment
+    long long cursorTick;
+    int cursorSegment;
+    std::size_t cursorOffset; // Next record of that segment to apply
+    long long cursorPhysicsStep;
+    std::vector<BallState> cursorBalls;
+    std::vector<ContactState> cursorContacts;
+    Match cursorMatch;
+    int cursorRackCount;
+
+    std::size_t allocate(std::size_t size, bool keyframe); // Ring offset for a record, evicting old segments, npos without room
+    std::size_t wrapped(std::size_t offset) const;         // Where a record at offset really starts
+    void evictOldest();
+    bool write(bool keyframe, long long physicsStep, const Match& match, bool withMatch);
+    void applyRecord(std::size_t offset);
+    void capture(const Simulation& simulation, int id, BallState& state) const;
+    void syncLast(const Simulation& simulation, const Match& match);
+
+public:
+    explicit StateHistory(const StateHistorySettings& settings = StateHistorySettings());
+
+    // After every Simulation::step() and after anything else that moves balls or changes the match
+    void record(const Simulation& simulation, const Match& match);
+    // Restores the state after tick into both, false when the tick is no longer held
+    bool seek(long long tick, Simulation& simulation, Match& match);
+    void resume(); // Forgets every tick after the last seek, recording continues from it. record() does it too
+    void clear();
+
+    // Getter Functions
+    long long getFirstTick() const; // Oldest tick still held, -1 when empty
+    long long getLastTick() const;  // -1 when empty
+    bool isEmpty() const;
+    std::size_t getUsedBytes() const;
+    std::size_t getCapacity() const;
+    int getSegmentCount() const;
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <SFML\Graphics.hpp>
+#include <initializer_list>
+#include <string>
+
+
+/*
+    Compile-time Table Specifications
+
+    Every size, position, color and physics constant of a table lives in one literal
+    TableSpec. The specs below are constexpr objects, so the physics kernels take them as a
+    template parameter (template <const TableSpec& Spec>) and the compiler folds friction,
+    restitution, radii and wall positions straight into each specialized loop. Objects
+    that only need the values at setup time hold a reference instead of a private copy.
+
+    The fixed-step friction and restitution are the exception: they are measured on real
+    tables (see calibration.h), so the kernels take them at runtime as PhysicsParameters
+    and a spec only supplies the defaults through physics().
+
+    Colors are stored as 0xRRGGBBAA because sf::Color is not a literal type.
+*/
+
+// The fitted part of the fixed-step physics, per frame at the table's frame rate
+struct PhysicsParameters {
+    float friction = 0.985f;            // Fraction of the velocity a rolling ball keeps per frame
+    float restitution = 0.97f;          // Ball against ball
+    float cushionRestitution = 0.97f;   // Ball against cushion
+    float minVelocityThreshold = 0.05f; // Slower velocity components stop, px per frame
+};
+
+struct TableSpec {
+    const char* name = "pool9ft";
+
+    // Window Dimension
+    float window_width = 2500.0f;
+    float window_height = 1500.0f;
+    int frLimit = 60;
+
+    // Table Properties
+    float table_width = 2000.0f;
+    float table_height = 1000.0f;
+    float wall_thickness = 40.0f; // Height of the top/bottom walls and width of the left/right walls
+    float cornerRadius = 60.0f;
+    float shadowOffset = 15.0f;
+
+    // Hole Properties
+    int holeCount = 6;
+    float hole_radius = 40.0f;
+    float hole_capture_factor = 0.7f; // Fraction of (hole_radius + ball_radius) that counts as pocketed
+
+    // Ball Properties
+    int ballCount = 16;
+    float ball_border_width = 4.0f;
+    float ball_radius = 25.0f;
+
+    // CueStick Properties
+    float stick_width = 5.0f;
+    float stick_length = 200.0f;
+    float minOffsetDistance = 40.0f; // Minimum distance from cue ball
+    float maxOffsetDistance = 150.0f; // Maximum distance based on drag
+
+    // Pyhsics Properties
+    float force_scaling_factor = 5.0f;
+    float phi = 3.14159f;
+    float friction = 0.985f;
+    float minVelocityThreshold = 0.05f;
+    float restitution = 0.97f; // Coefficient of restitution (1.0 = elastic, 0.0 = inelastic)
+    float cushionRestitution = 0.97f;
+    int sleepFrames = 10; // Frames a ball must rest without contacts before it stops being simulated
+
+    // Analytic Engine Properties (pixels and seconds)
+    float gravity = 7720.0f;        // 9.81 m/s^2 with the 2000 px bed taken as a 2.54 m table
+    float slidingFriction = 0.2f;
+    float rollingFriction = 0.03f;  // Above real cloth so a medium shot rolls about as far as with the fixed-step friction
+    float spinFriction = 0.044f;
+
+    // Color Properties
+    sf::Uint32 window_color = 0x2E5077FF;
+    sf::Uint32 ballBorderColor = 0xFFFFFFFF;
+    sf::Uint32 tableColor = 0x00CC00FF;       // Bright green
+    sf::Uint32 tableWallColor = 0x8B4513FF;   // Dark wood color
+    sf::Uint32 tableShadowColor = 0x693A1AFF;
+    sf::Uint32 tableSecWallColor = 0x565656FF;
+    sf::Uint32 holeColor = 0x000000FF;
+    const sf::Uint32* ballColors = nullptr;
+    int ballColorCount = 0;
+
+    // Default physics, a Simulation may run with calibrated values instead
+    constexpr PhysicsParameters physics() const {
+        PhysicsParameters parameters;
+        parameters.friction = friction;
+        parameters.restitution = restitution;
+        parameters.cushionRestitution = cushionRestitution;
+        parameters.minVelocityThreshold = minVelocityThreshold;
+        return parameters;
+    }
+
+    // Derived Sizes
+    constexpr float table_offsetX() const { return (window_width - table_width) / 2; }
+    constexpr float table_offsetY() const { return (window_height - table_height) / 2; }
+    constexpr float table_topBottomWall_width() const { return table_width + 2 * wall_thickness; }
+
+    // Derived Positions
+    sf::Vector2f table_dimension() const { return sf::Vector2f(table_width, table_height); }
+    sf::Vector2f table_offset() const { return sf::Vector2f(table_offsetX(), table_offsetY()); }
+
+    sf::Vector2f table_topWall() const { return sf::Vector2f(window_width / 2, (window_height - table_height - wall_thickness) / 2); }
+    sf::Vector2f table_bottomWall() const { return sf::Vector2f(window_width / 2, (window_height + table_height + wall_thickness) / 2); }
+    sf::Vector2f table_leftWall() const { return sf::Vector2f((window_width - table_width - wall_thickness) / 2, window_height / 2); }
+    sf::Vector2f table_rightWall() const { return sf::Vector2f((window_width + table_width + wall_thickness) / 2, window_height / 2); }
+
+    sf::Vector2f topLeftCornerPosition() const { return sf::Vector2f(window_width / 2 - table_width - cornerRadius, table_topWall().y - cornerRadius); }
+    sf::Vector2f topRightCornerPosition() const { return sf::Vector2f(window_width / 2 + table_width + cornerRadius, table_topWall().y - cornerRadius); }
+    sf::Vector2f bottomLeftCornerPosition() const { return sf::Vector2f(window_width / 2 - table_width - cornerRadius, table_bottomWall().y + cornerRadius); }
+    sf::Vector2f bottomRightCornerPosition() const { return sf::Vector2f(window_width / 2 + table_width + cornerRadius, table_bottomWall().y + cornerRadius); }
+
+    sf::Vector2f hole_topLeft() const { return table_offset(); }
+    sf::Vector2f hole_bottomLeft() const { return sf::Vector2f(table_offsetX(), table_offsetY() + table_height); }
+    sf::Vector2f hole_topMid() const { return sf::Vector2f(window_width / 2, (window_height - table_height - wall_thickness * 0.5f) / 2); }
+    sf::Vector2f hole_bottomMid() const { return sf::Vector2f(window_width / 2, (window_height + table_height + wall_thickness * 0.5f) / 2); }
+    sf::Vector2f hole_topRight() const { return sf::Vector2f((window_width + table_width) / 2, table_offsetY()); }
+    sf::Vector2f hole_bottomRight() const { return sf::Vector2f((window_width + table_width) / 2, table_offsetY() + table_height); }
+
+    sf::Color getBallColor(int index) const { return sf::Color(ballColors[index % ballColorCount]); }
+};
+
+
+/* ------ Ball Palettes ------ */
+
+inline constexpr sf::Uint32 poolBallColors[] = {
+    0xFFD700FF, // Yellow (Ball 1)
+    0xFF0000FF, // Red (Ball 2)
+    0x0000FFFF, // Blue (Ball 3)
+    0xFF4500FF, // Orange (Ball 4)
+    0x800080FF, // Purple (Ball 6)
+    0x008000FF, // Green (Ball 5)
+    0x8B4513FF, // Brown (Ball 8)
+    0xFFC0CBFF, // Pink (Ball 9)
+    0xFF1493FF, // Deep Pink (Ball 7)
+    0x00FFFFFF, // Cyan (Ball 10)
+    0xFFA500FF, // Dark Orange (Ball 12)
+    0x006400FF, // Dark Green (Ball 14)
+    0x4B0082FF, // Indigo (Ball 11)
+    0x808000FF, // Olive (Ball 15)
+    0x565656FF, // Gray (Ball 13)
+    0xFFFFFFFF  // White (Cue Ball)
+};
+
+
+/* ------ Table Specifications ------ */
+
+constexpr TableSpec makePool9ftTable() {
+    TableSpec spec;
+    spec.ballColors = poolBallColors;
+    spec.ballColorCount = sizeof(poolBallColors) / sizeof(poolBallColors[0]);
+    return spec;
+}
+
+// Same 2:1 bed drawn with smaller balls and tighter pockets on a faster cloth
+constexpr TableSpec makeSnookerTable() {
+    TableSpec spec = makePool9ftTable();
+    spec.name = "snooker";
+    spec.hole_radius = 28.0f;
+    spec.ball_radius = 15.0f;
+    spec.ball_border_width = 3.0f;
+    spec.friction = 0.988f;
+    spec.restitution = 0.96f;
+    spec.cushionRestitution = 0.96f;
+    spec.rollingFriction = 0.025f;
+    spec.tableColor = 0x0A6E32FF;
+    return spec;
+}
+
+// Tiny balls so large racks fit on the bed, used to stress the physics and rendering
+constexpr TableSpec makeSandboxTable() {
+    TableSpec spec = makePool9ftTable();
+    spec.name = "sandbox";
+    spec.ball_radius = 2.0f;
+    spec.ball_border_width = 0.5f;
+    spec.tableColor = 0x1F7A3AFF;
+    return spec;
+}
+
+inline constexpr TableSpec pool9ftTable = makePool9ftTable();
+inline constexpr TableSpec snookerTable = makeSnookerTable();
+inline constexpr TableSpec sandboxTable = makeSandboxTable();
+
+
+/*
+    Runtime selection of a compile-time spec. The visitor receives a TableTag whose
+    ::spec can be used as the template argument of a kernel:
+
+        visitTableSpec(spec, [&](auto tag) { step<decltype(tag)::spec>(); });
+*/
+template <const TableSpec& Spec>
+struct TableTag {
+    static constexpr const TableSpec& spec = Spec;
+};
+
+template <class Visitor>
+decltype(auto) visitTableSpec(const TableSpec& spec, Visitor&& visitor) {
+    if (&spec == &snookerTable) return visitor(TableTag<snookerTable>{});
+    if (&spec == &sandboxTable) return visitor(TableTag<sandboxTable>{});
+    return visitor(TableTag<pool9ftTable>{});
+}
+
+inline const TableSpec* findTableSpec(const std::string& name) {
+    for (const TableSpec* spec : { &pool9ftTable, &snookerTable, &sandboxTable }) {
+        if (name == spec->name) return spec;
+    }
+    return nullptr;
+}
@@ -0,0 +1,246 @@
+#include "vector_env.h"
+#include "billiard_env.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* === VectorEnvironment Class Definition STARTS HERE === */
+
+VectorEnvironment::VectorEnvironment(const VectorEnvironmentSettings& settings)
+    : settings(settings), ballCount(0), workers(nullptr), nextChunk(0) {
+    this->settings.envCount = std::max(1, settings.envCount);
+    this->settings.threads = std::max(1, std::min(settings.threads, this->settings.envCount));
+    this->settings.maxShotFrames = std::max(1, settings.maxShotFrames);
+    this->settings.maxShots = std::max(1, settings.maxShots);
+    this->settings.framesPerStep = std::max(0, settings.framesPerStep);
+
+    // Every env gets its own rack so random racks differ between envs but stay reproducible
+    envs.resize(this->settings.envCount);
+    for (int i = 0; i < this->settings.envCount; ++i) {
+        RackOptions rackOptions = this->settings.rackOptions;
+        rackOptions.seed += static_cast<unsigned int>(i);
+        envs[i].simulation = new Simulation(*this->settings.spec);
+        envs[i].rack = generateRack(*this->settings.spec, rackOptions);
+        ballCount = std::max(ballCount, static_cast<int>(envs[i].rack.size()));
+        this->resetEnv(envs[i]);
+    }
+
+    if (this->settings.threads > 1) {
+        workers = new WorkerPool(this->settings.threads);
+    }
+}
+
+VectorEnvironment::~VectorEnvironment() {
+    delete workers;
+    for (Env& env : envs) {
+        delete env.simulation;
+        env.simulation = nullptr;
+    }
+}
+
+void VectorEnvironment::resetEnv(Env& env) {
+    env.simulation->rack(env.rack);
+    env.shots = 0;
+    env.shotFrames = 0;
+    env.shotActive = false;
+}
+
+bool VectorEnvironment::advance(Env& env, int frames, float& reward) {
+    Simulation& simulation = *env.simulation;
+
+    for (int frame = 0; frame < frames && simulation.isMoving(); ++frame) {
+        simulation.step();
+        ++env.shotFrames;
+
+        for (const PocketEvent& event : simulation.getPocketEvents()) {
+            if (event.ballId == simulation.getCueBallId()) {
+                reward -= settings.foulPenalty;
+            } else {
+                reward += 1.0f;
+            }
+        }
+
+        // A shot that never settles (balls trapped against each other) is called off
+        if (env.shotFrames >= settings.maxShotFrames) simulation.callOff();
+    }
+    return !simulation.isMoving();
+}
+
+void VectorEnvironment::writeObservation(const Env& env, float* observation) const {
+    const BallPool& ballPool = env.simulation->getBallPool();
+    const int racked = static_cast<int>(ballPool.size());
+
+    observation[0] = env.shotActive ? 0.0f : 1.0f;
+    for (int id = 0; id < ballCount; ++id) {
+        float* slot = observation + 1 + 4 * id;
+        if (id >= racked) { // This env's rack came out smaller than the largest one
+            slot[0] = slot[1] = slot[2] = slot[3] = 0.0f;
+            continue;
+        }
+
+        // Pocketed balls keep their type, only the position and the on table flag are cleared
+        const Ball& ball = ballPool.get(id);
+        slot[0] = ball.pocketed ? 0.0f : ball.getPosition().x;
+        slot[1] = ball.pocketed ? 0.0f : ball.getPosition().y;
+        slot[2] = static_cast<float>(ball.type);
+        slot[3] = ball.pocketed ? 0.0f : 1.0f;
+    }
+}
+
+void VectorEnvironment::forEachEnv(const std::function<void(int)>& body) {
+    const int envCount = static_cast<int>(envs.size());
+    nextChunk = 0;
+
+    auto work = [&](int) {
+        for (int chunk = nextChunk++; chunk * envsPerChunk < envCount; chunk = nextChunk++) {
+            int end = std::min(envCount, (chunk + 1) * envsPerChunk);
+            for (int i = chunk * envsPerChunk; i < end; ++i) {
+                body(i);
+            }
+        }
+    };
+
+    if (workers) {
+        workers->run(work);
+    } else {
+        work(0);
+    }
+}
+
+void VectorEnvironment::reset(float* observations) {
+    const int size = observationSize();
+    forEachEnv([&](int i) {
+        this->resetEnv(envs[i]);
+        this->writeObservation(envs[i], observations + static_cast<std::size_t>(i) * size);
+    });
+}
+
+void VectorEnvironment::step(const float* actions, float* observations, float* rewards, unsigned char* dones) {
+    const int size = observationSize();
+    forEachEnv([&](int i) {
+        Env& env = envs[i];
+        float reward = 0.0f;
+
+        // Same strike as releasing the cue stick: direction times a power of 0 - 100
+        if (!env.shotActive) {
+            float angle = actions[2 * i];
+            float power = std::max(0.0f, std::min(100.0f, actions[2 * i + 1]));
+            env.simulation->strike(sf::Vector2f(std::cos(angle), std::sin(angle)) * power);
+            env.shotActive = true;
+            env.shotFrames = 0;
+            ++env.shots;
+        }
+
+        int frames = settings.framesPerStep > 0 ? settings.framesPerStep : settings.maxShotFrames;
+        if (this->advance(env, frames, reward)) {
+            env.shotActive = false;
+        }
+
+        bool done = !env.shotActive &&
+                    (env.simulation->getBallPool().getOnTable().size() <= 1 || env.shots >= settings.maxShots);
+        if (done && settings.autoReset) {
+            this->resetEnv(env);
+        }
+
+        rewards[i] = reward;
+        dones[i] = done ? 1 : 0;
+        this->writeObservation(env, observations + static_cast<std::size_t>(i) * size);
+    });
+}
+
+// Getter Functions
+const VectorEnvironmentSettings& VectorEnvironment::getSettings() const {
+    return settings;
+}
+
+int VectorEnvironment::getEnvCount() const {
+    return static_cast<int>(envs.size());
+}
+
+int VectorEnvironment::getBallCount() const {
+    return ballCount;
+}
+
+int VectorEnvironment::observationSize() const {
+    return 1 + 4 * ballCount;
+}
+
+
+/* === C Interface STARTS HERE === */
+
+struct BilliardEnv {
+    VectorEnvironment environment;
+
+    explicit BilliardEnv(const VectorEnvironmentSettings& settings) : environment(settings) {}
+};
+
+extern "C" {
+
+void billiard_env_default_config(BilliardEnvConfig* config) {
+    if (!config) return;
+
+    VectorEnvironmentSettings defaults;
+    config->table = "pool9ft";
+    config->envCount = defaults.envCount;
+    config->threads = defaults.threads;
+    config->ballCount = defaults.rackOptions.ballCount;
+    config->rackPattern = "triangle";
+    config->seed = defaults.rackOptions.seed;
+    config->framesPerStep = defaults.framesPerStep;
+    config->maxShotFrames = defaults.maxShotFrames;
+    config->maxShots = defaults.maxShots;
+    config->foulPenalty = defaults.foulPenalty;
+    config->autoReset = defaults.autoReset ? 1 : 0;
+}
+
+BilliardEnv* billiard_env_create(const BilliardEnvConfig* config) {
+    if (!config || config->envCount < 1 || config->ballCount < 1) return nullptr;
+
+    VectorEnvironmentSettings settings;
+    settings.spec = findTableSpec(config->table ? config->table : "pool9ft");
+    if (!settings.spec) return nullptr;
+    if (config->rackPattern && !parseRackPattern(config->rackPattern, settings.rackOptions.pattern)) return nullptr;
+
+    settings.envCount = config->envCount;
+    settings.threads = config->threads;
+    settings.rackOptions.ballCount = config->ballCount;
+    settings.rackOptions.seed = config->seed;
+    settings.framesPerStep = config->framesPerStep;
+    settings.maxShotFrames = config->maxShotFrames;
+    settings.maxShots = config->maxShots;
+    settings.foulPenalty = config->foulPenalty;
+    settings.autoReset = config->autoReset != 0;
+
+    // Nothing may throw across the C boundary, running out of memory or threads is a NULL env
+    try {
+        return new BilliardEnv(settings);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void billiard_env_destroy(BilliardEnv* env) {
+    delete env;
+}
+
+int billiard_env_count(const BilliardEnv* env) {
+    return env ? env->environment.getEnvCount() : 0;
+}
+
+int billiard_env_ball_count(const BilliardEnv* env) {
+    return env ? env->environment.getBallCount() : 0;
+}
+
+int billiard_env_observation_size(const BilliardEnv* env) {
+    return env ? env->environment.observationSize() : 0;
+}
+
+void billiard_env_reset(BilliardEnv* env, float* observations) {
+    if (env && observations) env->environment.reset(observations);
+}
+
+void billiard_env_step(BilliardEnv* env, const float* actions, float* observations, float* rewards, unsigned char* dones) {
+    if (env && actions && observations && rewards && dones) env->environment.step(actions, observations, rewards, dones);
+}
+
+}
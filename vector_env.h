@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "simulation.h"
+
+
+/*
+    Vectorized Training Environment
+
+    Steps a batch of independent tables with one call, for reinforcement learning. Every
+    env is its own Simulation; a step takes one action per env, advances all of them and
+    writes observations, rewards and done flags straight into buffers the caller owns.
+
+    An action is an aim angle (radians) and a power of 0 - 100, struck like the mouse
+    release in Game. With framesPerStep == 0 a step plays the whole shot until the table
+    rests, otherwise it advances framesPerStep fixed frames and the action is only taken
+    by envs whose table is at rest (the first observation float says which ones are).
+
+    Observation of one env, observationSize() floats:
+        [0]            1 when the table is at rest and the next action will be struck
+        [1 + 4i ...]   ball i: x, y (px), BallType as a number, 1 while on the table
+
+    The reward counts the object balls pocketed during the step, like the Match score in
+    Game, minus foulPenalty when the cue ball went down. An episode is done once every
+    object ball is pocketed or after maxShots shots; with autoReset the env is racked
+    again right away and the observation written is the first one of the new episode.
+
+    The envs are split across threads in small chunks handed out through an atomic
+    counter, so fast and slow tables even out. Each env only ever touches its own
+    Simulation and its own slice of the buffers.
+*/
+
+struct VectorEnvironmentSettings {
+    const TableSpec* spec = &pool9ftTable;
+    int envCount = 64;
+    int threads = 1;
+    RackOptions rackOptions;
+    int framesPerStep = 0;
+    int maxShotFrames = 5000;
+    int maxShots = 50;
+    float foulPenalty = 1.0f;
+    bool autoReset = true;
+};
+
+class VectorEnvironment {
+private:
+    struct Env {
+        Simulation* simulation;
+        std::vector<sf::Vector2f> rack;
+        int shots;
+        int shotFrames;  // Frames since the last strike, 0 while at rest
+        bool shotActive;
+    };
+
+    static const int envsPerChunk = 4;
+
+    VectorEnvironmentSettings settings;
+    std::vector<Env> envs;
+    int ballCount;
+    WorkerPool* workers;
+    std::atomic<int> nextChunk;
+
+    void resetEnv(Env& env);
+    bool advance(Env& env, int frames, float& reward); // True once the shot is over
+    void writeObservation(const Env& env, float* observation) const;
+    void forEachEnv(const std::function<void(int)>& body); // body(env index) on every env, across the threads
+
+public:
+    explicit VectorEnvironment(const VectorEnvironmentSettings& settings);
+    ~VectorEnvironment();
+    VectorEnvironment(const VectorEnvironment&) = delete;
+    VectorEnvironment& operator=(const VectorEnvironment&) = delete;
+
+    void reset(float* observations);
+    void step(const float* actions, float* observations, float* rewards, unsigned char* dones);
+
+    // Getter Functions
+    const VectorEnvironmentSettings& getSettings() const;
+    int getEnvCount() const;
+    int getBallCount() const;
+    int observationSize() const;
+};
@@ -0,0 +1,73 @@
+#include "worker_pool.h"
+
+
+/* === WorkerPool Class Definition STARTS HERE === */
+
+WorkerPool::WorkerPool(int threadCount)
+    : generation(0), pending(0), stopping(false), arrived(0), phase(0) {
+    for (int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&WorkerPool::work, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::work(int index) {
+    unsigned int seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        // run() does not touch the job until every worker reported back
+        job(index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) finished.notify_one();
+    }
+}
+
+void WorkerPool::run(const std::function<void(int)>& job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = job;
+        pending = static_cast<int>(workers.size());
+        ++generation;
+    }
+    wakeUp.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&]() { return pending == 0; });
+}
+
+void WorkerPool::sync() {
+    unsigned int current = phase.load(std::memory_order_acquire);
+    if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == getThreadCount()) {
+        arrived.store(0, std::memory_order_relaxed);
+        phase.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    while (phase.load(std::memory_order_acquire) == current) {
+        std::this_thread::yield();
+    }
+}
+
+// Getter Functions
+
+int WorkerPool::getThreadCount() const {
+    return static_cast<int>(workers.size()) + 1;
+}
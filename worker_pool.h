@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of helper threads that run one job together with the calling thread
+class WorkerPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable finished;
+    std::function<void(int)> job;
+    unsigned int generation;
+    int pending;
+    bool stopping;
+
+    // Spinning barrier, the phases of a job are too short to sleep between them
+    std::atomic<int> arrived;
+    std::atomic<unsigned int> phase;
+
+    void work(int index);
+
+public:
+    explicit WorkerPool(int threadCount);
+    ~WorkerPool();
+
+    void run(const std::function<void(int)>& job); // job(thread) on every thread, the caller is thread 0
+    void sync();                                    // Barrier for the threads inside run()
+
+    // Getter Functions
+    int getThreadCount() const;
+};